@@ -0,0 +1,216 @@
+/*
+ * Event bus benchmark: cost of one publish with the previous subscription
+ * scan under the bus mutex against the bus routing table.
+ *   util_event_bus - the bus itself, filled to eEVENT_BUS_MAX_SUBSCRIPTIONS,
+ *                    against a copy of the scan over the same subscriptions
+ *   growth         - copies of both lookups over larger subscription tables,
+ *                    to see where the scan goes as the table grows
+ *   publishers     - throughput with several threads publishing at once,
+ *                    the scan serializes them on the mutex
+ * Subscriptions are spread evenly over the AO IDs and event types, every
+ * publish has one matching subscriber.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -DLOG_LEVEL=LOG_LEVEL_NONE -pthread -Isrc experiments/event_bus_bench.c \
+ *       src/util/event_bus/event_bus.c src/util/event_pool/event_pool.c src/util/trace/trace.c src/util/log/log.c \
+ *       src/osal/osal.c -o experiments/event_bus_bench
+ *
+ * Usage: ./event_bus_bench [publishes] [max_publishers]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "util/event_bus/event_bus_config.h"
+#include "util/event_bus/event_bus.h"
+#include "osal/osal.h"
+
+#define MAX_GROWTH_SUBSCRIPTIONS 1024
+#define MAX_PUBLISHERS           16
+#define KEY_COUNT                (eAO_COUNT * eEVENT_BUS_MAX_EVENT_TYPES)
+
+/* ---------------------- Copies of both lookups, any size --------------------- */
+
+typedef struct
+{
+    EventBusPostFP  post_fn;
+    Event*          event;
+    eActiveObjectID ao_id;
+    uint32_t        module;
+    bool            active;
+    uint8_t         reserved[7];
+} Subscription;
+
+static Subscription subscriptions[MAX_GROWTH_SUBSCRIPTIONS];
+static Event        events[MAX_GROWTH_SUBSCRIPTIONS];
+static uint32_t     subscription_count;
+static OsalMutex    mutex;
+static uint32_t     route_start[KEY_COUNT + 1];
+static uint32_t     route_list[MAX_GROWTH_SUBSCRIPTIONS];
+
+static eStatus post(uint32_t module, Event* event)
+{
+    (void)module;
+    (void)event;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static uint32_t key_of(uint32_t i)
+{
+    return i % KEY_COUNT;
+}
+
+static void fill(uint32_t count)
+{
+    subscription_count = count;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        events[i].type = key_of(i) % eEVENT_BUS_MAX_EVENT_TYPES;
+        subscriptions[i] = (Subscription){ .post_fn = post, .event = &events[i],
+                                           .ao_id = (eActiveObjectID)(key_of(i) / eEVENT_BUS_MAX_EVENT_TYPES),
+                                           .module = i, .active = true };
+    }
+
+    for(uint32_t key = 0; key <= KEY_COUNT; key++)
+    {
+        route_start[key] = 0;
+    }
+    for(uint32_t i = 0; i < count; i++)
+    {
+        route_start[key_of(i)]++;
+    }
+    for(uint32_t key = 1; key <= KEY_COUNT; key++)
+    {
+        route_start[key] += route_start[key - 1];
+    }
+    for(uint32_t i = count; i-- > 0;)
+    {
+        route_list[--route_start[key_of(i)]] = i;
+    }
+}
+
+static void scan_publish(eActiveObjectID ao_id, uint32_t event_type)
+{
+    osal_mutex_lock(&mutex);
+    for(uint32_t i = 0; i < subscription_count; i++)
+    {
+        if(subscriptions[i].active && subscriptions[i].ao_id == ao_id &&
+           subscriptions[i].event->type == event_type)
+        {
+            subscriptions[i].post_fn(subscriptions[i].module, subscriptions[i].event);
+        }
+    }
+    osal_mutex_unlock(&mutex);
+}
+
+static void table_publish(eActiveObjectID ao_id, uint32_t event_type)
+{
+    uint32_t key = (uint32_t)ao_id * eEVENT_BUS_MAX_EVENT_TYPES + event_type;
+    for(uint32_t r = route_start[key]; r < route_start[key + 1]; r++)
+    {
+        Subscription* subscription = &subscriptions[route_list[r]];
+        subscription->post_fn(subscription->module, subscription->event);
+    }
+}
+
+/* --------------------------------- Harness --------------------------------- */
+
+static uint32_t publishes;
+static uint32_t max_publishers;
+
+typedef void (*PublishFP)(eActiveObjectID ao_id, uint32_t event_type);
+
+static void publish_loop(PublishFP publish, uint32_t keys)
+{
+    for(uint32_t i = 0; i < publishes; i++)
+    {
+        uint32_t key = i % keys;
+        publish((eActiveObjectID)(key / eEVENT_BUS_MAX_EVENT_TYPES), key % eEVENT_BUS_MAX_EVENT_TYPES);
+    }
+}
+
+static double time_publish(PublishFP publish, uint32_t keys)
+{
+    uint64_t start = osal_time_now_ns();
+    publish_loop(publish, keys);
+    return (double)(osal_time_now_ns() - start) / publishes;
+}
+
+static PublishFP thread_publish;
+
+static void* publisher(void* arg)
+{
+    (void)arg;
+    publish_loop(thread_publish, eEVENT_BUS_MAX_SUBSCRIPTIONS);
+    return NULL;
+}
+
+/* Returns millions of publishes per second over all publishers */
+static double run_publishers(PublishFP publish, uint32_t count)
+{
+    OsalThread threads[MAX_PUBLISHERS];
+
+    thread_publish = publish;
+    uint64_t start = osal_time_now_ns();
+    for(uint32_t i = 0; i < count; i++)
+    {
+        (void)osal_thread_create(&threads[i], publisher, NULL);
+    }
+    for(uint32_t i = 0; i < count; i++)
+    {
+        osal_thread_join(&threads[i]);
+    }
+
+    return (double)publishes * count / ((double)(osal_time_now_ns() - start) / 1e3);
+}
+
+static void bus_publish(eActiveObjectID ao_id, uint32_t event_type)
+{
+    (void)util_event_bus_publish(ao_id, event_type);
+}
+
+int main(int argc, char* argv[])
+{
+    publishes = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000000;
+    max_publishers = (argc > 2) ? (uint32_t)atoi(argv[2]) : 4;
+    if(publishes == 0 || max_publishers == 0 || max_publishers > MAX_PUBLISHERS)
+    {
+        fprintf(stderr, "usage: %s [publishes > 0] [max_publishers 1..%d]\n", argv[0], MAX_PUBLISHERS);
+        return EXIT_FAILURE;
+    }
+
+    if(osal_init() || osal_mutex_init(&mutex) || util_event_bus_init())
+    {
+        fprintf(stderr, "init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    fill(eEVENT_BUS_MAX_SUBSCRIPTIONS);
+    for(uint32_t i = 0; i < eEVENT_BUS_MAX_SUBSCRIPTIONS; i++)
+    {
+        (void)util_event_bus_subscribe(subscriptions[i].ao_id, post, i, &events[i]);
+    }
+    printf("util_event_bus %4u subscriptions  scan %7.1f ns  bus    %7.1f ns\n",
+           eEVENT_BUS_MAX_SUBSCRIPTIONS, time_publish(scan_publish, eEVENT_BUS_MAX_SUBSCRIPTIONS),
+           time_publish(bus_publish, eEVENT_BUS_MAX_SUBSCRIPTIONS));
+
+    for(uint32_t count = 1; count <= max_publishers; count *= 2)
+    {
+        double scan = run_publishers(scan_publish, count);
+        double bus = run_publishers(bus_publish, count);
+        printf("publishers     %4u threads        scan %7.2f M/s  bus    %7.2f M/s\n", count, scan, bus);
+    }
+    util_event_bus_delete();
+
+    for(uint32_t count = 8; count <= MAX_GROWTH_SUBSCRIPTIONS; count *= 2)
+    {
+        fill(count);
+        uint32_t keys = (count < KEY_COUNT) ? count : KEY_COUNT;
+        double scan = time_publish(scan_publish, keys);
+        double table = time_publish(table_publish, keys);
+        printf("growth         %4u subscriptions  scan %7.1f ns  table  %7.1f ns\n", count, scan, table);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/*
+ * Single thread event loop vs thread per AO, on the firmware's traffic: a
+ * scheduler AO on a periodic timer sends a request to each sensor AO, each
+ * sensor answers after a one-time timer standing for the device. Compares the
+ * latency from the post to the handler (AO wait histogram, which covers the
+ * hop from the timer thread to the AO thread when there is one), the CPU time
+ * and the thread count. Build it twice:
+ *
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/event_loop_bench.c \
+ *       src/osal/osal.c src/util/queue/queue.c src/util/fsm/fsm.c \
+ *       src/util/active_object/active_object.c src/util/histogram/histogram.c \
+ *       src/util/event_pool/event_pool.c src/util/trace/trace.c \
+ *       src/util/executor/executor.c -o experiments/event_loop_bench_threads
+ *
+ * and again with -DOSAL_EVENT_LOOP -o experiments/event_loop_bench_loop.
+ *
+ * Usage: ./event_loop_bench_<variant> [cycles] [cycle_ms]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "osal/osal.h"
+#include "util/active_object/active_object.h"
+#include "util/executor/executor.h"
+
+#define SENSOR_COUNT    3
+#define QUEUE_CAPACITY  8
+
+typedef enum eBenchEvent
+{
+    eBENCH_EVENT_CYCLE = eFSM_EVENT_USER,
+    eBENCH_EVENT_REQUEST,
+    eBENCH_EVENT_RESPONSE,
+    eBENCH_EVENT_REPLY
+} eBenchEvent;
+
+typedef struct
+{
+    ActiveObject aobj;
+    OsalTimer    timer;
+    TimerArg     timer_arg;
+    const char*  name;
+    uint64_t     latency_ms;    // device answer time
+} Node;
+
+static Event cycle_event = { .type = eBENCH_EVENT_CYCLE };
+static Event request_event = { .type = eBENCH_EVENT_REQUEST };
+static Event response_event = { .type = eBENCH_EVENT_RESPONSE };
+static Event reply_event = { .type = eBENCH_EVENT_REPLY };
+
+static uint32_t cycles_left;
+static uint32_t cycle_ms;
+static uint32_t threads_running;    // counted while everything runs, near the end
+static Node     scheduler = { .name = "scheduler" };
+static Node     sensors[SENSOR_COUNT] = {
+    { .name = "distance",    .latency_ms = 1 },
+    { .name = "temperature", .latency_ms = 2 },
+    { .name = "gps",         .latency_ms = 3 }
+};
+
+static void post_response(void* arg)
+{
+    (void)util_active_object_post(&((Node*)arg)->aobj, &response_event);
+}
+
+static void post_cycle(void* arg)
+{
+    (void)util_active_object_post(&((Node*)arg)->aobj, &cycle_event);
+}
+
+/* Reads the "Threads:" line of /proc/self/status */
+static uint32_t thread_count(void)
+{
+    FILE* file = fopen("/proc/self/status", "r");
+    char line[128];
+    uint32_t count = 0;
+
+    while(file != NULL && fgets(line, sizeof(line), file) != NULL)
+    {
+        if(strncmp(line, "Threads:", 8) == 0)
+        {
+            count = (uint32_t)strtoul(line + 8, NULL, 10);
+            break;
+        }
+    }
+    if(file != NULL)
+    {
+        fclose(file);
+    }
+
+    return count;
+}
+
+static void sensor_state(FSM* fsm, Event* event)
+{
+    Node* sensor = (Node*)fsm->arg;
+
+    switch(event->type)
+    {
+        case eFSM_EVENT_INIT:
+            sensor->timer_arg.handler = post_response;
+            sensor->timer_arg.arg = sensor;
+            (void)osal_timer_init(&sensor->timer, &sensor->timer_arg);
+            break;
+        case eBENCH_EVENT_REQUEST:
+            (void)osal_timer_arm(&sensor->timer, sensor->latency_ms, eTIMER_TYPE_ONCE);
+            break;
+        case eBENCH_EVENT_RESPONSE:
+            (void)util_active_object_post(&scheduler.aobj, &reply_event);
+            break;
+        default:
+            break;
+    }
+}
+
+static void scheduler_state(FSM* fsm, Event* event)
+{
+    Node* sched = (Node*)fsm->arg;
+
+    switch(event->type)
+    {
+        case eFSM_EVENT_INIT:
+            sched->timer_arg.handler = post_cycle;
+            sched->timer_arg.arg = sched;
+            (void)osal_timer_init(&sched->timer, &sched->timer_arg);
+            (void)osal_timer_arm(&sched->timer, cycle_ms, eTIMER_TYPE_REPEAT);
+            break;
+        case eBENCH_EVENT_CYCLE:
+            if(cycles_left-- == 0)
+            {
+                (void)osal_timer_disarm(&sched->timer);
+                for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+                {
+                    (void)util_active_object_end(&sensors[i].aobj);
+                }
+                (void)util_active_object_end(&sched->aobj);
+                break;
+            }
+            if(threads_running == 0 && cycles_left < 100)
+            {
+                threads_running = thread_count();
+            }
+            for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+            {
+                (void)util_active_object_post(&sensors[i].aobj, &request_event);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static uint64_t cpu_us(void)
+{
+    struct rusage usage;
+    (void)getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_utime.tv_sec * 1000000ull + (uint64_t)usage.ru_utime.tv_usec +
+           (uint64_t)usage.ru_stime.tv_sec * 1000000ull + (uint64_t)usage.ru_stime.tv_usec;
+}
+
+static void print_wait(const Node* node)
+{
+    ActiveObjectStats stats;
+    (void)util_active_object_get_stats(&node->aobj, &stats);
+    printf("%-12s wait p50 %6llu ns  p99 %6llu ns  max %7llu ns  (%llu events)\n", node->name,
+           (unsigned long long)util_histogram_percentile(&stats.wait, 50),
+           (unsigned long long)util_histogram_percentile(&stats.wait, 99),
+           (unsigned long long)stats.wait.max, (unsigned long long)stats.wait.count);
+}
+
+int main(int argc, char* argv[])
+{
+    cycles_left = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000;
+    cycle_ms = (argc > 2) ? (uint32_t)atoi(argv[2]) : 5;
+    if(cycle_ms == 0)
+    {
+        fprintf(stderr, "usage: %s [cycles] [cycle_ms > 0]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    (void)osal_init();
+#ifdef OSAL_EVENT_LOOP
+    if(util_executor_init(1))
+    {
+        fprintf(stderr, "executor init failed\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    uint64_t cpu_start = cpu_us();
+    uint64_t start = osal_time_now_ns();
+    for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+    {
+        if(util_active_object_init(&sensors[i].aobj, QUEUE_CAPACITY, sensor_state, NULL))
+        {
+            fprintf(stderr, "sensor init failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if(util_active_object_init(&scheduler.aobj, QUEUE_CAPACITY, scheduler_state, NULL))
+    {
+        fprintf(stderr, "scheduler init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    util_active_object_join(&scheduler.aobj);
+    for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+    {
+        util_active_object_join(&sensors[i].aobj);
+    }
+
+    double seconds = (double)(osal_time_now_ns() - start) / 1e9;
+#ifdef OSAL_EVENT_LOOP
+    printf("event loop: ");
+#else
+    printf("thread per AO: ");
+#endif
+    printf("%u threads, %.2f s, CPU %.2f%%\n", threads_running, seconds,
+           (double)(cpu_us() - cpu_start) / (seconds * 1e4));
+    print_wait(&scheduler);
+    for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+    {
+        print_wait(&sensors[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/*
+ * Executor vs thread per AO: tokens passed around a ring of AOs, each AO
+ * forwarding every token it gets to the next one. Run once with a thread per
+ * AO and once with the AOs as tasks on the executor's workers, and compare
+ * the time per hop, the context switches (voluntary + involuntary, from
+ * getrusage), the threads and the stack address space they reserve.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/executor_bench.c \
+ *       src/osal/osal.c src/util/queue/queue.c src/util/fsm/fsm.c \
+ *       src/util/active_object/active_object.c src/util/histogram/histogram.c \
+ *       src/util/event_pool/event_pool.c src/util/trace/trace.c \
+ *       src/util/executor/executor.c -o experiments/executor_bench
+ *
+ * Usage: ./executor_bench [ao_count] [hops] [workers]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "osal/osal.h"
+#include "util/active_object/active_object.h"
+#include "util/executor/executor.h"
+
+#define MAX_AO          eEXECUTOR_TASK_MAX_COUNT
+#define TOKEN_COUNT     4
+#define QUEUE_CAPACITY  8
+
+enum
+{
+    eBENCH_EVENT_TOKEN = eFSM_EVENT_USER
+};
+
+typedef struct
+{
+    ActiveObject aobj;
+    uint32_t     next;
+    uint32_t     padding;
+} Node;
+
+static Node      nodes[MAX_AO];
+static uint32_t  node_count;
+static uint64_t  hops_left;
+static OsalEvent done;
+static Event     token_event = { .type = eBENCH_EVENT_TOKEN };
+
+static void node_state(FSM* fsm, Event* event)
+{
+    Node* node = (Node*)fsm->arg;
+
+    if(event->type != eBENCH_EVENT_TOKEN)
+    {
+        return;
+    }
+
+    uint64_t left = __atomic_sub_fetch(&hops_left, 1, __ATOMIC_RELAXED);
+    if(left == 0)
+    {
+        osal_event_set(&done);
+    }
+    else if(left < UINT64_MAX / 2)   // the other tokens wrap past 0 and stop
+    {
+        (void)util_active_object_post(&nodes[node->next].aobj, &token_event);
+    }
+}
+
+/* Reads a "Name:   value kB" line of /proc/self/status, 0 if missing */
+static uint64_t proc_status(const char* name)
+{
+    FILE* file = fopen("/proc/self/status", "r");
+    char line[128];
+    uint64_t value = 0;
+    size_t length = strlen(name);
+
+    while(file != NULL && fgets(line, sizeof(line), file) != NULL)
+    {
+        if(strncmp(line, name, length) == 0 && line[length] == ':')
+        {
+            value = strtoull(line + length + 1, NULL, 10);
+            break;
+        }
+    }
+    if(file != NULL)
+    {
+        fclose(file);
+    }
+
+    return value;
+}
+
+static uint64_t context_switches(void)
+{
+    struct rusage usage;
+    (void)getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_nvcsw + (uint64_t)usage.ru_nivcsw;
+}
+
+static int run(bool executor, uint64_t hops)
+{
+    const ActiveObjectAttr attr = { .executor = executor };
+    struct rlimit stack;
+
+    (void)getrlimit(RLIMIT_STACK, &stack);
+    (void)osal_event_init(&done);
+    __atomic_store_n(&hops_left, hops, __ATOMIC_RELAXED);
+    for(uint32_t i = 0; i < node_count; ++i)
+    {
+        nodes[i].next = (i + 1) % node_count;
+        if(util_active_object_init(&nodes[i].aobj, QUEUE_CAPACITY, node_state, &attr))
+        {
+            fprintf(stderr, "AO init failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Every thread but main reserves a default stack */
+    uint64_t threads = proc_status("Threads");
+    uint64_t rss_kb = proc_status("VmRSS");
+    uint64_t size_kb = proc_status("VmSize");
+
+    uint64_t switches = context_switches();
+    uint64_t start = osal_time_now_ns();
+    for(uint32_t i = 0; i < TOKEN_COUNT; ++i)
+    {
+        (void)util_active_object_post(&nodes[(i * node_count) / TOKEN_COUNT].aobj, &token_event);
+    }
+    osal_event_wait(&done);
+    uint64_t elapsed = osal_time_now_ns() - start;
+    switches = context_switches() - switches;
+
+    for(uint32_t i = 0; i < node_count; ++i)
+    {
+        (void)util_active_object_end(&nodes[i].aobj);
+        util_active_object_join(&nodes[i].aobj);
+        util_active_object_delete(&nodes[i].aobj);
+    }
+    osal_event_destroy(&done);
+
+    printf("%-8s  %5.0f ns/hop  %9llu switches (%.3f/hop)  %3llu threads  stacks %6llu kB  RSS %6llu kB  VM %8llu kB\n",
+           executor ? "executor" : "threads", (double)elapsed / (double)hops,
+           (unsigned long long)switches, (double)switches / (double)hops,
+           (unsigned long long)threads,
+           (unsigned long long)((threads - 1) * (stack.rlim_cur == RLIM_INFINITY ? 0 : stack.rlim_cur) / 1024),
+           (unsigned long long)rss_kb, (unsigned long long)size_kb);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    node_count = (argc > 1) ? (uint32_t)atoi(argv[1]) : 16;
+    uint64_t hops = (argc > 2) ? (uint64_t)atoll(argv[2]) : 1000000;
+    uint32_t workers = (argc > 3) ? (uint32_t)atoi(argv[3]) : eEXECUTOR_THREAD_COUNT;
+    if(node_count < TOKEN_COUNT || node_count > MAX_AO || hops == 0)
+    {
+        fprintf(stderr, "usage: %s [ao_count %d..%d] [hops > 0] [workers]\n", argv[0], TOKEN_COUNT, MAX_AO);
+        return EXIT_FAILURE;
+    }
+
+    if(osal_init())
+    {
+        fprintf(stderr, "init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u AOs, %d tokens, %llu hops, %u workers\n", node_count, TOKEN_COUNT,
+           (unsigned long long)hops, workers);
+    if(run(false, hops))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if(util_executor_init(workers))
+    {
+        fprintf(stderr, "executor init failed\n");
+        return EXIT_FAILURE;
+    }
+    int result = run(true, hops);
+    util_executor_delete();
+
+    return result;
+}
@@ -0,0 +1,190 @@
+/*
+ * Dispatch cost of a switch FSM vs the same FSM run from a table: two states,
+ * OFF and ON, toggled by one event type, ON also counting a tick event
+ * without leaving, and a third type neither state handles. Times per event,
+ * the stats timing of each handler call included:
+ *
+ *   handled    a tick while ON, a switch case vs a row lookup and an action
+ *   transition a toggle, EXIT and ENTRY included
+ *   unhandled  the other type, a switch default vs the table's filter
+ *
+ * The switch states here don't log their unknown events like the firmware's
+ * do, so the unhandled case is the dispatch alone.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/fsm_table_bench.c \
+ *       src/osal/osal.c src/util/fsm/fsm.c src/util/fsm/fsm_table.c \
+ *       src/util/histogram/histogram.c src/util/trace/trace.c \
+ *       -o experiments/fsm_table_bench
+ *
+ * Usage: ./fsm_table_bench [events]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "osal/osal.h"
+#include "util/fsm/fsm.h"
+#include "util/fsm/fsm_table.h"
+
+enum
+{
+    eBENCH_EVENT_TOGGLE = eFSM_EVENT_USER,
+    eBENCH_EVENT_TICK,
+    eBENCH_EVENT_OTHER
+};
+
+static volatile uint64_t ticks;
+static volatile uint64_t entries;
+static volatile uint64_t on_entries;
+
+/* Switch FSM */
+static void switch_on_state(FSM* fsm, Event* event);
+
+static void switch_off_state(FSM* fsm, Event* event)
+{
+    switch(event->type)
+    {
+        case eFSM_EVENT_ENTRY:
+            entries++;
+            break;
+        case eBENCH_EVENT_TOGGLE:
+            (void)util_fsm_transition(fsm, switch_on_state);
+            break;
+        default:
+            break;
+    }
+}
+
+static void switch_on_state(FSM* fsm, Event* event)
+{
+    switch(event->type)
+    {
+        case eFSM_EVENT_ENTRY:
+            on_entries++;
+            break;
+        case eBENCH_EVENT_TOGGLE:
+            (void)util_fsm_transition(fsm, switch_off_state);
+            break;
+        case eBENCH_EVENT_TICK:
+            ticks++;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Table FSM, the same states with the events moved to rows */
+static void table_off_state(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    if(event->type == eFSM_EVENT_ENTRY)
+    {
+        entries++;
+    }
+}
+
+static void table_on_state(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    if(event->type == eFSM_EVENT_ENTRY)
+    {
+        on_entries++;
+    }
+}
+
+static void count_tick(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    (void)event;
+    ticks++;
+}
+
+#define BENCH_STATES(X, T)                      \
+    X(T, eBENCH_STATE_OFF, table_off_state)     \
+    X(T, eBENCH_STATE_ON,  table_on_state)
+
+#define BENCH_TRANSITIONS(X, S)                                                                 \
+    X(S, eBENCH_STATE_OFF, eBENCH_EVENT_TOGGLE, NULL, NULL,       eBENCH_STATE_ON)              \
+    X(S, eBENCH_STATE_ON,  eBENCH_EVENT_TOGGLE, NULL, NULL,       eBENCH_STATE_OFF)             \
+    X(S, eBENCH_STATE_ON,  eBENCH_EVENT_TICK,   NULL, count_tick, eFSM_TABLE_INTERNAL)
+
+typedef enum
+{
+    BENCH_STATES(FSM_TABLE_STATE_ID, ~)
+    eBENCH_STATE_COUNT
+} eBenchState;
+
+static const FSMTableRow bench_rows[] = { BENCH_TRANSITIONS(FSM_TABLE_ROW, ~) };
+static const FSMTableState bench_states[] = { BENCH_STATES(FSM_TABLE_STATE, BENCH_TRANSITIONS) };
+BENCH_STATES(FSM_TABLE_CHECK_ENTERED, BENCH_TRANSITIONS)
+static const FSMTable bench_table = FSM_TABLE(bench_states, bench_rows);
+
+static void table_init_state(FSM* fsm, Event* event)
+{
+    if(event->type == eFSM_EVENT_INIT)
+    {
+        (void)util_fsm_table_start(fsm, &bench_table);
+    }
+}
+
+static void switch_init_state(FSM* fsm, Event* event)
+{
+    if(event->type == eFSM_EVENT_INIT)
+    {
+        (void)util_fsm_transition(fsm, switch_off_state);
+    }
+}
+
+/* ns per event of count sends of event, an even count leaves the FSM where it was */
+static double bench(FSM* fsm, uint32_t type, uint64_t count)
+{
+    Event event = { .type = type };
+    uint64_t start = osal_time_now_ns();
+    for(uint64_t i = 0; i < count; ++i)
+    {
+        (void)util_fsm_send_event(fsm, &event);
+    }
+
+    return (double)(osal_time_now_ns() - start) / (double)count;
+}
+
+static void run(const char* name, StateFP init_state, uint64_t count)
+{
+    FSM fsm;
+    Event toggle = { .type = eBENCH_EVENT_TOGGLE };
+
+    (void)util_fsm_init(&fsm, init_state, NULL);
+    double unhandled_off = bench(&fsm, eBENCH_EVENT_OTHER, count);
+    double transition = bench(&fsm, eBENCH_EVENT_TOGGLE, count & ~1ull);
+    (void)util_fsm_send_event(&fsm, &toggle);
+    double handled = bench(&fsm, eBENCH_EVENT_TICK, count);
+    double unhandled_on = bench(&fsm, eBENCH_EVENT_OTHER, count);
+
+    printf("%-7s handled %6.1f ns  transition %6.1f ns  unhandled %6.1f ns (OFF) %6.1f ns (ON)\n",
+           name, handled, transition, unhandled_off, unhandled_on);
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t count = (argc > 1) ? (uint64_t)atoll(argv[1]) : 10000000;
+    if(count < 2)
+    {
+        fprintf(stderr, "usage: %s [events >= 2]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if(util_fsm_table_validate(&bench_table))
+    {
+        fprintf(stderr, "invalid table\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%llu events per case\n", (unsigned long long)count);
+    run("switch", switch_init_state, count);
+    run("table", table_init_state, count);
+    printf("%llu ticks, %llu entries\n", (unsigned long long)ticks,
+           (unsigned long long)(entries + on_entries));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/*
+ * Ping-pong benchmark: round-trip latency of an event bounced between two
+ * threads through their queues, like two AOs posting to each other.
+ * Compares util_queue (futex semaphore wakeup) with a copy of the previous
+ * mutex + condition variable queue.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/osal_pingpong_bench.c \
+ *       src/util/queue/queue.c src/osal/osal.c -o experiments/osal_pingpong_bench
+ *
+ * Usage: ./osal_pingpong_bench [round_trips]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "util/queue/queue.h"
+
+#define QUEUE_CAPACITY 4
+
+/* ------------------------- Reference condvar queue ------------------------- */
+
+typedef struct
+{
+    void*           buffer[QUEUE_CAPACITY];
+    uint32_t        head;
+    uint32_t        tail;
+    uint32_t        size;
+    pthread_mutex_t mutex;
+    pthread_cond_t  not_empty;
+} CondQueue;
+
+static void cond_queue_init(CondQueue* queue)
+{
+    queue->head = queue->tail = queue->size = 0;
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+}
+
+static void cond_queue_push(CondQueue* queue, void* element)
+{
+    pthread_mutex_lock(&queue->mutex);
+    queue->buffer[queue->tail] = element;
+    queue->tail = (queue->tail + 1) % QUEUE_CAPACITY;
+    queue->size++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+static void* cond_queue_pop(CondQueue* queue)
+{
+    pthread_mutex_lock(&queue->mutex);
+    while(queue->size == 0)
+    {
+        pthread_cond_wait(&queue->not_empty, &queue->mutex);
+    }
+    void* element = queue->buffer[queue->head];
+    queue->head = (queue->head + 1) % QUEUE_CAPACITY;
+    queue->size--;
+    pthread_mutex_unlock(&queue->mutex);
+    return element;
+}
+
+/* --------------------------------- Harness --------------------------------- */
+
+static uint32_t round_trips;
+static uint64_t* samples;
+
+static Queue     osal_ping, osal_pong;
+static CondQueue cond_ping, cond_pong;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void* osal_echo(void* arg)
+{
+    (void)arg;
+    for(uint32_t i = 0; i < round_trips; ++i)
+    {
+        void* event;
+        (void)util_queue_pop(&osal_ping, &event);
+        (void)util_queue_push(&osal_pong, event);
+    }
+    return NULL;
+}
+
+static void* cond_echo(void* arg)
+{
+    (void)arg;
+    for(uint32_t i = 0; i < round_trips; ++i)
+    {
+        cond_queue_push(&cond_pong, cond_queue_pop(&cond_ping));
+    }
+    return NULL;
+}
+
+static void run_osal(void)
+{
+    static int token;
+    for(uint32_t i = 0; i < round_trips; ++i)
+    {
+        void* event;
+        uint64_t start = now_ns();
+        (void)util_queue_push(&osal_ping, &token);
+        (void)util_queue_pop(&osal_pong, &event);
+        samples[i] = now_ns() - start;
+    }
+}
+
+static void run_cond(void)
+{
+    static int token;
+    for(uint32_t i = 0; i < round_trips; ++i)
+    {
+        uint64_t start = now_ns();
+        cond_queue_push(&cond_ping, &token);
+        (void)cond_queue_pop(&cond_pong);
+        samples[i] = now_ns() - start;
+    }
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench(const char* name, void* (*echo)(void*), void (*run)(void))
+{
+    struct rusage before, after;
+    pthread_t thread;
+    uint64_t sum = 0;
+
+    getrusage(RUSAGE_SELF, &before);
+    pthread_create(&thread, NULL, echo, NULL);
+    run();
+    pthread_join(thread, NULL);
+    getrusage(RUSAGE_SELF, &after);
+
+    qsort(samples, round_trips, sizeof(uint64_t), compare_u64);
+    for(uint32_t i = 0; i < round_trips; ++i)
+    {
+        sum += samples[i];
+    }
+
+    printf("%-10s round trip mean %7.2f us  p50 %7.2f us  p99 %7.2f us  ctx switches %ld\n",
+           name,
+           (double)sum / round_trips / 1000.0,
+           (double)samples[round_trips / 2] / 1000.0,
+           (double)samples[(round_trips * 99) / 100] / 1000.0,
+           (after.ru_nvcsw - before.ru_nvcsw) + (after.ru_nivcsw - before.ru_nivcsw));
+}
+
+int main(int argc, char* argv[])
+{
+    round_trips = (argc > 1) ? (uint32_t)atoi(argv[1]) : 100000;
+    if(round_trips == 0)
+    {
+        fprintf(stderr, "usage: %s [round_trips > 0]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    samples = calloc(round_trips, sizeof(uint64_t));
+
+    if(util_queue_init(&osal_ping, QUEUE_CAPACITY) || util_queue_init(&osal_pong, QUEUE_CAPACITY))
+    {
+        fprintf(stderr, "util_queue_init failed\n");
+        return EXIT_FAILURE;
+    }
+    cond_queue_init(&cond_ping);
+    cond_queue_init(&cond_pong);
+
+    bench("condvar", cond_echo, run_cond);
+    bench("futex", osal_echo, run_osal);
+
+    return EXIT_SUCCESS;
+}
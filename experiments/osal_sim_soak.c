@@ -0,0 +1,221 @@
+/*
+ * Virtual time soak test: a scheduler AO polls three sensor AOs every cycle,
+ * each sensor answers after a pseudo-random latency or times out, as with the
+ * DDL modules. Runs hours of virtual operation against the OSAL virtual time
+ * backend and reports the speedup and event throughput. The counters are the
+ * same on every run.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -DOSAL_VIRTUAL_TIME -pthread -Isrc experiments/osal_sim_soak.c \
+ *       src/osal/osal.c src/util/queue/queue.c src/util/fsm/fsm.c \
+ *       src/util/active_object/active_object.c src/util/histogram/histogram.c \
+ *       src/util/event_pool/event_pool.c src/util/trace/trace.c \
+ *       src/util/executor/executor.c -o experiments/osal_sim_soak
+ *
+ * Usage: ./osal_sim_soak [virtual_hours]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "osal/osal.h"
+#include "util/active_object/active_object.h"
+
+#ifndef OSAL_VIRTUAL_TIME
+#error "build with -DOSAL_VIRTUAL_TIME"
+#endif
+
+#define SENSOR_COUNT    3
+#define QUEUE_CAPACITY  8
+#define CYCLE_MS        2000
+
+typedef enum eSoakEvent
+{
+    eSOAK_EVENT_CYCLE = eFSM_EVENT_USER,
+    eSOAK_EVENT_REQUEST,
+    eSOAK_EVENT_RESPONSE,
+    eSOAK_EVENT_TIMEOUT,
+    eSOAK_EVENT_REPLY
+} eSoakEvent;
+
+typedef struct
+{
+    ActiveObject aobj;
+    OsalTimer    response_timer;
+    OsalTimer    timeout_timer;
+    TimerArg     response_arg;
+    TimerArg     timeout_arg;
+    const char*  name;
+    uint64_t     latency_min_ms;
+    uint64_t     latency_max_ms;
+    uint64_t     timeout_ms;
+    uint64_t     hold_us;       // blocking delay before each request, like the AM2302 start signal
+    uint64_t     replies;
+    uint64_t     timeouts;
+    uint32_t     seed;
+    uint32_t     padding;
+} Sensor;
+
+typedef struct
+{
+    ActiveObject aobj;
+    OsalTimer    timer;
+    TimerArg     timer_arg;
+    uint64_t     cycles;
+    uint64_t     replies;
+} Scheduler;
+
+static Event cycle_event = { .type = eSOAK_EVENT_CYCLE };
+static Event request_event = { .type = eSOAK_EVENT_REQUEST };
+static Event response_event = { .type = eSOAK_EVENT_RESPONSE };
+static Event timeout_event = { .type = eSOAK_EVENT_TIMEOUT };
+static Event reply_event = { .type = eSOAK_EVENT_REPLY };
+
+static Scheduler scheduler;
+static Sensor sensors[SENSOR_COUNT] = {
+    { .name = "distance",    .latency_min_ms = 10,  .latency_max_ms = 120, .timeout_ms = 100, .seed = 1 },
+    { .name = "temperature", .latency_min_ms = 200, .latency_max_ms = 320, .timeout_ms = 300, .seed = 2,
+      .hold_us = 1000 },
+    { .name = "servo",       .latency_min_ms = 300, .latency_max_ms = 520, .timeout_ms = 500, .seed = 3 }
+};
+
+static void post_response(void* arg)
+{
+    (void)util_active_object_post(&((Sensor*)arg)->aobj, &response_event);
+}
+
+static void post_timeout(void* arg)
+{
+    (void)util_active_object_post(&((Sensor*)arg)->aobj, &timeout_event);
+}
+
+static void post_cycle(void* arg)
+{
+    (void)util_active_object_post(&((Scheduler*)arg)->aobj, &cycle_event);
+}
+
+static uint64_t sensor_latency_ms(Sensor* sensor)
+{
+    sensor->seed = sensor->seed * 1103515245u + 12345u;
+    return sensor->latency_min_ms + (sensor->seed >> 16) % (sensor->latency_max_ms - sensor->latency_min_ms + 1);
+}
+
+static void sensor_state(FSM* fsm, Event* event)
+{
+    Sensor* sensor = (Sensor*)fsm->arg;
+
+    switch(event->type)
+    {
+        case eFSM_EVENT_INIT:
+            sensor->response_arg.handler = post_response;
+            sensor->response_arg.arg = sensor;
+            sensor->timeout_arg.handler = post_timeout;
+            sensor->timeout_arg.arg = sensor;
+            (void)osal_timer_init(&sensor->response_timer, &sensor->response_arg);
+            (void)osal_timer_init(&sensor->timeout_timer, &sensor->timeout_arg);
+            break;
+        case eSOAK_EVENT_REQUEST:
+            if(sensor->hold_us != 0)
+            {
+                osal_delay_us(sensor->hold_us);
+            }
+            (void)osal_timer_arm(&sensor->response_timer, sensor_latency_ms(sensor), eTIMER_TYPE_ONCE);
+            (void)osal_timer_arm(&sensor->timeout_timer, sensor->timeout_ms, eTIMER_TYPE_ONCE);
+            break;
+        case eSOAK_EVENT_RESPONSE:
+            (void)osal_timer_disarm(&sensor->timeout_timer);
+            sensor->replies++;
+            (void)util_active_object_post(&scheduler.aobj, &reply_event);
+            break;
+        case eSOAK_EVENT_TIMEOUT:
+            (void)osal_timer_disarm(&sensor->response_timer);
+            sensor->timeouts++;
+            (void)util_active_object_post(&scheduler.aobj, &reply_event);
+            break;
+        default:
+            break;
+    }
+}
+
+static void scheduler_state(FSM* fsm, Event* event)
+{
+    Scheduler* sched = (Scheduler*)fsm->arg;
+
+    switch(event->type)
+    {
+        case eFSM_EVENT_INIT:
+            sched->timer_arg.handler = post_cycle;
+            sched->timer_arg.arg = sched;
+            (void)osal_timer_init(&sched->timer, &sched->timer_arg);
+            (void)osal_timer_arm(&sched->timer, CYCLE_MS, eTIMER_TYPE_REPEAT);
+            break;
+        case eSOAK_EVENT_CYCLE:
+            sched->cycles++;
+            for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+            {
+                (void)util_active_object_post(&sensors[i].aobj, &request_event);
+            }
+            break;
+        case eSOAK_EVENT_REPLY:
+            sched->replies++;
+            break;
+        default:
+            break;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t hours = (argc > 1) ? (uint64_t)atoi(argv[1]) : 24;
+    OsalSimStats stats;
+
+    (void)osal_init();
+
+    for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+    {
+        if(util_active_object_init(&sensors[i].aobj, QUEUE_CAPACITY, sensor_state, NULL))
+        {
+            fprintf(stderr, "sensor init failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if(util_active_object_init(&scheduler.aobj, QUEUE_CAPACITY, scheduler_state, NULL))
+    {
+        fprintf(stderr, "scheduler init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    osal_sim_advance_us(hours * 3600ull * 1000000ull);
+
+    (void)osal_timer_disarm(&scheduler.timer);
+    for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+    {
+        (void)util_active_object_end(&sensors[i].aobj);
+        util_active_object_join(&sensors[i].aobj);
+    }
+    (void)util_active_object_end(&scheduler.aobj);
+    util_active_object_join(&scheduler.aobj);
+
+    osal_sim_get_stats(&stats);
+    uint64_t events = scheduler.cycles + scheduler.replies;
+    printf("virtual %.1f h in %.3f s wall (x%.0f)\n",
+           (double)stats.now_ns / 3.6e12, (double)stats.wall_ns / 1e9,
+           (double)stats.now_ns / (double)stats.wall_ns);
+    printf("cycles %llu  replies %llu  timer expirations %llu  delays %llu\n",
+           (unsigned long long)scheduler.cycles, (unsigned long long)scheduler.replies,
+           (unsigned long long)stats.timer_expirations, (unsigned long long)stats.delay_wakeups);
+    for(uint32_t i = 0; i < SENSOR_COUNT; ++i)
+    {
+        events += 2 * (sensors[i].replies + sensors[i].timeouts);
+        printf("%-12s replies %llu  timeouts %llu\n", sensors[i].name,
+               (unsigned long long)sensors[i].replies, (unsigned long long)sensors[i].timeouts);
+    }
+    printf("%.0f AO events per wall second\n", (double)events / ((double)stats.wall_ns / 1e9));
+
+    ActiveObjectStats ao_stats;
+    (void)util_active_object_get_stats(&scheduler.aobj, &ao_stats);
+    printf("scheduler    average batch %.2f  largest batch %u  queue depth peak %u\n",
+           (double)ao_stats.events / (double)ao_stats.batches, ao_stats.batch_max, ao_stats.depth_peak);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+/*
+ * Timer backend benchmark: expiry jitter and CPU cost of the OSAL timer
+ * service (single thread, timerfd + epoll) against POSIX timers notified with
+ * SIGEV_THREAD, which is what osal_timer_* used before.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/osal_timer_bench.c \
+ *       src/osal/osal.c -o experiments/osal_timer_bench -lrt
+ *
+ * Usage: ./osal_timer_bench [timers] [period_ms] [duration_s]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "osal/osal.h"
+
+#define MAX_TIMERS   8
+#define MAX_SAMPLES  100000
+
+typedef struct
+{
+    uint64_t  last_ns;
+    uint32_t  count;
+    uint32_t  padding;
+    uint64_t* deviation_ns;
+} TimerStats;
+
+static TimerStats stats[MAX_TIMERS];
+static uint64_t period_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t cpu_ns(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ull +
+           ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ull;
+}
+
+static void record_expiry(TimerStats* timer_stats)
+{
+    uint64_t now = now_ns();
+    if(timer_stats->last_ns != 0 && timer_stats->count < MAX_SAMPLES)
+    {
+        uint64_t interval = now - timer_stats->last_ns;
+        timer_stats->deviation_ns[timer_stats->count++] =
+            (interval > period_ns) ? (interval - period_ns) : (period_ns - interval);
+    }
+    timer_stats->last_ns = now;
+}
+
+/* ------------------------------ OSAL backend ------------------------------- */
+
+static void osal_handler(void* arg)
+{
+    record_expiry((TimerStats*)arg);
+}
+
+static TimerArg osal_args[MAX_TIMERS];
+static OsalTimer osal_timers[MAX_TIMERS];
+
+static void run_osal(uint32_t timers, uint64_t period_ms)
+{
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        osal_args[i].handler = osal_handler;
+        osal_args[i].arg = &stats[i];
+        if(osal_timer_init(&osal_timers[i], &osal_args[i]))
+        {
+            fprintf(stderr, "osal_timer_init failed\n");
+            exit(EXIT_FAILURE);
+        }
+        (void)osal_timer_arm(&osal_timers[i], period_ms, eTIMER_TYPE_REPEAT);
+    }
+}
+
+static void stop_osal(uint32_t timers)
+{
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        osal_timer_destroy(&osal_timers[i]);
+    }
+}
+
+/* --------------------------- SIGEV_THREAD backend -------------------------- */
+
+static timer_t posix_timers[MAX_TIMERS];
+
+static void posix_handler(union sigval arg)
+{
+    record_expiry((TimerStats*)arg.sival_ptr);
+}
+
+static void run_posix(uint32_t timers, uint64_t period_ms)
+{
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        struct sigevent sig_event;
+        memset(&sig_event, 0, sizeof(sig_event));
+        sig_event.sigev_notify = SIGEV_THREAD;
+        sig_event.sigev_notify_function = posix_handler;
+        sig_event.sigev_value.sival_ptr = &stats[i];
+
+        if(timer_create(CLOCK_MONOTONIC, &sig_event, &posix_timers[i]) == -1)
+        {
+            perror("timer_create");
+            exit(EXIT_FAILURE);
+        }
+
+        struct itimerspec its;
+        its.it_value.tv_sec = (time_t)(period_ms / 1000);
+        its.it_value.tv_nsec = (long)((period_ms % 1000) * 1000000ull);
+        its.it_interval = its.it_value;
+        (void)timer_settime(posix_timers[i], 0, &its, NULL);
+    }
+}
+
+static void stop_posix(uint32_t timers)
+{
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        (void)timer_delete(posix_timers[i]);
+    }
+}
+
+/* --------------------------------- Report ---------------------------------- */
+
+static int compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char* name, uint32_t timers, uint64_t cpu, uint64_t wall)
+{
+    static uint64_t all[MAX_TIMERS * MAX_SAMPLES];
+    uint32_t total = 0;
+    uint64_t sum = 0;
+
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        memcpy(&all[total], stats[i].deviation_ns, stats[i].count * sizeof(uint64_t));
+        total += stats[i].count;
+    }
+    if(total == 0)
+    {
+        printf("%-14s no samples\n", name);
+        return;
+    }
+
+    qsort(all, total, sizeof(uint64_t), compare_u64);
+    for(uint32_t i = 0; i < total; ++i)
+    {
+        sum += all[i];
+    }
+
+    printf("%-14s samples %7u  jitter mean %7.1f us  p99 %7.1f us  max %8.1f us  cpu %5.2f %%\n",
+           name, total,
+           (double)sum / total / 1000.0,
+           (double)all[(total * 99) / 100] / 1000.0,
+           (double)all[total - 1] / 1000.0,
+           100.0 * (double)cpu / (double)wall);
+}
+
+static void reset_stats(uint32_t timers)
+{
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        stats[i].last_ns = 0;
+        stats[i].count = 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t timers = (argc > 1) ? (uint32_t)atoi(argv[1]) : 4;
+    uint64_t period_ms = (argc > 2) ? (uint64_t)atoi(argv[2]) : 5;
+    uint64_t duration_s = (argc > 3) ? (uint64_t)atoi(argv[3]) : 5;
+
+    if(timers == 0 || timers > MAX_TIMERS || period_ms == 0)
+    {
+        fprintf(stderr, "usage: %s [timers <= %d] [period_ms > 0] [duration_s]\n", argv[0], MAX_TIMERS);
+        return EXIT_FAILURE;
+    }
+
+    period_ns = period_ms * 1000000ull;
+    for(uint32_t i = 0; i < timers; ++i)
+    {
+        stats[i].deviation_ns = calloc(MAX_SAMPLES, sizeof(uint64_t));
+    }
+
+    printf("%u timers, %llu ms period, %llu s per backend\n",
+           timers, (unsigned long long)period_ms, (unsigned long long)duration_s);
+
+    reset_stats(timers);
+    uint64_t cpu_start = cpu_ns();
+    uint64_t wall_start = now_ns();
+    run_posix(timers, period_ms);
+    struct timespec ts = { .tv_sec = (time_t)duration_s, .tv_nsec = 0 };
+    nanosleep(&ts, NULL);
+    stop_posix(timers);
+    report("SIGEV_THREAD", timers, cpu_ns() - cpu_start, now_ns() - wall_start);
+
+    reset_stats(timers);
+    cpu_start = cpu_ns();
+    wall_start = now_ns();
+    run_osal(timers, period_ms);
+    nanosleep(&ts, NULL);
+    stop_osal(timers);
+    report("timer service", timers, cpu_ns() - cpu_start, now_ns() - wall_start);
+
+    return EXIT_SUCCESS;
+}
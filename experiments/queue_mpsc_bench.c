@@ -0,0 +1,97 @@
+/*
+ * Queue benchmark: the mutex protected util_queue against the lock-free MPSC
+ * ring, with several producer threads posting to one consumer, like the
+ * sensor AOs and timer service all posting to the scheduler AO.
+ * Producers spin while the queue is full.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/queue_mpsc_bench.c \
+ *       src/util/queue/queue.c src/osal/osal.c -o experiments/queue_mpsc_bench
+ *
+ * Usage: ./queue_mpsc_bench [items_per_producer] [producers] [capacity]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "util/queue/queue.h"
+
+#define PRODUCER_MAX_COUNT 16
+
+static uint32_t items;
+static uint32_t producers;
+static uint32_t capacity;
+static Queue    queue;
+static int      tokens[PRODUCER_MAX_COUNT];
+
+static void* producer(void* arg)
+{
+    int* token = arg;
+    for(uint32_t i = 0; i < items; ++i)
+    {
+        while(util_queue_push(&queue, token) != eSTATUS_SUCCESSFUL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void bench(const char* name, eQueueType type)
+{
+    pthread_t threads[PRODUCER_MAX_COUNT];
+    uint32_t received[PRODUCER_MAX_COUNT] = { 0 };
+    void* element;
+
+    if(util_queue_init_ex(&queue, capacity, type))
+    {
+        fprintf(stderr, "util_queue_init_ex failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t start = osal_time_now_ns();
+    for(uint32_t p = 0; p < producers; ++p)
+    {
+        pthread_create(&threads[p], NULL, producer, &tokens[p]);
+    }
+    for(uint64_t i = 0; i < (uint64_t)items * producers; ++i)
+    {
+        (void)util_queue_pop(&queue, &element);
+        received[(int*)element - tokens]++;
+    }
+    uint64_t elapsed = osal_time_now_ns() - start;
+    for(uint32_t p = 0; p < producers; ++p)
+    {
+        pthread_join(threads[p], NULL);
+        if(received[p] != items)
+        {
+            fprintf(stderr, "%s: producer %u delivered %u of %u items\n", name, p, received[p], items);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%-7s throughput %6.2f M items/s  consumer wakeups %u\n", name,
+           (double)items * producers / ((double)elapsed / 1e9) / 1e6, queue.ring.wakeups);
+
+    util_queue_delete(&queue);
+}
+
+int main(int argc, char* argv[])
+{
+    items = (argc > 1) ? (uint32_t)atoi(argv[1]) : 250000;
+    producers = (argc > 2) ? (uint32_t)atoi(argv[2]) : 4;
+    capacity = (argc > 3) ? (uint32_t)atoi(argv[3]) : 64;
+    if(items == 0 || producers == 0 || producers > PRODUCER_MAX_COUNT || capacity == 0)
+    {
+        fprintf(stderr, "usage: %s [items > 0] [producers 1..%d] [capacity > 0]\n", argv[0], PRODUCER_MAX_COUNT);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u producers x %u items, capacity %u\n", producers, items, capacity);
+    bench("locked", eQUEUE_TYPE_LOCKED);
+    bench("mpsc", eQUEUE_TYPE_MPSC);
+
+    return EXIT_SUCCESS;
+}
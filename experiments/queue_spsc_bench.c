@@ -0,0 +1,122 @@
+/*
+ * Queue benchmark: the mutex protected util_queue against the lock-free SPSC
+ * ring, with one producer and one consumer thread.
+ *   throughput - the producer streams items, spinning while the queue is full
+ *   latency    - one item in flight, bounced back through a second queue
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/queue_spsc_bench.c \
+ *       src/util/queue/queue.c src/osal/osal.c -o experiments/queue_spsc_bench
+ *
+ * Usage: ./queue_spsc_bench [items] [capacity]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "util/queue/queue.h"
+
+static uint32_t items;
+static uint32_t capacity;
+static Queue    forward, backward;
+
+static void* stream_consumer(void* arg)
+{
+    (void)arg;
+    void* element;
+    for(uint32_t i = 0; i < items; ++i)
+    {
+        (void)util_queue_pop(&forward, &element);
+    }
+    return NULL;
+}
+
+static void* echo_consumer(void* arg)
+{
+    (void)arg;
+    void* element;
+    for(uint32_t i = 0; i < items; ++i)
+    {
+        (void)util_queue_pop(&forward, &element);
+        while(util_queue_push(&backward, element) != eSTATUS_SUCCESSFUL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static double run_throughput(void)
+{
+    static int token;
+    pthread_t thread;
+
+    uint64_t start = osal_time_now_ns();
+    pthread_create(&thread, NULL, stream_consumer, NULL);
+    for(uint32_t i = 0; i < items; ++i)
+    {
+        while(util_queue_push(&forward, &token) != eSTATUS_SUCCESSFUL)
+        {
+            sched_yield();
+        }
+    }
+    pthread_join(thread, NULL);
+
+    return (double)items / ((double)(osal_time_now_ns() - start) / 1e9);
+}
+
+static double run_latency(void)
+{
+    static int token;
+    pthread_t thread;
+    void* element;
+
+    uint64_t start = osal_time_now_ns();
+    pthread_create(&thread, NULL, echo_consumer, NULL);
+    for(uint32_t i = 0; i < items; ++i)
+    {
+        (void)util_queue_push(&forward, &token);
+        (void)util_queue_pop(&backward, &element);
+    }
+    pthread_join(thread, NULL);
+
+    return (double)(osal_time_now_ns() - start) / items / 1000.0;
+}
+
+static void bench(const char* name, eQueueType type)
+{
+    if(util_queue_init_ex(&forward, capacity, type) || util_queue_init_ex(&backward, capacity, type))
+    {
+        fprintf(stderr, "util_queue_init_ex failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double rate = run_throughput();
+    uint32_t stream_wakeups = forward.ring.wakeups;
+    double round_trip = run_latency();
+
+    printf("%-7s throughput %6.2f M items/s  round trip %6.2f us  consumer wakeups %u\n",
+           name, rate / 1e6, round_trip, stream_wakeups);
+
+    util_queue_delete(&forward);
+    util_queue_delete(&backward);
+}
+
+int main(int argc, char* argv[])
+{
+    items = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000000;
+    capacity = (argc > 2) ? (uint32_t)atoi(argv[2]) : 64;
+    if(items == 0 || capacity == 0)
+    {
+        fprintf(stderr, "usage: %s [items > 0] [capacity > 0]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u items, capacity %u\n", items, capacity);
+    bench("locked", eQUEUE_TYPE_LOCKED);
+    bench("spsc", eQUEUE_TYPE_SPSC);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+/*
+ * LOCK latency under load: an AO shaped like the servo, whose DIRECTIONS
+ * handler holds the thread for a whole move, is kept saturated with
+ * DIRECTIONS while LOCK events are posted periodically. Reports the time from
+ * posting a LOCK to the start of its move, with the single FIFO and with the
+ * servo's event priorities (SERVO_EVENT_PRIORITIES).
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/servo_lock_latency.c \
+ *       src/osal/osal.c src/util/queue/queue.c src/util/fsm/fsm.c \
+ *       src/util/active_object/active_object.c src/util/histogram/histogram.c \
+ *       src/util/event_pool/event_pool.c src/util/trace/trace.c \
+ *       src/util/executor/executor.c -o experiments/servo_lock_latency
+ *
+ * Usage: ./servo_lock_latency [locks] [move_us]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "osal/osal.h"
+#include "util/active_object/active_object.h"
+#include "ddl/servo/servo_events.h"
+#include "ddl/servo/servo_config.h"
+
+static const uint8_t servo_event_priorities[] = { SERVO_EVENT_PRIORITIES };
+
+static Event directions_event = { .type = eSERVO_EVENT_DIRECTIONS };
+static Event lock_event = { .type = eSERVO_EVENT_LOCK };
+
+static ActiveObject servo;
+static uint32_t     locks;
+static uint64_t     move_us;
+static uint64_t     lock_posted_ns;
+static uint64_t*    samples;
+static uint32_t     sample_count;
+static bool         flooding;
+
+static void servo_state(FSM* fsm, Event* event)
+{
+    (void)fsm;
+
+    switch(event->type)
+    {
+        case eSERVO_EVENT_LOCK:
+            samples[sample_count++] = osal_time_now_ns() - __atomic_load_n(&lock_posted_ns, __ATOMIC_ACQUIRE);
+            osal_delay_us(move_us);
+            break;
+        case eSERVO_EVENT_DIRECTIONS:
+            osal_delay_us(move_us);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Keeps the queue full of DIRECTIONS, like a tracker publishing faster than the servo moves */
+static void* flood(void* arg)
+{
+    (void)arg;
+    while(__atomic_load_n(&flooding, __ATOMIC_RELAXED))
+    {
+        if(util_active_object_post(&servo, &directions_event) != eSTATUS_SUCCESSFUL)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench(const char* name, const ActiveObjectAttr* attr)
+{
+    pthread_t thread;
+
+    sample_count = 0;
+    if(util_active_object_init(&servo, eSERVO_QUEUE_CAPACITY, servo_state, attr))
+    {
+        fprintf(stderr, "util_active_object_init failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    __atomic_store_n(&flooding, true, __ATOMIC_RELAXED);
+    pthread_create(&thread, NULL, flood, NULL);
+    for(uint32_t i = 0; i < locks; ++i)
+    {
+        osal_delay_us(move_us * (eSERVO_QUEUE_CAPACITY + 2));
+        __atomic_store_n(&lock_posted_ns, osal_time_now_ns(), __ATOMIC_RELEASE);
+        while(util_active_object_post(&servo, &lock_event) != eSTATUS_SUCCESSFUL)
+        {
+            sched_yield();
+        }
+    }
+    osal_delay_us(move_us * (eSERVO_QUEUE_CAPACITY + 2));
+    __atomic_store_n(&flooding, false, __ATOMIC_RELAXED);
+    pthread_join(thread, NULL);
+
+    (void)util_active_object_end(&servo);
+    util_active_object_join(&servo);
+    util_active_object_delete(&servo);
+
+    qsort(samples, sample_count, sizeof(uint64_t), compare_u64);
+    printf("%-10s LOCK to move p50 %8.2f us  p99 %8.2f us  max %8.2f us  (%u locks)\n", name,
+           (double)samples[sample_count / 2] / 1000.0,
+           (double)samples[(sample_count * 99) / 100] / 1000.0,
+           (double)samples[sample_count - 1] / 1000.0, sample_count);
+}
+
+int main(int argc, char* argv[])
+{
+    static const ActiveObjectAttr fifo_attr = { .queue_type = eQUEUE_TYPE_LOCKED };
+    static const ActiveObjectAttr priority_attr = {
+        .queue_type           = eQUEUE_TYPE_LOCKED,
+        .urgent_capacity      = eSERVO_URGENT_CAPACITY,
+        .event_priorities     = servo_event_priorities,
+        .event_priority_count = sizeof(servo_event_priorities) / sizeof(servo_event_priorities[0])
+    };
+
+    locks = (argc > 1) ? (uint32_t)atoi(argv[1]) : 200;
+    move_us = (argc > 2) ? (uint64_t)atoi(argv[2]) : 2000;
+    if(locks == 0 || move_us == 0)
+    {
+        fprintf(stderr, "usage: %s [locks > 0] [move_us > 0]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    samples = calloc(locks, sizeof(uint64_t));
+
+    (void)osal_init();
+    printf("queue capacity %d, move %llu us\n", eSERVO_QUEUE_CAPACITY, (unsigned long long)move_us);
+    bench("fifo", &fifo_attr);
+    bench("priority", &priority_attr);
+
+    return EXIT_SUCCESS;
+}
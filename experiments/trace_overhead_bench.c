@@ -0,0 +1,103 @@
+/*
+ * Trace overhead: cost of one util_trace_record, with the trace disabled and
+ * enabled, from one and from several threads at once. Each thread records into
+ * its own ring, so the cost per record should stay flat as threads are added.
+ * Ends with the time to export the full rings as Chrome trace JSON.
+ *
+ * Build from the repository root:
+ *   gcc -std=c99 -O2 -D_GNU_SOURCE -pthread -Isrc experiments/trace_overhead_bench.c \
+ *       src/util/trace/trace.c src/osal/osal.c -o experiments/trace_overhead_bench
+ *
+ * Usage: ./trace_overhead_bench [records] [max_threads]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "util/trace/trace.h"
+#include "osal/osal.h"
+
+#define MAX_THREADS 8
+
+static uint32_t records;
+static int      object;
+
+/* Thread CPU time, so that threads sharing a core don't count each other's turns */
+static uint64_t thread_now_ns(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void* recorder(void* arg)
+{
+    uint64_t* elapsed_ns = arg;
+    uint64_t start = thread_now_ns();
+    for(uint32_t i = 0; i < records; i++)
+    {
+        util_trace_record(eTRACE_KIND_POST, &object, i, 0);
+    }
+    *elapsed_ns = thread_now_ns() - start;
+    return NULL;
+}
+
+/* Returns the average ns per record over all threads */
+static double run_recorders(uint32_t count)
+{
+    OsalThread threads[MAX_THREADS];
+    uint64_t elapsed_ns[MAX_THREADS];
+    uint64_t total_ns = 0;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        (void)osal_thread_create(&threads[i], recorder, &elapsed_ns[i]);
+    }
+    for(uint32_t i = 0; i < count; i++)
+    {
+        osal_thread_join(&threads[i]);
+        total_ns += elapsed_ns[i];
+    }
+
+    return (double)total_ns / ((double)records * count);
+}
+
+int main(int argc, char* argv[])
+{
+    records = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000000;
+    uint32_t max_threads = (argc > 2) ? (uint32_t)atoi(argv[2]) : 4;
+    if(records == 0 || max_threads == 0 || max_threads > MAX_THREADS)
+    {
+        fprintf(stderr, "usage: %s [records > 0] [max_threads 1..%d]\n", argv[0], MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    if(osal_init())
+    {
+        fprintf(stderr, "init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    for(uint32_t count = 1; count <= max_threads; count *= 2)
+    {
+        util_trace_init();
+        util_trace_enable(false);
+        double disabled = run_recorders(count);
+
+        util_trace_init();
+        double enabled = run_recorders(count);
+        printf("record  %u threads  disabled %6.1f ns  enabled %6.1f ns\n", count, disabled, enabled);
+    }
+
+    int fd = open("/dev/null", O_WRONLY);
+    uint64_t start = osal_time_now_ns();
+    eStatus status = util_trace_export(fd);
+    printf("export  %u full rings  %.2f ms  (%s)\n", max_threads, (double)(osal_time_now_ns() - start) / 1e6,
+           status ? "failed" : "ok");
+    (void)close(fd);
+
+    return EXIT_SUCCESS;
+}
@@ -12,6 +12,7 @@
 #include "app/scheduler/scheduler_events.h"
 #include "ddl/ddl_frame.h"
 #include "util/log/log.h"
+#include "osal/osal.h"
 #include "hal/hal.h"
 #include "app/app.h"
 
@@ -119,6 +120,14 @@ DdlBridge* ddl_bridge_start(WebSocketServer* ws, unsigned int period_ms)
         return NULL;
     }
 
+    if(osal_init() != eSTATUS_SUCCESSFUL)
+    {
+        fprintf(stderr, "[BRIDGE] osal_init failed\n");
+        log_exit();
+        free(b);
+        return NULL;
+    }
+
     if(hal_init() != eSTATUS_SUCCESSFUL)
     {
         fprintf(stderr, "[BRIDGE] hal_init failed\n");
@@ -143,6 +152,7 @@ DdlBridge* ddl_bridge_start(WebSocketServer* ws, unsigned int period_ms)
         return NULL;
     }
     b->app_up = true;
+    osal_alloc_seal();
 
     if(util_event_bus_publish(eAO_SCHEDULER, eSCHEDULER_EVENT_START) != eSTATUS_SUCCESSFUL)
     {
@@ -8,6 +8,7 @@
 #include "broadcaster/broadcaster.h"
 #include "scheduler/scheduler.h"
 #include "util/log/log.h"
+#include "osal/osal.h"
 #include "ddl/ddl.h"
 
 typedef struct
@@ -45,8 +46,30 @@ static APPModule app_modules[eAPP_MODULE_COUNT] = {
     }
 };
 
-static DDLFrame ddl_frame;
-static DDLFrame ddl_snapshot;
+static DDLFrame  ddl_frame;
+static DDLFrame  ddl_snapshot;
+static OsalArena app_arena;
+
+static eStatus app_init_modules(void)
+{
+    for(uint32_t module_index = 0; module_index < eAPP_MODULE_COUNT; module_index++)
+    {
+        LOG_DEBUG("Initializing %s module", app_modules[module_index].module_name);
+        eStatus status = app_modules[module_index].module_init();
+        if(status)
+        {
+            return status;
+        }
+        status = util_event_bus_subscribe(app_modules[module_index].ao_id, app_post,
+                                            module_index, &app_modules[module_index].subscribe_event);
+        if(status)
+        {
+            return status;
+        }
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
 
 eStatus app_init(void)
 {
@@ -67,20 +90,25 @@ eStatus app_init(void)
     }
 
     LOG_INFO("Initializing the APP layer");
-    for(uint32_t module_index = 0; module_index < eAPP_MODULE_COUNT; module_index++)
+    status = osal_arena_create(&app_arena, eAPP_ARENA_SIZE, "APP");
+    if(status)
     {
-        LOG_DEBUG("Initializing %s module", app_modules[module_index].module_name);
-        status = app_modules[module_index].module_init();
-        if(status)
-        {
-            return status;
-        }
-        status = util_event_bus_subscribe(app_modules[module_index].ao_id, app_post,
-                                            module_index, &app_modules[module_index].subscribe_event);
-        if(status)
-        {
-            return status;
-        }
+        LOG_ERROR("Failed to create the APP arena");
+        return status;
+    }
+
+    osal_arena_bind(&app_arena);
+    status = app_init_modules();
+    osal_arena_bind(NULL);
+    osal_arena_seal(&app_arena);
+
+    OsalArenaStats stats;
+    osal_arena_stats(&app_arena, &stats);
+    LOG_INFO("%s arena: peak %zu of %zu bytes in %u allocations",
+             stats.name, stats.peak, stats.size, stats.allocations);
+    if(status)
+    {
+        return status;
     }
 
     LOG_DEBUG("Registering modules to scheduler");
@@ -173,6 +201,8 @@ void app_delete(void)
         app_modules[module_index].module_delete();
     }
 
+    osal_arena_destroy(&app_arena);
+
     LOG_INFO("Deleting DDL resources");
     ddl_delete();
 }
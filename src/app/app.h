@@ -12,7 +12,8 @@
 
 /**
  * @brief   Initialize the APP layer.
- * @details This function calls ddl_init() from within.
+ * @details This function calls ddl_init() from within. Allocations of the
+ *          APP modules are carved from the APP arena, sealed afterwards.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      a module is misconfigured
@@ -8,4 +8,9 @@ typedef enum eAPPModules
     eAPP_MODULE_COUNT
 } eAPPModules;
 
+typedef enum eAPPConfig
+{
+    eAPP_ARENA_SIZE = 2048
+} eAPPConfig;
+
 #endif
\ No newline at end of file
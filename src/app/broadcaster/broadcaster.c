@@ -11,6 +11,17 @@
 
 static BroadcasterObject broadcaster_aobj;
 
+static const ActiveObjectAttr broadcaster_aobj_attr = {
+    .thread = {
+        .affinity_mask  = eBROADCASTER_THREAD_AFFINITY_MASK,
+        .name           = BROADCASTER_THREAD_NAME,
+        .stack_size     = eBROADCASTER_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eBROADCASTER_THREAD_POLICY,
+        .priority       = eBROADCASTER_THREAD_PRIORITY
+    },
+    .executor = eBROADCASTER_ON_EXECUTOR
+};
+
 eStatus app_broadcaster_configure(DDLFrame* source, DDLFrame* destination)
 {
     if(source == NULL || destination == NULL)
@@ -30,7 +41,7 @@ eStatus app_broadcaster_init(void)
     }
     return util_active_object_init(&broadcaster_aobj.aobj,
                                    eBROADCASTER_QUEUE_CAPACITY,
-                                   broadcaster_init_state);
+                                   broadcaster_init_state, &broadcaster_aobj_attr);
 }
 
 eStatus app_broadcaster_post(Event* event)
@@ -1,9 +1,19 @@
 #ifndef APP_BROADCASTER_CONFIG_H
 #define APP_BROADCASTER_CONFIG_H
 
+/* User library includes */
+#include "osal/osal.h"
+
+#define BROADCASTER_THREAD_NAME "broadcaster"
+
 typedef enum eBroadcasterConfig
 {
-    eBROADCASTER_QUEUE_CAPACITY = 4
+    eBROADCASTER_QUEUE_CAPACITY = 4,
+    eBROADCASTER_ON_EXECUTOR = 1,      // on the executor's workers instead of a thread of its own
+    eBROADCASTER_THREAD_POLICY = eTHREAD_POLICY_INHERIT,
+    eBROADCASTER_THREAD_PRIORITY = 0,
+    eBROADCASTER_THREAD_AFFINITY_MASK = 0,
+    eBROADCASTER_THREAD_STACK_SIZE = 0
 } eBroadcasterConfig;
 
 #endif
\ No newline at end of file
@@ -13,6 +13,16 @@
 
 static SchedulerObject scheduler_aobj;
 
+static const ActiveObjectAttr scheduler_aobj_attr = {
+    .thread = {
+        .affinity_mask  = eSCHEDULER_THREAD_AFFINITY_MASK,
+        .name           = SCHEDULER_THREAD_NAME,
+        .stack_size     = eSCHEDULER_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eSCHEDULER_THREAD_POLICY,
+        .priority       = eSCHEDULER_THREAD_PRIORITY
+    }
+};
+
 eStatus app_scheduler_init(void)
 {
     scheduler_aobj.tick = 0;
@@ -20,8 +30,19 @@ eStatus app_scheduler_init(void)
     (void)memset(scheduler_aobj.subscribers, 0,
         eSCHEDULER_SUBSCRIBERS_MAX * sizeof(Subscriber));
 
-    return util_active_object_init(&scheduler_aobj.aobj, 
-        eSCHEDULER_QUEUE_CAPACITY, scheduler_init_state);
+    if(osal_mutex_init(&scheduler_aobj.subscribers_mutex))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    eStatus status = util_active_object_init(&scheduler_aobj.aobj,
+        eSCHEDULER_QUEUE_CAPACITY, scheduler_init_state, &scheduler_aobj_attr);
+    if(status)
+    {
+        osal_mutex_destroy(&scheduler_aobj.subscribers_mutex);
+    }
+
+    return status;
 }
 
 eStatus app_scheduler_subscribe(uint32_t slot, eActiveObjectID ao_id, Event* event)
@@ -36,8 +57,11 @@ eStatus app_scheduler_subscribe(uint32_t slot, eActiveObjectID ao_id, Event* eve
         return eSTATUS_NULL_PARAM;
     }
 
+    osal_mutex_lock(&scheduler_aobj.subscribers_mutex);
+
     if(scheduler_aobj.subscribers[slot].active)
     {
+        osal_mutex_unlock(&scheduler_aobj.subscribers_mutex);
         return eSTATUS_ACTION_FAILED;
     }
 
@@ -45,9 +69,28 @@ eStatus app_scheduler_subscribe(uint32_t slot, eActiveObjectID ao_id, Event* eve
     scheduler_aobj.subscribers[slot].event = event;
     scheduler_aobj.subscribers[slot].active = true;
 
+    osal_mutex_unlock(&scheduler_aobj.subscribers_mutex);
+
     return eSTATUS_SUCCESSFUL;
 }
 
+eStatus app_scheduler_unsubscribe(uint32_t slot)
+{
+    if(slot >= eSCHEDULER_SUBSCRIBERS_MAX)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    osal_mutex_lock(&scheduler_aobj.subscribers_mutex);
+
+    bool active = scheduler_aobj.subscribers[slot].active;
+    scheduler_aobj.subscribers[slot].active = false;
+
+    osal_mutex_unlock(&scheduler_aobj.subscribers_mutex);
+
+    return active ? eSTATUS_SUCCESSFUL : eSTATUS_ACTION_FAILED;
+}
+
 eStatus app_scheduler_post(Event* event)
 {
     return util_active_object_post(&scheduler_aobj.aobj, event);
@@ -66,5 +109,5 @@ void app_scheduler_join(void)
 void app_scheduler_delete(void)
 {
     util_active_object_delete(&scheduler_aobj.aobj);
-    osal_timer_destroy(scheduler_aobj.timer);
+    osal_mutex_destroy(&scheduler_aobj.subscribers_mutex);
 }
\ No newline at end of file
@@ -18,7 +18,7 @@ eStatus app_scheduler_init(void);
  * @brief   Subscribe to the scheduling service.
  * @details The scheduling service holds an array of time slots it triggers
  *          preodically. Each slot needs to be subscribed to by a module to
- *          time the events it requires to operate.
+ *          time the events it requires to operate. Can be called at runtime.
  * @param   slot The time slot (index) the module subscribes to.
  * @param   ao_id The Active Object module ID from @ref eActiveObjectID.
  * @param   event The event that will be sent to the subscribing module.
@@ -30,6 +30,19 @@ eStatus app_scheduler_init(void);
  */
 eStatus app_scheduler_subscribe(uint32_t slot, eActiveObjectID ao_id, Event* event);
 
+/**
+ * @brief   Free a time slot of the scheduling service.
+ * @details The slot's ticks publish nothing until a module subscribes to it
+ *          again. Can be called at runtime, a tick already publishing to the
+ *          slot may still go out.
+ * @param   slot The time slot (index) to free.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   slot is out of bounds
+ * @retval  eSTATUS_ACTION_FAILED   slot is not subscribed to
+ */
+eStatus app_scheduler_unsubscribe(uint32_t slot);
+
 /**
  * @brief   Send event to the scheduler.
  * @param   event An event from @ref eDistanceEvent.
@@ -1,12 +1,21 @@
 #ifndef DDL_SCHEDULER_CONFIG_H
 #define DDL_SCHEDULER_CONFIG_H 
 
+/* User library includes */
+#include "osal/osal.h"
+
+#define SCHEDULER_THREAD_NAME "scheduler"
+
 typedef enum eSchedulerConfig
 {
     eSCHEDULER_QUEUE_CAPACITY  = 4,
     eSCHEDULER_CYCLE_TIME_MS   = 2000,
     eSCHEDULER_SUBSCRIBERS_MAX = 6,
-    eSCHEDULER_TICK_MS = eSCHEDULER_CYCLE_TIME_MS / eSCHEDULER_SUBSCRIBERS_MAX
+    eSCHEDULER_TICK_MS = eSCHEDULER_CYCLE_TIME_MS / eSCHEDULER_SUBSCRIBERS_MAX,
+    eSCHEDULER_THREAD_POLICY = eTHREAD_POLICY_FIFO,
+    eSCHEDULER_THREAD_PRIORITY = 50,
+    eSCHEDULER_THREAD_AFFINITY_MASK = 0,
+    eSCHEDULER_THREAD_STACK_SIZE = 0
 } eSchedulerConfig;
 
 #endif
\ No newline at end of file
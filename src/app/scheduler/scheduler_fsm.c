@@ -10,33 +10,34 @@
 #include "util/log/log.h"
 #include "osal/osal.h"
 
-static TimerArg timer_arg;
+/* Repeats on the AO's queue every eSCHEDULER_TICK_MS while running */
+static Event tick_event = { .type = eSCHEDULER_EVENT_TICK };
 
-static void tick_handler(void* arg)
+/* Publishes the event of the slot's subscriber, free slots publish nothing */
+static void publish_slot(SchedulerObject* aobj, uint32_t slot)
 {
-    static Event tick_event = { .type = eSCHEDULER_EVENT_TICK };
-    SchedulerObject* aobj = (SchedulerObject*)arg;
-    // Post eSCHEDULER_EVENT_TICK to itself 
-    (void)util_active_object_post(&aobj->aobj, &tick_event);
+    osal_mutex_lock(&aobj->subscribers_mutex);
+    Subscriber subscriber = aobj->subscribers[slot];
+    osal_mutex_unlock(&aobj->subscribers_mutex);
+
+    if(subscriber.active)
+    {
+        LOG_DEBUG("Publishing event to subscriber %u", slot);
+        eStatus status = util_event_bus_publish(subscriber.ao_id, subscriber.event->type);
+        if(status)
+        {
+            LOG_ERROR("Scheduler failed to alert registered subscriber at slot %u", slot);
+        }
+    }
 }
 
 void scheduler_init_state(FSM* fsm, Event* event)
 {
-    SchedulerObject* aobj = (SchedulerObject*)fsm->arg;
     switch(event->type)
     {
     case eFSM_EVENT_INIT:
         LOG_DEBUG("INIT entry");
-        timer_arg.handler = tick_handler;
-        timer_arg.arg = aobj;
-        if(osal_timer_init(&aobj->timer, &timer_arg))
-        {
-            (void)util_fsm_transition(fsm, scheduler_error_state);
-        }
-        else
-        {
-            (void)util_fsm_transition(fsm, scheduler_idle_state);
-        }
+        (void)util_fsm_transition(fsm, scheduler_idle_state);
         break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("INIT exit");
@@ -85,18 +86,13 @@ void scheduler_idle_state(FSM* fsm, Event* event)
 void scheduler_run_state(FSM* fsm, Event* event)
 {
     SchedulerObject* aobj = (SchedulerObject*)fsm->arg;
-    eStatus status;
 
     switch(event->type)
     {
     case eFSM_EVENT_ENTRY:
-        LOG_DEBUG("IDLE entry. Publishing event to subscriber 0");
-        (void)osal_timer_arm(aobj->timer, eSCHEDULER_TICK_MS, eTIMER_TYPE_REPEAT);
-        status = util_event_bus_publish(aobj->subscribers[0].ao_id, aobj->subscribers[0].event->type);
-        if(status)
-        {
-            LOG_ERROR("Scheduler failed to alert registered subscriber at slot 0");
-        }
+        LOG_DEBUG("RUN entry");
+        (void)util_active_object_arm(&aobj->aobj, &tick_event, eSCHEDULER_TICK_MS, true);
+        publish_slot(aobj, 0);
         break;
     case eSCHEDULER_EVENT_STOP:
         LOG_DEBUG("Scheduler stop event received");
@@ -104,19 +100,11 @@ void scheduler_run_state(FSM* fsm, Event* event)
         break;
     case eSCHEDULER_EVENT_TICK:
         aobj->tick = (aobj->tick + 1) % eSCHEDULER_SUBSCRIBERS_MAX;
-        if(aobj->subscribers[aobj->tick].active)
-        {
-            LOG_DEBUG("Tick received. Publishing event to subscriber %d", aobj->tick);
-            status = util_event_bus_publish(aobj->subscribers[aobj->tick].ao_id, aobj->subscribers[aobj->tick].event->type);
-            if(status)
-            {
-                LOG_ERROR("Scheduler failed to alert registered subscriber at slot %u", aobj->tick);
-            }
-        }
+        publish_slot(aobj, aobj->tick);
         break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("IDLE exit");
-        (void)osal_timer_disarm(aobj->timer);
+        (void)util_active_object_disarm(&aobj->aobj, &tick_event);
         break;
     default:
         LOG_WARNING("Unknown event type %u", event->type);
@@ -33,7 +33,7 @@ void scheduler_idle_state(FSM* fsm, Event* event);
 
 /**
  * @brief   The running state of the scheduler.
- * @details This state arms a timer on entry and triggers the
+ * @details This state arms a repeating tick on entry and triggers the
  *          modules subscribed to it according to the event they
  *          subscribed with. From this state we can go to
  *          scheduler_idle state.
@@ -22,10 +22,10 @@ typedef struct
 typedef struct
 {
     ActiveObject aobj;
-    void*        timer;
     uint32_t     tick;
     uint32_t     padding;
     Subscriber   subscribers[eSCHEDULER_SUBSCRIBERS_MAX];
+    OsalMutex    subscribers_mutex;     // slots change at runtime, the ticks read them
 } SchedulerObject;
 
 #endif
\ No newline at end of file
@@ -1,13 +1,22 @@
 #include "ddl.h"
 
+/* Standard library includes */
+#include <stdbool.h>
+
 /* User library includes */
+#include "ddl/temperature_humidity/temperature_humidity_config.h"
 #include "ddl/temperature_humidity/temperature_humidity.h"
 #include "util/event_bus/event_config.h"
 #include "util/event_bus/event_bus.h"
+#include "util/supervisor/supervisor.h"
+#include "ddl/distance/distance_config.h"
 #include "ddl/distance/distance.h"
+#include "ddl/servo/servo_config.h"
 #include "ddl/servo/servo.h"
 #include "util/log/log.h"
+#include "ddl/gps/gps_config.h"
 #include "ddl/gps/gps.h"
+#include "osal/osal.h"
 
 typedef struct
 {
@@ -16,10 +25,16 @@ typedef struct
     eStatus (*module_end)(void);
     void (*module_join)(void);
     void (*module_delete)(void);
+    eStatus (*module_get_stats)(ActiveObjectStats* stats);
+    void (*module_invalidate)(void);    // NULL for a frame section without a valid flag
     uint32_t    ao_id;
     uint32_t    subscribe_events_count;
     Event*      subscribe_events;
     const char* module_name;
+    OsalArena   arena;                  // everything the module allocates while initializing
+    uint32_t    stall_deadline_ms;
+    bool        attached;
+    uint8_t     reserved[3];
 } DDLModule;
 
 static Event distance_subscribe_events[] = {
@@ -48,11 +63,14 @@ static DDLModule ddl_modules[eDLL_MODULE_COUNT] = {
         .module_end             = ddl_distance_end,
         .module_join            = ddl_distance_join,
         .module_delete          = ddl_distance_delete,
+        .module_get_stats       = ddl_distance_get_stats,
+        .module_invalidate      = ddl_distance_invalidate,
         .ao_id                  = eAO_DISTANCE,
         .subscribe_events_count = sizeof(distance_subscribe_events) / 
                                     sizeof(distance_subscribe_events[0]),
         .subscribe_events       = distance_subscribe_events,
-        .module_name            = "distance"
+        .module_name            = "distance",
+        .stall_deadline_ms      = eDISTANCE_STALL_DEADLINE_MS
     },
     [eDDL_MODULE_SERVO] = {
         .module_init            = ddl_servo_init,
@@ -60,11 +78,13 @@ static DDLModule ddl_modules[eDLL_MODULE_COUNT] = {
         .module_end             = ddl_servo_end,
         .module_join            = ddl_servo_join,
         .module_delete          = ddl_servo_delete,
+        .module_get_stats       = ddl_servo_get_stats,
         .ao_id                  = eAO_SERVO,
         .subscribe_events_count = sizeof(servo_subscribe_events) /
                                     sizeof(servo_subscribe_events[0]),
         .subscribe_events       = servo_subscribe_events,
-        .module_name            = "servo"
+        .module_name            = "servo",
+        .stall_deadline_ms      = eSERVO_STALL_DEADLINE_MS
     },
     [eDDL_MODULE_TEMPERATURE_HUMIDITY] = {
         .module_init            = ddl_temperature_humidity_init,
@@ -72,11 +92,14 @@ static DDLModule ddl_modules[eDLL_MODULE_COUNT] = {
         .module_end             = ddl_temperature_humidity_end,
         .module_join            = ddl_temperature_humidity_join,
         .module_delete          = ddl_temperature_humidity_delete,
+        .module_get_stats       = ddl_temperature_humidity_get_stats,
+        .module_invalidate      = ddl_temperature_humidity_invalidate,
         .ao_id                  = eAO_TEMPERATURE_HUMIDITY,
         .subscribe_events_count = sizeof(temperature_humidity_subscribe_events) / 
                                     sizeof(temperature_humidity_subscribe_events[0]),
         .subscribe_events       = temperature_humidity_subscribe_events,
-        .module_name            = "temperature-humidity"
+        .module_name            = "temperature-humidity",
+        .stall_deadline_ms      = eTEMPERATURE_HUMIDITY_STALL_DEADLINE_MS
     },
     [eDDL_MODULE_GPS] = {
         .module_init            = ddl_gps_init,
@@ -84,36 +107,317 @@ static DDLModule ddl_modules[eDLL_MODULE_COUNT] = {
         .module_end             = ddl_gps_end,
         .module_join            = ddl_gps_join,
         .module_delete          = ddl_gps_delete,
+        .module_get_stats       = ddl_gps_get_stats,
+        .module_invalidate      = ddl_gps_invalidate,
         .ao_id                  = eAO_GPS,
         .subscribe_events_count = sizeof(gps_subscribe_events) / 
                                     sizeof(gps_subscribe_events[0]),
         .subscribe_events       = gps_subscribe_events,
-        .module_name            = "gps"
+        .module_name            = "gps",
+        .stall_deadline_ms      = eGPS_STALL_DEADLINE_MS
     }
 };
 
+static DDLFrame* ddl_frame;
+
+#ifndef OSAL_EVENT_LOOP
+/* Stalls handed from the supervisor to the restart thread, a bit per module.
+ * The restart thread is the only one to attach and detach a module once the
+ * layer runs, detaches are the stalled modules it has yet to detach.
+ * stalled_ns is when the module's stall started. restarted and stuck are only
+ * touched by the restart thread: a module restarted before it recovered, and
+ * one whose handler never returned, left detached */
+static uint32_t   stalls;
+static uint32_t   detaches;
+static uint32_t   recoveries;
+static uint64_t   stalled_ns[eDLL_MODULE_COUNT];
+static bool       restarted[eDLL_MODULE_COUNT];
+static bool       stuck[eDLL_MODULE_COUNT];
+static OsalThread restart_thread;
+static OsalEvent  restart_event;
+static bool       restart_ready;        // restart_event initialized
+static bool       restart_running;
+static bool       restart_stopping;
+#endif
+
+/* Carves the module's allocations from its own arena, which is emptied first
+ * so that a restart reuses the memory of the previous run */
+static eStatus ddl_init_module(uint32_t module_index)
+{
+    DDLModule* module = &ddl_modules[module_index];
+
+    osal_arena_reset(&module->arena);
+    osal_arena_unseal(&module->arena);
+    osal_arena_bind(&module->arena);
+    eStatus status = module->module_init(ddl_frame);
+    osal_arena_bind(NULL);
+    osal_arena_seal(&module->arena);
+
+    return status;
+}
+
+/* Told by the supervisor when a module stalls and when it takes events again.
+ * Runs on the supervisor thread, the detach and the restarts are left to the
+ * restart thread so that they never overlap */
+static void ddl_supervise(uint32_t module_index, bool stalled)
+{
+    DDLModule* module = &ddl_modules[module_index];
+
+    if(stalled)
+    {
+        LOG_ERROR("%s module stalled, invalidating its frame", module->module_name);
+        if(module->module_invalidate != NULL)
+        {
+            module->module_invalidate();
+        }
+#ifdef OSAL_EVENT_LOOP
+        (void)ddl_detach(module_index);
+#else
+        /* A recovery from an earlier stall doesn't end this one */
+        (void)__atomic_fetch_and(&recoveries, ~(1u << module_index), __ATOMIC_ACQ_REL);
+        __atomic_store_n(&stalled_ns[module_index], osal_time_now_ns(), __ATOMIC_RELEASE);
+        (void)__atomic_fetch_or(&detaches, 1u << module_index, __ATOMIC_ACQ_REL);
+        (void)__atomic_fetch_or(&stalls, 1u << module_index, __ATOMIC_ACQ_REL);
+        osal_event_set(&restart_event);
+#endif
+        return;
+    }
+
+    LOG_WARNING("%s module responds again", module->module_name);
+#ifdef OSAL_EVENT_LOOP
+    (void)ddl_attach(module_index);
+#else
+    (void)__atomic_fetch_or(&recoveries, 1u << module_index, __ATOMIC_ACQ_REL);
+    osal_event_set(&restart_event);
+#endif
+}
+
+#ifndef OSAL_EVENT_LOOP
+/* Restarts a stalled module once it responds again, or once its grace period
+ * is over if it doesn't */
+static void ddl_restart_stalled(uint32_t module_index, uint64_t now)
+{
+    static const uint64_t grace_ns = (uint64_t)eDDL_STALL_GRACE_MS * 1000000u;
+    DDLModule* module = &ddl_modules[module_index];
+    uint32_t bit = 1u << module_index;
+
+    if((__atomic_fetch_and(&recoveries, ~bit, __ATOMIC_ACQ_REL) & bit) != 0)
+    {
+        (void)__atomic_fetch_and(&stalls, ~bit, __ATOMIC_ACQ_REL);
+        stuck[module_index] = false;
+        if(restarted[module_index])
+        {
+            /* The restart at the end of its grace period is what brought it back */
+            restarted[module_index] = false;
+            return;
+        }
+        LOG_WARNING("Restarting %s module after its stall", module->module_name);
+    }
+    else if(stuck[module_index] ||
+            now - __atomic_load_n(&stalled_ns[module_index], __ATOMIC_ACQUIRE) < grace_ns)
+    {
+        return;
+    }
+    else
+    {
+        /* A handler stuck for the whole grace period can't be joined. The
+         * module stays invalid and detached, and is restarted if it returns */
+        ActiveObjectStats stats;
+        if(module->module_get_stats(&stats) == eSTATUS_SUCCESSFUL && stats.busy_ns >= grace_ns)
+        {
+            LOG_ERROR("%s module handler stuck for %llu ms, leaving it detached", module->module_name,
+                      (unsigned long long)(stats.busy_ns / 1000000u));
+            stuck[module_index] = true;
+            return;
+        }
+
+        /* Another grace period before the next restart, unless it recovers first */
+        LOG_ERROR("%s module still stalled after %u ms, restarting it", module->module_name,
+                  (unsigned)eDDL_STALL_GRACE_MS);
+        __atomic_store_n(&stalled_ns[module_index], now, __ATOMIC_RELEASE);
+        restarted[module_index] = true;
+    }
+
+    eStatus status = ddl_restart(module_index);
+    if(status)
+    {
+        LOG_ERROR("Failed to restart %s module with status %d", module->module_name, status);
+    }
+}
+
+static void* ddl_restart_entry(void* arg)
+{
+    (void)arg;
+
+    while(!__atomic_load_n(&restart_stopping, __ATOMIC_ACQUIRE))
+    {
+        /* Asleep until a stall, then polled until every stall is over */
+        uint32_t pending = __atomic_load_n(&stalls, __ATOMIC_ACQUIRE);
+        if(pending == 0)
+        {
+            osal_event_wait(&restart_event);
+            continue;
+        }
+
+        /* Off the bus before anything else, a restart attaches it again */
+        uint32_t detach = __atomic_exchange_n(&detaches, 0, __ATOMIC_ACQ_REL);
+        uint64_t now = osal_time_now_ns();
+        for(uint32_t module_index = 0; module_index < eDLL_MODULE_COUNT; module_index++)
+        {
+            if((detach & (1u << module_index)) != 0)
+            {
+                (void)ddl_detach(module_index);
+            }
+            if((pending & (1u << module_index)) != 0)
+            {
+                ddl_restart_stalled(module_index, now);
+            }
+        }
+        (void)osal_event_timedwait(&restart_event, eDDL_RESTART_POLL_MS);
+    }
+
+    return NULL;
+}
+
+static eStatus ddl_restart_start(void)
+{
+    static const OsalThreadAttr attr = {
+        .affinity_mask  = eDDL_RESTART_THREAD_AFFINITY_MASK,
+        .name           = DDL_RESTART_THREAD_NAME,
+        .stack_size     = eDDL_RESTART_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eDDL_RESTART_THREAD_POLICY,
+        .priority       = eDDL_RESTART_THREAD_PRIORITY
+    };
+
+    if(osal_event_init(&restart_event))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+    restart_ready = true;
+
+    restart_stopping = false;
+    if(osal_thread_create_ex(&restart_thread, ddl_restart_entry, NULL, &attr))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+    __atomic_store_n(&restart_running, true, __ATOMIC_RELEASE);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+/* No module is restarted once the layer is being ended. The event stays for
+ * the supervisor, which may still report stalls */
+static void ddl_restart_stop(void)
+{
+    if(__atomic_exchange_n(&restart_running, false, __ATOMIC_ACQ_REL))
+    {
+        __atomic_store_n(&restart_stopping, true, __ATOMIC_RELEASE);
+        osal_event_set(&restart_event);
+        osal_thread_join(&restart_thread);
+    }
+}
+#endif
+
 eStatus ddl_init(DDLFrame* frame)
 {
+    ddl_frame = frame;
     for(uint32_t module_index = 0; module_index < eDLL_MODULE_COUNT; module_index++)
     {
         DDLModule* module = &ddl_modules[module_index];
+        eStatus status = osal_arena_create(&module->arena, eDDL_MODULE_ARENA_SIZE, module->module_name);
+        if(status)
+        {
+            return status;
+        }
+
         LOG_DEBUG("Initializing %s module", module->module_name);
-        eStatus status = module->module_init(frame);
+        status = ddl_init_module(module_index);
+
+        OsalArenaStats stats;
+        osal_arena_stats(&module->arena, &stats);
+        LOG_INFO("%s arena: peak %zu of %zu bytes in %u allocations",
+                 stats.name, stats.peak, stats.size, stats.allocations);
         if(status)
         {
             return status;
         }
-        for(uint32_t i = 0; i < module->subscribe_events_count; i++)
+
+        status = ddl_attach(module_index);
+        if(status)
         {
-            status = util_event_bus_subscribe(module->ao_id, ddl_post, module_index,
-                                                &module->subscribe_events[i]);
-            if(status)
-            {
-                return status;
-            }
+            return status;
+        }
+
+        status = util_supervisor_watch(module_index, module->stall_deadline_ms, ddl_get_stats, ddl_supervise);
+        if(status)
+        {
+            return status;
+        }
+    }
+
+#ifdef OSAL_EVENT_LOOP
+    return eSTATUS_SUCCESSFUL;
+#else
+    return ddl_restart_start();
+#endif
+}
+
+/* Drops the module's first count subscriptions */
+static void ddl_unsubscribe(uint32_t module_index, uint32_t count)
+{
+    DDLModule* module = &ddl_modules[module_index];
+    for(uint32_t i = 0; i < count; i++)
+    {
+        (void)util_event_bus_unsubscribe(module->ao_id, ddl_post, module_index,
+                                         &module->subscribe_events[i]);
+    }
+}
+
+eStatus ddl_attach(uint32_t module)
+{
+    if(module >= eDLL_MODULE_COUNT)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    DDLModule* ddl_module = &ddl_modules[module];
+    if(__atomic_exchange_n(&ddl_module->attached, true, __ATOMIC_ACQ_REL))
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    for(uint32_t i = 0; i < ddl_module->subscribe_events_count; i++)
+    {
+        eStatus status = util_event_bus_subscribe(ddl_module->ao_id, ddl_post, module,
+                                                  &ddl_module->subscribe_events[i]);
+        if(status)
+        {
+            ddl_unsubscribe(module, i);
+            __atomic_store_n(&ddl_module->attached, false, __ATOMIC_RELEASE);
+            return status;
         }
     }
 
+    LOG_DEBUG("%s module attached to the event bus", ddl_module->module_name);
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus ddl_detach(uint32_t module)
+{
+    if(module >= eDLL_MODULE_COUNT)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    DDLModule* ddl_module = &ddl_modules[module];
+    if(!__atomic_exchange_n(&ddl_module->attached, false, __ATOMIC_ACQ_REL))
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    ddl_unsubscribe(module, ddl_module->subscribe_events_count);
+
+    LOG_DEBUG("%s module detached from the event bus", ddl_module->module_name);
     return eSTATUS_SUCCESSFUL;
 }
 
@@ -128,8 +432,57 @@ eStatus ddl_post(uint32_t module, Event* event)
     return ddl_modules[module].module_post(event);
 }
 
+eStatus ddl_get_stats(uint32_t module, ActiveObjectStats* stats)
+{
+    if(module >= eDLL_MODULE_COUNT)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    return ddl_modules[module].module_get_stats(stats);
+}
+
+eStatus ddl_restart(uint32_t module)
+{
+    if(module >= eDLL_MODULE_COUNT)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+#ifdef OSAL_EVENT_LOOP
+    /* Joining runs the event loop, which belongs to the thread already running it */
+    return eSTATUS_ACTION_FAILED;
+#else
+    DDLModule* ddl_module = &ddl_modules[module];
+
+    (void)ddl_detach(module);
+    eStatus status = ddl_module->module_end();
+    if(status)
+    {
+        /* Still running, so it keeps its events */
+        LOG_ERROR("Failed to end %s module with status %d, attaching it again", ddl_module->module_name, status);
+        (void)ddl_attach(module);
+        return status;
+    }
+    ddl_module->module_join();
+    ddl_module->module_delete();
+
+    LOG_INFO("Restarting %s module", ddl_module->module_name);
+    status = ddl_init_module(module);
+    if(status)
+    {
+        return status;
+    }
+
+    return ddl_attach(module);
+#endif
+}
+
 eStatus ddl_end(void)
 {
+#ifndef OSAL_EVENT_LOOP
+    ddl_restart_stop();
+#endif
     for(int module_index = 0; module_index < eDLL_MODULE_COUNT; module_index++)
     {
         LOG_DEBUG("End event sent to %s module", ddl_modules[module_index].module_name);
@@ -145,6 +498,9 @@ eStatus ddl_end(void)
 
 void ddl_join(void)
 {
+#ifndef OSAL_EVENT_LOOP
+    ddl_restart_stop();
+#endif
     for(int module_index = 0; module_index < eDLL_MODULE_COUNT; module_index++)
     {
         LOG_DEBUG("Joining %s thread", ddl_modules[module_index].module_name);
@@ -154,9 +510,18 @@ void ddl_join(void)
 
 void ddl_delete(void)
 {
+#ifndef OSAL_EVENT_LOOP
+    ddl_restart_stop();
+    if(restart_ready)
+    {
+        osal_event_destroy(&restart_event);
+        restart_ready = false;
+    }
+#endif
     for(int module_index = 0; module_index < eDLL_MODULE_COUNT; module_index++)
     {
         LOG_DEBUG("Delete %s resources", ddl_modules[module_index].module_name);
         ddl_modules[module_index].module_delete();
+        osal_arena_destroy(&ddl_modules[module_index].arena);
     }
 }
\ No newline at end of file
@@ -14,15 +14,56 @@
  * @brief   Initialize the DDL modules.
  * @details Go over all the modules included in the DDL (as configured
  *          in ddl_config.h) and call the initialization functions of
- *          each.
+ *          each. A module's allocations are carved from an arena of its
+ *          own, which is sealed afterwards. Every module is watched by the
+ *          supervisor: a stalled module's frame is marked invalid and it
+ *          stops getting events. A thread of the DDL restarts it once it
+ *          responds, or once it has been stalled for eDDL_STALL_GRACE_MS.
+ *          A module whose handler was stuck all along is left invalid and
+ *          detached until the handler returns.
+ *          With OSAL_EVENT_LOOP a module that responds again is attached
+ *          again instead.
  * @param   frame A pointer to a DDLFrame.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      frame is NULL or a module is misconfigured
- * @retval  eSTATUS_SYSTEM_ERROR    thread or queue initalization failed
+ * @retval  eSTATUS_SYSTEM_ERROR    arena, event, thread or queue initalization failed
+ * @retval  eSTATUS_ACTION_FAILED   the supervisor can't watch another AO
  */
 eStatus ddl_init(DDLFrame* frame);
 
+/**
+ * @brief   Subscribe a DDL module to its events on the event bus.
+ * @details Done for every module by ddl_init(). A detached module can be
+ *          attached again at runtime. Once ddl_init() returned the DDL
+ *          attaches and detaches the modules from a single thread, its
+ *          restart thread or the loop thread with OSAL_EVENT_LOOP, and a
+ *          call from any other races with it. Not to be called from a bus
+ *          post function.
+ * @param   module A value from @ref eDDLModules.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   module is out of bounds
+ * @retval  eSTATUS_ACTION_FAILED   module is already attached or the bus
+ *                                  subscription table is full
+ */
+eStatus ddl_attach(uint32_t module);
+
+/**
+ * @brief   Unsubscribe a DDL module from its events on the event bus.
+ * @details An idle module costs no dispatch work while detached, its Active
+ *          Object keeps running and waits on its empty queue. Events already
+ *          queued are still handled. Like @ref ddl_attach, left to the DDL
+ *          once ddl_init() returned. Not to be called from a bus post
+ *          function.
+ * @param   module A value from @ref eDDLModules.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   module is out of bounds
+ * @retval  eSTATUS_ACTION_FAILED   module is not attached
+ */
+eStatus ddl_detach(uint32_t module);
+
 /**
  * @brief   Post an event to specified DDL module.
  * @param   module A value from @ref eDDLModules.
@@ -35,8 +76,39 @@ eStatus ddl_init(DDLFrame* frame);
  */
 eStatus ddl_post(uint32_t module, Event* event);
 
+/**
+ * @brief   Read the queue and dispatch statistics of a DDL module's AO.
+ * @param   module A value from @ref eDDLModules.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   module is out of bounds
+ * @retval  eSTATUS_NULL_PARAM      stats is NULL
+ */
+eStatus ddl_get_stats(uint32_t module, ActiveObjectStats* stats);
+
+/**
+ * @brief   Tear a DDL module down and initialize it again.
+ * @details Detaches the module, ends, joins and deletes it, then runs its
+ *          init on the emptied module arena and attaches it. A module that
+ *          can't be ended is attached again. Blocks until the module's
+ *          handler returns, so not to be called on a module whose handler
+ *          is stuck, nor from a DDL AO. Stalled modules are restarted by
+ *          the DDL's restart thread, which is the only caller while the
+ *          layer runs.
+ * @param   module A value from @ref eDDLModules.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   module is out of bounds
+ * @retval  eSTATUS_ACTION_FAILED   built with OSAL_EVENT_LOOP, or a queue, thread
+ *                                  or bus action failed
+ * @retval  eSTATUS_SYSTEM_ERROR    the module's initialization failed
+ */
+eStatus ddl_restart(uint32_t module);
+
 /**
  * @brief   Go to the END states of the DDL modules.
+ * @details Stalled modules are no longer restarted from then on.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      a module is misconfigured
@@ -46,11 +118,13 @@ eStatus ddl_end(void);
 
 /**
  * @brief   Wait for all the DDL modules to stop.
+ * @details Stops the restarts first, so that no module is initialized again
+ *          while it is joined.
  */
 void ddl_join(void);
 
 /**
- * @brief   Free the resources of the DDL modules.
+ * @brief   Free the resources of the DDL modules and their arenas.
  */
 void ddl_delete(void);
 
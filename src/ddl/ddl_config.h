@@ -1,6 +1,11 @@
 #ifndef DDL_CONFIG_H
 #define DDL_CONFIG_H
 
+/* User library includes */
+#include "osal/osal.h"
+
+#define DDL_RESTART_THREAD_NAME "ddl-restart"
+
 typedef enum eDDLModules
 {
     eDDL_MODULE_DISTANCE,
@@ -10,4 +15,16 @@ typedef enum eDDLModules
     eDLL_MODULE_COUNT
 } eDDLModules;
 
+/* Restarts join the module's AO, so off the supervisor's real-time thread */
+typedef enum eDDLConfig
+{
+    eDDL_MODULE_ARENA_SIZE = 1024,      // per module, so that one can be rebuilt alone
+    eDDL_STALL_GRACE_MS = 2000,         // a module still stalled after this long is restarted anyway
+    eDDL_RESTART_POLL_MS = 100,         // looks at the stalled modules while any is waiting out its grace period
+    eDDL_RESTART_THREAD_POLICY = eTHREAD_POLICY_INHERIT,
+    eDDL_RESTART_THREAD_PRIORITY = 0,
+    eDDL_RESTART_THREAD_AFFINITY_MASK = 0,
+    eDDL_RESTART_THREAD_STACK_SIZE = 0
+} eDDLConfig;
+
 #endif
\ No newline at end of file
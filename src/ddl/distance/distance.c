@@ -7,10 +7,26 @@
 #include "util/active_object/active_object.h"
 #include "ddl/distance/distance_config.h"
 #include "ddl/distance/distance_fsm.h"
+#include "hal/uart/hal_uart.h"
 #include "osal/osal.h"
 
 static DistanceObject distance_aobj;
 
+static const bool distance_event_coalesced[] = { DISTANCE_EVENT_COALESCED };
+
+static const ActiveObjectAttr distance_aobj_attr = {
+    .thread = {
+        .affinity_mask  = eDISTANCE_THREAD_AFFINITY_MASK,
+        .name           = DISTANCE_THREAD_NAME,
+        .stack_size     = eDISTANCE_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eDISTANCE_THREAD_POLICY,
+        .priority       = eDISTANCE_THREAD_PRIORITY
+    },
+    .event_coalesced        = distance_event_coalesced,
+    .event_coalesced_count  = sizeof(distance_event_coalesced) / sizeof(distance_event_coalesced[0]),
+    .executor               = eDISTANCE_ON_EXECUTOR
+};
+
 eStatus ddl_distance_init(DDLFrame* frame)
 {
     if(frame == NULL)
@@ -24,7 +40,8 @@ eStatus ddl_distance_init(DDLFrame* frame)
     return util_active_object_init(
         &distance_aobj.aobj, 
         eDISTANCE_QUEUE_CAPACITY, 
-        distance_init_state
+        distance_init_state,
+        &distance_aobj_attr
     );
 }
 
@@ -45,6 +62,17 @@ void ddl_distance_join(void)
 
 void ddl_distance_delete(void)
 {
+    /* A read still in flight must not post into the deleted AO, or the next one */
+    (void)hal_uart_abort(eDISTANCE_UART_DEVICE);
     util_active_object_delete(&distance_aobj.aobj);
-    osal_timer_destroy(distance_aobj.timer);
+}
+
+eStatus ddl_distance_get_stats(ActiveObjectStats* stats)
+{
+    return util_active_object_get_stats(&distance_aobj.aobj, stats);
+}
+
+void ddl_distance_invalidate(void)
+{
+    __atomic_store_n(&distance_aobj.frame->valid, false, __ATOMIC_RELAXED);
 }
\ No newline at end of file
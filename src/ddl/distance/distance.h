@@ -45,4 +45,19 @@ void ddl_distance_join(void);
  */
 void ddl_distance_delete(void);
 
+/**
+ * @brief   Read the queue and dispatch statistics of the distance sensor's AO.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      stats is NULL
+ */
+eStatus ddl_distance_get_stats(ActiveObjectStats* stats);
+
+/**
+ * @brief   Mark the distance sensor's frame invalid until its next good read.
+ * @details Can be called from any thread after @ref ddl_distance_init.
+ */
+void ddl_distance_invalidate(void);
+
 #endif
\ No newline at end of file
@@ -2,14 +2,23 @@
 #define DDL_DISTANCE_CONFIG_H 
 
 /* User library includes */
+#include "osal/osal.h"
 #include "hal/uart/hal_uart_config.h"
 
+#define DISTANCE_THREAD_NAME "distance"
+
 typedef enum eDistanceConfig
 {
     eDISTANCE_QUEUE_CAPACITY = 4,
     eDISTANCE_READ_RETRY_MAX = 3,
     eDISTANCE_READ_TIMEOUT_MS = 100,
-    eDISTANCE_UART_DEVICE = eUART0_DEVICE
+    eDISTANCE_STALL_DEADLINE_MS = 1000,    // supervisor restarts the AO past this, every retry fits
+    eDISTANCE_UART_DEVICE = eUART0_DEVICE,
+    eDISTANCE_ON_EXECUTOR = 1,         // shares the executor's workers, the thread settings are unused
+    eDISTANCE_THREAD_POLICY = eTHREAD_POLICY_INHERIT,
+    eDISTANCE_THREAD_PRIORITY = 0,
+    eDISTANCE_THREAD_AFFINITY_MASK = 0,
+    eDISTANCE_THREAD_STACK_SIZE = 0
 } eDistanceConfig;
 
 #endif
\ No newline at end of file
@@ -11,4 +11,8 @@ typedef enum
     eDISTANCE_EVENT_FRAME_RECEIVED
 } eDistanceEvent;
 
+/* Idempotent events: another one while the first is still queued only asks for a new reading again */
+#define DISTANCE_EVENT_COALESCED                                    \
+    [eDISTANCE_EVENT_READ] = true
+
 #endif
\ No newline at end of file
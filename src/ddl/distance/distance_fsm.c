@@ -7,6 +7,7 @@
 /* User library includes */
 #include "ddl/distance/distance_config.h"
 #include "ddl/distance/distance_types.h"
+#include "util/fsm/fsm_table.h"
 #include "hal/uart/hal_uart.h"
 #include "util/log/log.h"
 #include "osal/osal.h"
@@ -44,7 +45,8 @@ typedef struct __attribute__((packed))
     uint8_t  checksum;
 } TOFSenseReadCmd;
 
-static TimerArg timer_arg;
+/* Armed on the AO itself when a read is sent */
+static Event timeout_event = { .type = eDISTANCE_EVENT_TIMEOUT };
 
 static TOFSenseFrame resp_frame;
 
@@ -143,35 +145,90 @@ static void update_distance_frame(DistanceObject* aobj, const TOFSenseFrame *fra
     aobj->system_time = to_little_endian32(frame->system_time);
 }
 
-static void retry_handler(DistanceObject* aobj, FSM* fsm)
+static void uart_rx_complete_handler(void* arg)
+{
+    static Event frame_received_event = { .type = eDISTANCE_EVENT_FRAME_RECEIVED };
+    DistanceObject* aobj = (DistanceObject*)arg;
+    (void)util_active_object_post(&aobj->aobj, &frame_received_event);
+}
+
+/* The reading failed, counts the retry */
+static void read_failed(DistanceObject* aobj)
 {
     aobj->retry++;
-    if(aobj->retry < eDISTANCE_READ_RETRY_MAX)
-    {
-        (void)util_fsm_transition(fsm, distance_read_state);
-    }
-    else
+    if(aobj->retry >= eDISTANCE_READ_RETRY_MAX)
     {
         LOG_DEBUG("Retries exceeded limit (%u)", aobj->retry);
         aobj->frame->valid = false;
-        (void)util_fsm_transition(fsm, distance_idle_state);
     }
 }
 
-static void timeout_handler(void* arg)
+static bool frame_is_valid(FSM* fsm, const Event* event)
 {
-    static Event timeout_event = { .type = eDISTANCE_EVENT_TIMEOUT };
-    DistanceObject* aobj = (DistanceObject*)arg;
-    (void)util_active_object_post(&aobj->aobj, &timeout_event);
+    (void)event;
+    DistanceObject* aobj = (DistanceObject*)fsm->arg;
+    return is_frame_valid(&resp_frame, aobj->system_time);
 }
 
-static void uart_rx_complete_handler(void* arg)
+/* Another read is allowed after the one that just failed */
+static bool retry_allowed(FSM* fsm, const Event* event)
 {
-    static Event frame_received_event = { .type = eDISTANCE_EVENT_FRAME_RECEIVED };
-    DistanceObject* aobj = (DistanceObject*)arg;
-    (void)util_active_object_post(&aobj->aobj, &frame_received_event);
+    (void)event;
+    DistanceObject* aobj = (DistanceObject*)fsm->arg;
+    return aobj->retry + 1 < eDISTANCE_READ_RETRY_MAX;
 }
 
+static void frame_accept(FSM* fsm, Event* event)
+{
+    (void)event;
+    DistanceObject* aobj = (DistanceObject*)fsm->arg;
+    update_distance_frame(aobj, &resp_frame);
+    LOG_DEBUG("Frame is valid. Distance measured: %fm", (double)aobj->frame->distance);
+}
+
+static void frame_reject(FSM* fsm, Event* event)
+{
+    (void)event;
+    LOG_WARNING("Frame is invalid");
+    read_failed((DistanceObject*)fsm->arg);
+}
+
+static void read_abort(FSM* fsm, Event* event)
+{
+    (void)event;
+    LOG_DEBUG("Read timed out");
+    (void)hal_uart_abort(eDISTANCE_UART_DEVICE);
+    read_failed((DistanceObject*)fsm->arg);
+}
+
+/*
+    IDLE waits for a read request, READ sends it and waits for the answer or
+    the timeout. A valid frame goes back to IDLE, a failed read is tried
+    again, re-entering READ, up to eDISTANCE_READ_RETRY_MAX times.
+*/
+#define DISTANCE_STATES(X, T)                                   \
+    X(T, eDISTANCE_STATE_IDLE, distance_idle_state)             \
+    X(T, eDISTANCE_STATE_READ, distance_read_state)
+
+#define DISTANCE_TRANSITIONS(X, S)                                                                                  \
+    X(S, eDISTANCE_STATE_IDLE, eDISTANCE_EVENT_READ,           NULL,           NULL,         eDISTANCE_STATE_READ)  \
+    X(S, eDISTANCE_STATE_READ, eDISTANCE_EVENT_FRAME_RECEIVED, frame_is_valid, frame_accept, eDISTANCE_STATE_IDLE)  \
+    X(S, eDISTANCE_STATE_READ, eDISTANCE_EVENT_FRAME_RECEIVED, retry_allowed,  frame_reject, eDISTANCE_STATE_READ)  \
+    X(S, eDISTANCE_STATE_READ, eDISTANCE_EVENT_FRAME_RECEIVED, NULL,           frame_reject, eDISTANCE_STATE_IDLE)  \
+    X(S, eDISTANCE_STATE_READ, eDISTANCE_EVENT_TIMEOUT,        retry_allowed,  read_abort,   eDISTANCE_STATE_READ)  \
+    X(S, eDISTANCE_STATE_READ, eDISTANCE_EVENT_TIMEOUT,        NULL,           read_abort,   eDISTANCE_STATE_IDLE)
+
+typedef enum eDistanceState
+{
+    DISTANCE_STATES(FSM_TABLE_STATE_ID, ~)
+    eDISTANCE_STATE_COUNT
+} eDistanceState;
+
+static const FSMTableRow distance_rows[] = { DISTANCE_TRANSITIONS(FSM_TABLE_ROW, ~) };
+static const FSMTableState distance_states[] = { DISTANCE_STATES(FSM_TABLE_STATE, DISTANCE_TRANSITIONS) };
+DISTANCE_STATES(FSM_TABLE_CHECK_ENTERED, DISTANCE_TRANSITIONS)
+static const FSMTable distance_table = FSM_TABLE(distance_states, distance_rows);
+
 void distance_init_state(FSM* fsm, Event* event)
 {
     DistanceObject* aobj = (DistanceObject*)fsm->arg;
@@ -180,16 +237,7 @@ void distance_init_state(FSM* fsm, Event* event)
     case eFSM_EVENT_INIT:
         LOG_DEBUG("INIT entry");
         aobj->frame->valid = false;
-        timer_arg.handler = timeout_handler;
-        timer_arg.arg = aobj;
-        if(osal_timer_init(&aobj->timer, &timer_arg))
-        {
-            (void)util_fsm_transition(fsm, distance_error_state);
-        }
-        else
-        {
-            (void)util_fsm_transition(fsm, distance_idle_state);
-        }
+        (void)util_fsm_table_start(fsm, &distance_table);
         break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("INIT exit");
@@ -199,21 +247,6 @@ void distance_init_state(FSM* fsm, Event* event)
     }
 }
 
-void distance_error_state(FSM* fsm, Event* event)
-{
-    DistanceObject* aobj = (DistanceObject*)fsm->arg;
-
-    switch(event->type)
-    {
-    case eFSM_EVENT_ENTRY:
-        LOG_ERROR("ERROR entry");
-        aobj->frame->valid = false;
-        break;
-    default:
-        LOG_WARNING("Unknown event type %u", event->type);
-    }
-}
-
 void distance_idle_state(FSM* fsm, Event* event)
 {
     DistanceObject* aobj = (DistanceObject*)fsm->arg;
@@ -224,15 +257,11 @@ void distance_idle_state(FSM* fsm, Event* event)
         LOG_DEBUG("IDLE entry");
         aobj->retry = 0;
         break;
-    case eDISTANCE_EVENT_READ:
-        LOG_DEBUG("Read event received");
-        (void)util_fsm_transition(fsm, distance_read_state);
-        break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("IDLE exit");
         break;
     default:
-        LOG_WARNING("Unknown event type %u", event->type);
+        break;
     }
 }
 
@@ -246,50 +275,13 @@ void distance_read_state(FSM* fsm, Event* event)
         LOG_DEBUG("READ entry");
         (void)hal_uart_write(eDISTANCE_UART_DEVICE, &read_cmd, sizeof(read_cmd), NULL, NULL);
         (void)hal_uart_read(eDISTANCE_UART_DEVICE, &resp_frame, sizeof(resp_frame), uart_rx_complete_handler, aobj);
-        (void)osal_timer_arm(aobj->timer, eDISTANCE_READ_TIMEOUT_MS, eTIMER_TYPE_ONCE);
-        break;
-    case eDISTANCE_EVENT_FRAME_RECEIVED:
-        LOG_DEBUG("Frame Received!");
-        (void)util_fsm_transition(fsm, distance_update_state);
-        break;
-    case eDISTANCE_EVENT_TIMEOUT:
-        LOG_DEBUG("Read timed out");
-        (void)hal_uart_abort(eDISTANCE_UART_DEVICE);
-        retry_handler(aobj, fsm);
+        (void)util_active_object_arm(&aobj->aobj, &timeout_event, eDISTANCE_READ_TIMEOUT_MS, false);
         break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("READ exit");
-        (void)osal_timer_disarm(aobj->timer);
+        (void)util_active_object_disarm(&aobj->aobj, &timeout_event);
         break;
     default:
-        LOG_WARNING("Unknown event type %u", event->type);
-    }
-}
-
-void distance_update_state(FSM* fsm, Event* event)
-{
-    DistanceObject* aobj = (DistanceObject*)fsm->arg;
-
-    switch(event->type)
-    {
-    case eFSM_EVENT_ENTRY:
-        LOG_DEBUG("UPDATE entry");
-        if(is_frame_valid(&resp_frame, aobj->system_time))
-        {
-            update_distance_frame(aobj, &resp_frame);
-            LOG_DEBUG("Frame is valid. Distance measured: %fm", (double)aobj->frame->distance);
-            (void)util_fsm_transition(fsm, distance_idle_state);
-        }
-        else
-        {
-            LOG_WARNING("Frame is invalid");
-            retry_handler(aobj, fsm);
-        }
-        break;
-    case eFSM_EVENT_EXIT:
-        LOG_DEBUG("UPDATE exit");
         break;
-    default:
-        LOG_WARNING("Unknown event type %u", event->type);
     }
-}
\ No newline at end of file
+}
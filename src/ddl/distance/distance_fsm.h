@@ -6,26 +6,18 @@
 
 /**
  * @brief   The initial state of the distance sensor.
- * @details From this state we can go to distance_error and
- *          distance_idle states.
+ * @details Hands the FSM over to the distance table, whose
+ *          first state is distance_idle.
  * @param   fsm A pointer to an initialized FSM.
  * @param   event A pointer to an Event.
  */
 void distance_init_state(FSM* fsm, Event* event);
 
-/**
- * @brief   The error state of the distance sensor.
- * @details This is a dead state - there is no option to go to
- *          another state from this state.
- * @param   fsm A pointer to an initialized FSM.
- * @param   event A pointer to an Event.
- */
-void distance_error_state(FSM* fsm, Event* event);
-
 /**
  * @brief   The idle state of the distance sensor.
- * @details This state waits to receive a read request. From this
- *          state we can go to distance_read state.
+ * @details Entry and exit handler of the idle table state, which
+ *          waits to receive a read request. Its rows lead to
+ *          distance_read state.
  * @param   fsm A pointer to an initialized FSM.
  * @param   event A pointer to an Event.
  */
@@ -33,23 +25,14 @@ void distance_idle_state(FSM* fsm, Event* event);
 
 /**
  * @brief   The read state of the distance sensor.
- * @details This state tries to read the data from the sensor.
- *          It uses a timer to measure read timeouts. From 
- *          this state we can go to distance_update state.
+ * @details Entry and exit handler of the read table state, which
+ *          requests a frame from the sensor and arms a time event to
+ *          catch read timeouts. Its rows check the frame and lead
+ *          back to distance_idle, or to distance_read again for a
+ *          retry.
  * @param   fsm A pointer to an initialized FSM.
  * @param   event A pointer to an Event.
  */
 void distance_read_state(FSM* fsm, Event* event);
 
-/**
- * @brief   The update state of the distance sensor.
- * @details This state checks the validity of the data received
- *          from the distance sensor and updates the data frame 
- *          with the processed distance. From this state we can
- *          go to distance_idle and distance_read states.
- * @param   fsm A pointer to an initialized FSM.
- * @param   event A pointer to an Event.
- */
-void distance_update_state(FSM* fsm, Event* event);
-
 #endif
\ No newline at end of file
@@ -23,7 +23,6 @@ typedef struct
 {
     ActiveObject   aobj;
     DistanceFrame* frame;
-    void*          timer;
     uint32_t       retry;
     uint32_t       system_time;
 } DistanceObject;
@@ -4,10 +4,26 @@
 #include "util/active_object/active_object.h"
 #include "ddl/gps/gps_config.h"
 #include "ddl/gps/gps_fsm.h"
+#include "hal/uart/hal_uart.h"
 #include "osal/osal.h"
 
 static GPSObject gps_aobj;
 
+static const bool gps_event_coalesced[] = { GPS_EVENT_COALESCED };
+
+static const ActiveObjectAttr gps_aobj_attr = {
+    .thread = {
+        .affinity_mask  = eGPS_THREAD_AFFINITY_MASK,
+        .name           = GPS_THREAD_NAME,
+        .stack_size     = eGPS_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eGPS_THREAD_POLICY,
+        .priority       = eGPS_THREAD_PRIORITY
+    },
+    .event_coalesced        = gps_event_coalesced,
+    .event_coalesced_count  = sizeof(gps_event_coalesced) / sizeof(gps_event_coalesced[0]),
+    .executor               = eGPS_ON_EXECUTOR
+};
+
 eStatus ddl_gps_init(DDLFrame* frame)
 {
     if(frame == NULL)
@@ -21,7 +37,8 @@ eStatus ddl_gps_init(DDLFrame* frame)
     return util_active_object_init(
         &gps_aobj.aobj,
         eGPS_QUEUE_CAPACITY,
-        gps_init_state
+        gps_init_state,
+        &gps_aobj_attr
     );
 }
 
@@ -42,6 +59,17 @@ void ddl_gps_join(void)
 
 void ddl_gps_delete(void)
 {
+    /* A read still in flight must not post into the deleted AO, or the next one */
+    (void)hal_uart_abort(eGPS_UART_DEVICE);
     util_active_object_delete(&gps_aobj.aobj);
-    osal_timer_destroy(gps_aobj.timer);
+}
+
+eStatus ddl_gps_get_stats(ActiveObjectStats* stats)
+{
+    return util_active_object_get_stats(&gps_aobj.aobj, stats);
+}
+
+void ddl_gps_invalidate(void)
+{
+    __atomic_store_n(&gps_aobj.frame->valid, false, __ATOMIC_RELAXED);
 }
\ No newline at end of file
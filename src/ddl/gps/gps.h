@@ -16,4 +16,8 @@ void ddl_gps_join(void);
 
 void ddl_gps_delete(void);
 
+eStatus ddl_gps_get_stats(ActiveObjectStats* stats);
+
+void ddl_gps_invalidate(void);
+
 #endif
\ No newline at end of file
@@ -2,14 +2,23 @@
 #define DDL_GPS_CONFIG_H
 
 /* User library includes */
+#include "osal/osal.h"
 #include "hal/uart/hal_uart_config.h"
  
+#define GPS_THREAD_NAME "gps"
+
 typedef enum eGpsConfig
 {
     eGPS_QUEUE_CAPACITY = 4,
     eGPS_READ_RETRY_MAX = 3,
     eGPS_READ_TIMEOUT_MS = 300,
-    eGPS_UART_DEVICE = eUART1_DEVICE
+    eGPS_STALL_DEADLINE_MS = 1500,         // above the three read timeouts in a row
+    eGPS_UART_DEVICE = eUART1_DEVICE,
+    eGPS_ON_EXECUTOR = 1,              // 0 for a thread of its own with the settings below
+    eGPS_THREAD_POLICY = eTHREAD_POLICY_INHERIT,
+    eGPS_THREAD_PRIORITY = 0,
+    eGPS_THREAD_AFFINITY_MASK = 0,
+    eGPS_THREAD_STACK_SIZE = 0
 } eGpsConfig;
 
 #endif
\ No newline at end of file
@@ -12,4 +12,8 @@ typedef enum
     eGPS_EVENT_CONFIGURED
 } eGPSEvent;
 
+/* Idempotent events: another one while the first is still queued only asks for a new reading again */
+#define GPS_EVENT_COALESCED                                         \
+    [eGPS_EVENT_READ] = true
+
 #endif
\ No newline at end of file
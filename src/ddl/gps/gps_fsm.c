@@ -116,7 +116,7 @@ typedef struct
     uint8_t payload[16];
 } ConfigStep;
 
-static TimerArg timer_arg;
+static Event timeout_event = { .type = eGPS_EVENT_TIMEOUT };
 
 static UbxNavPvtFrame   resp_frame;
 
@@ -311,13 +311,6 @@ static void retry_handler(GPSObject* aobj, FSM* fsm)
     }
 }
 
-static void timeout_handler(void* arg)
-{
-    static Event timeout_event = { .type = eGPS_EVENT_TIMEOUT };
-    GPSObject* aobj = (GPSObject*)arg;
-    (void)util_active_object_post(&aobj->aobj, &timeout_event);
-}
-
 static void uart_rx_complete_handler(void* arg)
 {
     static Event frame_received_event = { .type = eGPS_EVENT_FRAME_RECEIVED };
@@ -334,18 +327,8 @@ void gps_init_state(FSM* fsm, Event* event)
     case eFSM_EVENT_INIT:
         LOG_DEBUG("INIT entry");
         aobj->frame->valid = false;
-        timer_arg.handler = timeout_handler;
-        timer_arg.arg = aobj;
-        if(osal_timer_init(&aobj->timer, &timer_arg))
-        {
-            LOG_ERROR("Timer initialization failed");
-            (void)util_fsm_transition(fsm, gps_error_state);
-        }
-        else
-        {
-            config_step = 0;
-            config_send_current_step(aobj);
-        }
+        config_step = 0;
+        config_send_current_step(aobj);
         break;
     case eGPS_EVENT_CONFIGURED:
         LOG_DEBUG("Configuration step %u completed", config_step);
@@ -415,7 +398,7 @@ void gps_read_state(FSM* fsm, Event* event)
         LOG_DEBUG("READ entry");
         (void)hal_uart_write(eGPS_UART_DEVICE, &read_cmd, sizeof(read_cmd), NULL, NULL);
         (void)hal_uart_read(eGPS_UART_DEVICE, &resp_frame, sizeof(resp_frame), uart_rx_complete_handler, aobj);
-        (void)osal_timer_arm(aobj->timer, eGPS_READ_TIMEOUT_MS, eTIMER_TYPE_ONCE);
+        (void)util_active_object_arm(&aobj->aobj, &timeout_event, eGPS_READ_TIMEOUT_MS, false);
         break;
     case eGPS_EVENT_FRAME_RECEIVED:
         LOG_DEBUG("Frame received");
@@ -428,7 +411,7 @@ void gps_read_state(FSM* fsm, Event* event)
         break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("READ exit");
-        (void)osal_timer_disarm(aobj->timer);
+        (void)util_active_object_disarm(&aobj->aobj, &timeout_event);
         break;
     default:
         LOG_WARNING("Unknown event type %u", event->type);
@@ -25,7 +25,6 @@ typedef struct
 {
     ActiveObject    aobj;
     GPSFrame*       frame;
-    void*           timer;
     uint32_t        retry;
     uint32_t        system_time;
 } GPSObject;
@@ -5,12 +5,34 @@
 
 /* User library includes */
 #include "util/active_object/active_object.h"
+#include "util/event_pool/event_pool.h"
+#include "util/event_bus/event_bus.h"
 #include "ddl/servo/servo_config.h"
 #include "ddl/servo/servo_fsm.h"
 #include "osal/osal.h"
 
 static ServoObject servo_aobj;
 
+static const uint8_t servo_event_priorities[] = { SERVO_EVENT_PRIORITIES };
+
+static const bool servo_event_coalesced[] = { SERVO_EVENT_COALESCED };
+
+static const ActiveObjectAttr servo_aobj_attr = {
+    .thread = {
+        .affinity_mask  = eSERVO_THREAD_AFFINITY_MASK,
+        .name           = SERVO_THREAD_NAME,
+        .stack_size     = eSERVO_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eSERVO_THREAD_POLICY,
+        .priority       = eSERVO_THREAD_PRIORITY
+    },
+    .queue_type             = eQUEUE_TYPE_LOCKED,
+    .urgent_capacity        = eSERVO_URGENT_CAPACITY,
+    .event_priorities       = servo_event_priorities,
+    .event_priority_count   = sizeof(servo_event_priorities) / sizeof(servo_event_priorities[0]),
+    .event_coalesced        = servo_event_coalesced,
+    .event_coalesced_count  = sizeof(servo_event_coalesced) / sizeof(servo_event_coalesced[0])
+};
+
 eStatus ddl_servo_init(DDLFrame* frame)
 {
     if(frame == NULL)
@@ -23,7 +45,8 @@ eStatus ddl_servo_init(DDLFrame* frame)
     return util_active_object_init(
         &servo_aobj.aobj,
         eSERVO_QUEUE_CAPACITY,
-        servo_init_state
+        servo_init_state,
+        &servo_aobj_attr
     );
 }
 
@@ -45,11 +68,33 @@ void ddl_servo_join(void)
 void ddl_servo_delete(void)
 {
     util_active_object_delete(&servo_aobj.aobj);
-    osal_timer_destroy(servo_aobj.timer);
-    servo_fsm_destroy();
 }
 
-eStatus ddl_servo_set_target(float hor_angle, float ver_angle)
+eStatus ddl_servo_get_stats(ActiveObjectStats* stats)
+{
+    return util_active_object_get_stats(&servo_aobj.aobj, stats);
+}
+
+eStatus ddl_servo_publish_target(uint32_t event_type, float hor_angle, float ver_angle)
 {
-    return servo_fsm_set_target(hor_angle, ver_angle);
+    if(hor_angle < SERVO_HORIZONTAL_MIN_ANGLE_DEG || hor_angle > SERVO_HORIZONTAL_MAX_ANGLE_DEG)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+    if(ver_angle < SERVO_VERTICAL_MIN_ANGLE_DEG || ver_angle > SERVO_VERTICAL_MAX_ANGLE_DEG)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    Event* event = util_event_pool_alloc(event_type);
+    if(event == NULL)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    ServoAngles* angles = util_event_pool_payload(event);
+    angles->hor_angle = hor_angle;
+    angles->ver_angle = ver_angle;
+
+    return util_event_bus_publish_data(eAO_SERVO, event);
 }
\ No newline at end of file
@@ -46,16 +46,30 @@ void ddl_servo_join(void);
 void ddl_servo_delete(void);
 
 /**
- * @brief   Update the target angles registry that the servo FSM
- *          uses on lock and noise-scan events.
- * @details Setting the target is seperate from publishing the event.
+ * @brief   Read the queue and dispatch statistics of the servo motors' AO.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      stats is NULL
+ */
+eStatus ddl_servo_get_stats(ActiveObjectStats* stats);
+
+/**
+ * @brief   Publish a servo event that carries target angles.
+ * @details Takes an event from the event pool with the angles as its payload
+ *          and publishes it to the servo through the event bus. The servo FSM
+ *          moves to the target on lock, noise-scan and, while locked,
+ *          directions events.
+ * @param   event_type eSERVO_EVENT_LOCK, eSERVO_EVENT_NOISE_DETECTED or
+ *          eSERVO_EVENT_DIRECTIONS.
  * @param   hor_angle Target horizontal angle, in degrees.
  * @param   ver_angle Target vertical angle, in degrees.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_INVALID_VALUE   angle outside the legal range
- * @retval  eSTATUS_ACTION_FAILED   mutex not initialized
+ * @retval  eSTATUS_ACTION_FAILED   the event pool is exhausted or the servo
+ *                                  isn't subscribed to event_type
  */
-eStatus ddl_servo_set_target(float hor_angle, float ver_angle);
+eStatus ddl_servo_publish_target(uint32_t event_type, float hor_angle, float ver_angle);
 
 #endif
\ No newline at end of file
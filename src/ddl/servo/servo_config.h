@@ -2,6 +2,7 @@
 #define DDL_SERVO_CONFIG_H
 
 /* User library includes */
+#include "osal/osal.h"
 #include "hal/i2c/hal_i2c_config.h"
 
 /* Register addresses */
@@ -58,13 +59,22 @@
 #define SERVO_DECREASE_ANGLE    false
 #define SERVO_INCREASE_ANGLE    true
 
+#define SERVO_THREAD_NAME       "servo"
+
 typedef enum eServoConfig
 {
     eSERVO_QUEUE_CAPACITY       = 4,
+    eSERVO_URGENT_CAPACITY      = 2,
+    eSERVO_STALL_DEADLINE_MS    = 1000,    // a stuck I2C transfer, for the supervisor
     eSERVO_PCA_ADDRESS          = 0x40,
     eSERVO_HORIZONTAL_CHANNEL   = 0,
     eSERVO_VERTICAL_CHANNEL     = 1,
-    eSERVO_I2C_DEVICE           = eI2C0_DEVICE
+    eSERVO_I2C_DEVICE           = eI2C0_DEVICE,
+    /* Real-time AO so a LOCK isn't delayed by the video pipeline */
+    eSERVO_THREAD_POLICY        = eTHREAD_POLICY_FIFO,
+    eSERVO_THREAD_PRIORITY      = 60,
+    eSERVO_THREAD_AFFINITY_MASK = 0,
+    eSERVO_THREAD_STACK_SIZE    = 0
 } eServoConfig;
 
 #endif
\ No newline at end of file
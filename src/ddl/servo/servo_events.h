@@ -13,4 +13,15 @@ typedef enum
     eSERVO_EVENT_ROTATION_TIMEOUT
 } eServoEvent;
 
+/* Dispatch priority of each servo event, the ones not listed are eEVENT_PRIORITY_NORMAL.
+ * A LOCK or a timeout must not wait behind stale DIRECTIONS */
+#define SERVO_EVENT_PRIORITIES                                      \
+    [eFSM_EVENT_END]                = eEVENT_PRIORITY_URGENT,       \
+    [eSERVO_EVENT_LOCK]             = eEVENT_PRIORITY_URGENT,       \
+    [eSERVO_EVENT_ROTATION_TIMEOUT] = eEVENT_PRIORITY_URGENT
+
+/* Idempotent events: another one while the first is still queued only asks for the newest target again */
+#define SERVO_EVENT_COALESCED                                       \
+    [eSERVO_EVENT_DIRECTIONS] = true
+
 #endif
\ No newline at end of file
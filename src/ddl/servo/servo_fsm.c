@@ -10,30 +10,19 @@
 /* User library includes */
 #include "ddl/servo/servo_config.h"
 #include "ddl/servo/servo_types.h"
+#include "util/event_pool/event_pool.h"
 #include "hal/i2c/hal_i2c.h"
 #include "util/log/log.h"
 #include "osal/osal.h"
 
-typedef struct
-{
-    float   hor_angle;
-    float   ver_angle;
-} ServoAngles;
-
-/* Acts as a registry for directed servo angles */
-typedef struct
-{
-    ServoAngles angles;
-    uint32_t    seq;    // identifier for fresh data between reads
-} ServoTarget;
-
-static TimerArg timer_arg;
+/* Posted by the AO's own time event once the servos had time to rotate */
+static Event rotation_timeout_event = { .type = eSERVO_EVENT_ROTATION_TIMEOUT };
 
 static ServoAngles servo_scan_state_angles;
 static bool angle_direction;
 
-static ServoTarget servo_target_angles;
-static void* servo_target_mutex;
+/* Last target received in an event payload, only touched by the servo thread */
+static ServoAngles servo_target_angles;
 
 static void sleep_us(long us)
 {
@@ -50,13 +39,6 @@ static float clampf(float x, float lo, float hi)
     return x;
 }
 
-static void timeout_handler(void* arg)
-{
-    static Event timeout_event = { .type = eSERVO_EVENT_ROTATION_TIMEOUT };
-    ServoObject* aobj = (ServoObject*)arg;
-    (void)util_active_object_post(&aobj->aobj, &timeout_event);
-}
-
 static eStatus pca9685_write8(uint8_t reg, uint8_t value)
 {
     return hal_i2c_write_reg(eSERVO_I2C_DEVICE, reg, 1, &value, 1);
@@ -266,9 +248,8 @@ static void servo_scan_operation()
 static eStatus servo_init_angles()
 {
     eStatus status;
-    servo_target_angles.angles.hor_angle = 0.0f;
-    servo_target_angles.angles.ver_angle = 90.f;
-    servo_target_angles.seq = 0;
+    servo_target_angles.hor_angle = 0.0f;
+    servo_target_angles.ver_angle = 90.f;
     servo_scan_state_angles.hor_angle = 0.0f;
     servo_scan_state_angles.ver_angle = 90.0f;
     angle_direction = SERVO_INCREASE_ANGLE;
@@ -281,62 +262,27 @@ static eStatus servo_init_angles()
     return status;
 }
 
-/* Create a copy of the target angles so the FSM can act on the target without
- * being dependant on the popular `servo_target_angle` instance */
-static void servo_copy_target(ServoTarget* out)
+/* Keep the target carried by a pooled event, returns false for an event
+ * without a payload, such as the scheduler's static DIRECTIONS */
+static bool servo_take_target(Event* event)
 {
-    osal_mutex_lock(servo_target_mutex);
-    *out = servo_target_angles;
-    osal_mutex_unlock(servo_target_mutex);
-}
-
-void servo_fsm_destroy()
-{
-    if(servo_target_mutex != NULL)
+    const ServoAngles* angles = util_event_pool_payload(event);
+    if(angles == NULL)
     {
-        osal_mutex_destroy(servo_target_mutex);
-        servo_target_mutex = NULL;
+        return false;
     }
-}
 
-/* Public setter. Caller must follow this with `util_event_bus_publish()` with
- * the fitting event to actually move the FSM into the corresponding state */
-eStatus servo_fsm_set_target(float hor_angle, float ver_angle)
-{
-    if(hor_angle < SERVO_HORIZONTAL_MIN_ANGLE_DEG || hor_angle > SERVO_HORIZONTAL_MAX_ANGLE_DEG)
-    {
-        return eSTATUS_INVALID_VALUE;
-    }
-    if(ver_angle < SERVO_VERTICAL_MIN_ANGLE_DEG || ver_angle > SERVO_VERTICAL_MAX_ANGLE_DEG)
-    {
-        return eSTATUS_INVALID_VALUE;
-    }
-    if(servo_target_mutex == NULL)
-    {
-        return eSTATUS_ACTION_FAILED;
-    }
-
-    osal_mutex_lock(servo_target_mutex);
-    servo_target_angles.angles.hor_angle = hor_angle;
-    servo_target_angles.angles.ver_angle = ver_angle;
-    servo_target_angles.seq++;
-    osal_mutex_unlock(servo_target_mutex);
-
-    return eSTATUS_SUCCESSFUL;
+    servo_target_angles = *angles;
+    return true;
 }
 
 void servo_init_state(FSM* fsm, Event* event)
 {
-    ServoObject* aobj = (ServoObject*)fsm->arg;
-
     switch(event->type)
     {
     case eFSM_EVENT_INIT:
         LOG_DEBUG("INIT entry");
-        timer_arg.handler = timeout_handler;
-        timer_arg.arg = aobj;
-        if(pca9685_init() || osal_mutex_init(&servo_target_mutex) ||
-            osal_timer_init(&aobj->timer, &timer_arg))
+        if(pca9685_init())
         {
             (void)util_fsm_transition(fsm, servo_error_state);
         }
@@ -426,10 +372,12 @@ void servo_scan_state(FSM* fsm, Event* event)
         break;
     case eSERVO_EVENT_NOISE_DETECTED:
         LOG_DEBUG("Noise-detected event received");
+        (void)servo_take_target(event);
         (void)util_fsm_transition(fsm, servo_noise_scan_state);
         break;
     case eSERVO_EVENT_LOCK:
         LOG_DEBUG("Lock event received");
+        (void)servo_take_target(event);
         (void)util_fsm_transition(fsm, servo_target_lock_state);
         break;
     default:
@@ -440,19 +388,17 @@ void servo_scan_state(FSM* fsm, Event* event)
 void servo_noise_scan_state(FSM* fsm, Event* event)
 {
     ServoObject* aobj = (ServoObject*)fsm->arg;
-    ServoTarget target_copy;
 
     switch(event->type)
     {
     case eFSM_EVENT_ENTRY:
         LOG_DEBUG("NOISE_SCAN entry");
-        servo_copy_target(&target_copy);
-        servo_scan_state_angles = target_copy.angles;
-        if(servo_set_both_angles(aobj, target_copy.angles))
+        servo_scan_state_angles = servo_target_angles;
+        if(servo_set_both_angles(aobj, servo_target_angles))
         {
             LOG_ERROR("Failed to set servos' angles");
         }
-        (void)osal_timer_arm(aobj->timer, SERVO_MAX_ROTATION_DURATION_MS, eTIMER_TYPE_ONCE);
+        (void)util_active_object_arm(&aobj->aobj, &rotation_timeout_event, SERVO_MAX_ROTATION_DURATION_MS, false);
         break;
     case eSERVO_EVENT_DIRECTIONS:
         // Nothing to do in with this event. We wait on eSERVO_EVENT_ROTATION_TIMEOUT
@@ -469,7 +415,7 @@ void servo_noise_scan_state(FSM* fsm, Event* event)
         break;
     case eFSM_EVENT_EXIT:
         LOG_DEBUG("NOISE_SCAN exit");
-        (void)osal_timer_disarm(aobj->timer);
+        (void)util_active_object_disarm(&aobj->aobj, &rotation_timeout_event);
         break;
     default:
         LOG_WARNING("Unknown event type %u", event->type); 
@@ -479,27 +425,21 @@ void servo_noise_scan_state(FSM* fsm, Event* event)
 void servo_target_lock_state(FSM* fsm, Event* event)
 {
     ServoObject* aobj = (ServoObject*)fsm->arg;
-    static uint32_t last_seq;
-    ServoTarget target_copy;
 
     switch(event->type)
     {
     case eFSM_EVENT_ENTRY:
         LOG_DEBUG("TARGET_LOCK entry");
-        servo_copy_target(&target_copy);
-        last_seq = target_copy.seq;
-        if(servo_set_both_angles(aobj, target_copy.angles))
+        if(servo_set_both_angles(aobj, servo_target_angles))
         {
             LOG_ERROR("Failed to set servos' angles");
         }
         break;
     case eSERVO_EVENT_DIRECTIONS:
         LOG_DEBUG("Directions event received");
-        servo_copy_target(&target_copy);
-        if(last_seq == target_copy.seq)
+        if(!servo_take_target(event))
             break;
-        last_seq = target_copy.seq;
-        if(servo_set_both_angles(aobj, target_copy.angles))
+        if(servo_set_both_angles(aobj, servo_target_angles))
         {
             LOG_ERROR("Failed to set servos' angles");
         }
@@ -11,11 +11,17 @@ typedef struct
     float   ver_angle;
 } ServoFrame;
 
+/* Payload of pooled LOCK, DIRECTIONS and NOISE_DETECTED events */
+typedef struct
+{
+    float   hor_angle;
+    float   ver_angle;
+} ServoAngles;
+
 typedef struct
 {
     ActiveObject    aobj;
     ServoFrame*     frame;
-    void*           timer;
 } ServoObject;
 
 
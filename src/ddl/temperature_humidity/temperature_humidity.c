@@ -8,6 +8,20 @@
 
 static TemperatureHumidityObject temp_hum_aobj;
 
+static const bool temperature_humidity_event_coalesced[] = { TEMPERATURE_HUMIDITY_EVENT_COALESCED };
+
+static const ActiveObjectAttr temp_hum_aobj_attr = {
+    .thread = {
+        .affinity_mask  = eTEMPERATURE_HUMIDITY_THREAD_AFFINITY_MASK,
+        .name           = TEMPERATURE_HUMIDITY_THREAD_NAME,
+        .stack_size     = eTEMPERATURE_HUMIDITY_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eTEMPERATURE_HUMIDITY_THREAD_POLICY,
+        .priority       = eTEMPERATURE_HUMIDITY_THREAD_PRIORITY
+    },
+    .event_coalesced        = temperature_humidity_event_coalesced,
+    .event_coalesced_count  = sizeof(temperature_humidity_event_coalesced) / sizeof(temperature_humidity_event_coalesced[0])
+};
+
 eStatus ddl_temperature_humidity_init(DDLFrame* frame)
 {
     if(frame == NULL)
@@ -21,7 +35,8 @@ eStatus ddl_temperature_humidity_init(DDLFrame* frame)
     return util_active_object_init(
         &temp_hum_aobj.aobj,
         eTEMPERATURE_HUMIDITY_QUEUE_CAPACITY,
-        temperature_humidity_init_state
+        temperature_humidity_init_state,
+        &temp_hum_aobj_attr
     );
 }
 
@@ -43,4 +58,14 @@ void ddl_temperature_humidity_join(void)
 void ddl_temperature_humidity_delete(void)
 {
     util_active_object_delete(&temp_hum_aobj.aobj);
+}
+
+eStatus ddl_temperature_humidity_get_stats(ActiveObjectStats* stats)
+{
+    return util_active_object_get_stats(&temp_hum_aobj.aobj, stats);
+}
+
+void ddl_temperature_humidity_invalidate(void)
+{
+    __atomic_store_n(&temp_hum_aobj.frame->valid, false, __ATOMIC_RELAXED);
 }
\ No newline at end of file
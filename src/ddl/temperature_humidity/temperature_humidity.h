@@ -45,4 +45,19 @@ void ddl_temperature_humidity_join(void);
  */
 void ddl_temperature_humidity_delete(void);
 
+/**
+ * @brief   Read the queue and dispatch statistics of the temperature & humidity sensor's AO.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      stats is NULL
+ */
+eStatus ddl_temperature_humidity_get_stats(ActiveObjectStats* stats);
+
+/**
+ * @brief   Mark the temperature & humidity sensor's frame invalid until its next good read.
+ * @details Can be called from any thread after @ref ddl_temperature_humidity_init.
+ */
+void ddl_temperature_humidity_invalidate(void);
+
 #endif
\ No newline at end of file
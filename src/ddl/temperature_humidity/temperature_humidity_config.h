@@ -2,6 +2,7 @@
 #define DDL_TEMPERATURE_HUMIDITY_CONFIG_H
 
 /* User library includes */
+#include "osal/osal.h"
 #include "hal/gpio/hal_gpio_config.h"
 
 /* Host start signal: Tbe = 0.8..20 ms. Typical value is 1 ms. */
@@ -31,11 +32,20 @@
 #define AM2302_BIT_COUNT                40
 #define AM2302_BYTE_COUNT               5
 
+/* The bit-banged read is timing critical, so the AO runs with a real-time
+ * policy. A non-zero affinity mask pins it, e.g. to an isolated core. */
+#define TEMPERATURE_HUMIDITY_THREAD_NAME "am2302"
+
 typedef enum eTemperatureHumidityConfig
 {
     eTEMPERATURE_HUMIDITY_QUEUE_CAPACITY = 4,
     eTEMPERATURE_HUMIDITY_RETRY_MAX = 3,
-    eTEMPERATURE_HUMIDITY_GPIO_DEVICE    = eGPIO0_DEVICE
+    eTEMPERATURE_HUMIDITY_STALL_DEADLINE_MS = 1000,    // a read spins for ~5 ms, far below
+    eTEMPERATURE_HUMIDITY_GPIO_DEVICE    = eGPIO0_DEVICE,
+    eTEMPERATURE_HUMIDITY_THREAD_POLICY = eTHREAD_POLICY_FIFO,
+    eTEMPERATURE_HUMIDITY_THREAD_PRIORITY = 70,
+    eTEMPERATURE_HUMIDITY_THREAD_AFFINITY_MASK = 0,
+    eTEMPERATURE_HUMIDITY_THREAD_STACK_SIZE = 0
 } eTemperatureHumidityConfig;
 
 #endif
\ No newline at end of file
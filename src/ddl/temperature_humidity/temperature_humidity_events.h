@@ -9,4 +9,8 @@ typedef enum
     eTEMPERATURE_HUMIDITY_EVENT_READ = eFSM_EVENT_USER
 } eTemperatureHumidityEvent;
 
+/* Idempotent events: another one while the first is still queued only asks for a new reading again */
+#define TEMPERATURE_HUMIDITY_EVENT_COALESCED                        \
+    [eTEMPERATURE_HUMIDITY_EVENT_READ] = true
+
 #endif
\ No newline at end of file
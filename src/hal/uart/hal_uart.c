@@ -7,12 +7,15 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/eventfd.h>
 
 /* Linux Specific Libraries */
 #include <termios.h>
 
 /* User Libraries */
 #include "hal_uart_config.h"
+#include "util/trace/trace.h"
+#include "osal/osal.h"
 
 #define MAX_QUEUED_OPERATIONS (eUART_MAX_QUEUED_OPERATIONS * eUART_DEVICE_COUNT)
 #define MAX_QUEUE_ENTRIES     (MAX_QUEUED_OPERATIONS * 2)
@@ -69,7 +72,11 @@ static UARTDevice uart_devices[eUART_DEVICE_COUNT] = {
 };
 
 static pthread_mutex_t uart_mutex   = PTHREAD_MUTEX_INITIALIZER;
+#ifdef OSAL_EVENT_LOOP
+static int             uart_event_fd = -1;
+#else
 static pthread_t       uart_thread  = 0;
+#endif
 static struct io_uring uart_ring    = { 0 };
 static bool            uart_running = false;
 
@@ -93,6 +100,42 @@ static void free_slot(OpSlot* slot)
     slot->used = false;
 }
 
+/* Hands one completion to its callback, with uart_mutex held */
+static void uart_complete(struct io_uring_cqe* cqe)
+{
+    OpSlot* slot = io_uring_cqe_get_data(cqe);
+    if(slot != NULL)
+    {
+        util_trace_record(eTRACE_KIND_IO_COMPLETE, slot->arg, (uint32_t)cqe->res, 0);
+        if(slot->callback != NULL && cqe->res > 0)
+        {
+           slot->callback(slot->arg);
+        }
+
+        free_slot(slot);
+    }
+
+    io_uring_cqe_seen(&uart_ring, cqe);
+}
+
+#ifdef OSAL_EVENT_LOOP
+/* The ring signals uart_event_fd for each completion, the loop drains them */
+static void uart_completions(void* arg)
+{
+    (void)arg;
+    uint64_t signals;
+    ssize_t length = read(uart_event_fd, &signals, sizeof(signals));
+    (void)length;
+
+    (void)pthread_mutex_lock(&uart_mutex);
+    struct io_uring_cqe* cqe = NULL;
+    while(io_uring_peek_cqe(&uart_ring, &cqe) == 0 && cqe != NULL)
+    {
+        uart_complete(cqe);
+    }
+    (void)pthread_mutex_unlock(&uart_mutex);
+}
+#else
 static void* io_completion_thread(void* arg)
 {
     (void)arg;
@@ -106,25 +149,13 @@ static void* io_completion_thread(void* arg)
         }
 
         (void)pthread_mutex_lock(&uart_mutex);
-
-        OpSlot* slot = io_uring_cqe_get_data(cqe);
-        if(slot != NULL)
-        {
-            if(slot->callback != NULL && cqe->res > 0)
-            {
-               slot->callback(slot->arg);
-            }
-
-            free_slot(slot);
-        }
-
-        io_uring_cqe_seen(&uart_ring, cqe);
-
+        uart_complete(cqe);
         (void)pthread_mutex_unlock(&uart_mutex);
     }
 
     return NULL;
 }
+#endif
 
 eStatus hal_uart_init(void)
 {
@@ -219,12 +250,29 @@ eStatus hal_uart_init(void)
     }
 
     uart_running = true;
+#ifdef OSAL_EVENT_LOOP
+    /* Completions are handled by the event loop instead of a thread of their own */
+    uart_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(uart_event_fd < 0 || io_uring_register_eventfd(&uart_ring, uart_event_fd) < 0 ||
+       osal_loop_add_fd(uart_event_fd, uart_completions, NULL) != eSTATUS_SUCCESSFUL)
+    {
+        if(uart_event_fd >= 0)
+        {
+            (void)close(uart_event_fd);
+            uart_event_fd = -1;
+        }
+        io_uring_queue_exit(&uart_ring);
+        uart_running = false;
+        return eSTATUS_SYSTEM_ERROR;
+    }
+#else
     if(pthread_create(&uart_thread, NULL, io_completion_thread, NULL))
     {
         io_uring_queue_exit(&uart_ring);
         uart_running = false;
         return eSTATUS_SYSTEM_ERROR;
     }
+#endif
 
     return eSTATUS_SUCCESSFUL;
 }
@@ -334,6 +382,13 @@ eStatus hal_uart_abort(uint32_t device_index)
 
     (void)pthread_mutex_lock(&uart_mutex);
 
+    /* Callbacks run with uart_mutex held, so none of these runs once it is
+     * released, even for an operation that completes before the cancel */
+    for(int i = 0; i < eUART_MAX_QUEUED_OPERATIONS; i++)
+    {
+        uart_devices[device_index].slots[i].callback = NULL;
+    }
+
     struct io_uring_sqe* sqe = io_uring_get_sqe(&uart_ring);
     if(sqe == NULL) 
     {
@@ -355,6 +410,12 @@ eStatus hal_uart_abort(uint32_t device_index)
 
 void hal_uart_cleanup(void)
 {
+#ifdef OSAL_EVENT_LOOP
+    uart_running = false;
+    osal_loop_remove_fd(uart_event_fd);
+    (void)close(uart_event_fd);
+    uart_event_fd = -1;
+#else
     (void)pthread_mutex_lock(&uart_mutex);
 
     uart_running = false;
@@ -370,6 +431,7 @@ void hal_uart_cleanup(void)
     (void)pthread_mutex_unlock(&uart_mutex);
 
     (void)pthread_join(uart_thread, NULL);
+#endif
 
     io_uring_queue_exit(&uart_ring);
 
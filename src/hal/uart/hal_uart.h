@@ -61,6 +61,9 @@ eStatus hal_uart_read(uint32_t device_index, void* buffer, uint32_t len, async_c
 
 /**
  * @brief   Abort submitted device operation.
+ * @details Cancels the device's operations in flight. Once this returns
+ *          their callbacks are never called, even for an operation that
+ *          still completes, so the caller can free what they point to.
  * @param   device_index A value from @ref eUARTDeviceNumber.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
@@ -2,11 +2,18 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <signal.h>
 
 /* User library includes */
 #include "util/event_bus/event_list.h"
 #include "util/event_bus/event_bus.h"
+#include "util/event_pool/event_pool.h"
+#include "util/active_object/active_object.h"
+#include "util/executor/executor.h"
+#include "util/supervisor/supervisor.h"
+#include "util/trace/trace.h"
 #include "util/log/log.h"
+#include "osal/osal.h"
 #include "hal/hal.h"
 #include "app/app.h"
 
@@ -20,6 +27,22 @@ int main(void)
         return 1;
     }
 
+    status = osal_init();
+    if(status)
+    {
+        LOG_ERROR("Failed to initialize the OSAL layer");
+        return 1;
+    }
+
+    // Recording from the first thread on, `make trace` dumps it while running
+    util_trace_init();
+    status = util_trace_dump_on_signal(SIGUSR1);
+    if(status)
+    {
+        LOG_ERROR("Failed to install the trace dump signal handler");
+        return 1;
+    }
+
     status = hal_init();
     if(status)
     {
@@ -34,6 +57,24 @@ int main(void)
         return 1;
     }
 
+    util_event_pool_init();
+
+    // One tick for the timeouts of every AO
+    status = util_active_object_time_init();
+    if(status)
+    {
+        LOG_ERROR("Failed to start the AO time events");
+        return 1;
+    }
+
+    // Workers for the AOs configured to run on the executor, started before them
+    status = util_executor_init(eEXECUTOR_THREAD_COUNT);
+    if(status)
+    {
+        LOG_ERROR("Failed to start the executor");
+        return 1;
+    }
+
     status = app_init();
     if(status)
     {
@@ -41,6 +82,17 @@ int main(void)
         return 1;
     }
 
+    // Everything is allocated, any allocation from now on is refused
+    osal_alloc_seal();
+
+    // Watches the DDL modules registered by app_init for stalls
+    status = util_supervisor_start(eSUPERVISOR_PERIOD_MS);
+    if(status)
+    {
+        LOG_ERROR("Failed to start the supervisor");
+        return 1;
+    }
+
     Event sched_start = { .type = eSCHEDULER_EVENT_START };
     status = util_event_bus_publish(eAO_SCHEDULER, sched_start.type);
     if(status)
@@ -49,9 +101,36 @@ int main(void)
         return 1;
     }
 
+    // In a LOOP=1 build this thread runs every AO, timer and UART completion
+    // from here on, until the AOs stop
     app_join();
+    util_supervisor_stop();
+    util_executor_delete();
+
+    OsalDelayStats delay_stats;
+    osal_delay_get_stats(&delay_stats);
+    LOG_INFO("Delays: %llu calls, %llu us sleeping, %llu us spinning (window %llu us)",
+             (unsigned long long)delay_stats.calls,
+             (unsigned long long)(delay_stats.sleep_ns / 1000),
+             (unsigned long long)(delay_stats.spin_ns / 1000),
+             (unsigned long long)(delay_stats.spin_window_ns / 1000));
+
+    OsalAllocStats alloc_stats;
+    osal_alloc_get_stats(&alloc_stats);
+    LOG_INFO("Heap: %llu allocations (%llu bytes) during init, %llu refused after",
+             (unsigned long long)alloc_stats.heap_allocations,
+             (unsigned long long)alloc_stats.heap_bytes,
+             (unsigned long long)alloc_stats.failed);
+
+    SupervisorStats supervisor_stats;
+    util_supervisor_get_stats(&supervisor_stats);
+    LOG_INFO("Supervisor: %llu checks, %llu stalls, %llu recoveries",
+             (unsigned long long)supervisor_stats.checks,
+             (unsigned long long)supervisor_stats.stalls,
+             (unsigned long long)supervisor_stats.recoveries);
 
     app_delete();
+    util_active_object_time_delete();
     util_event_bus_delete();
     hal_cleanup();
     log_exit();
@@ -4,10 +4,167 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <stddef.h>
-#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
+#include <sched.h>
+#include <limits.h>
 #include <unistd.h>
+#include <errno.h>
 #include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <linux/futex.h>
+
+/* User library includes */
+#include "osal_config.h"
+
+#if defined(OSAL_EVENT_LOOP) && defined(OSAL_VIRTUAL_TIME)
+#error "OSAL_EVENT_LOOP and OSAL_VIRTUAL_TIME can't be combined"
+#endif
+
+typedef struct
+{
+    uint32_t value;     // semaphore count, or 1 when an event is set
+    uint32_t waiters;   // threads sleeping (or about to) on value
+} FutexWord;
+
+typedef struct
+{
+    TimerArg* timer_arg;
+    int32_t   fd;
+    uint32_t  slot;
+} TimerContext;
+
+/*
+ * All timers are serviced by a single thread which waits on an epoll set of
+ * timerfds. The epoll entries carry a slot index rather than a pointer, so a
+ * timer destroyed while its expiry is already queued in the service thread is
+ * simply not found in the slot table anymore.
+ */
+static pthread_mutex_t timer_service_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TimerContext*   timer_slots[eOSAL_TIMER_MAX_COUNT];
+#ifndef OSAL_VIRTUAL_TIME
+static pthread_once_t  timer_service_once = PTHREAD_ONCE_INIT;
+#ifndef OSAL_EVENT_LOOP
+static pthread_t       timer_service_thread;
+#endif
+static int             timer_service_epoll_fd = -1;
+static eStatus         timer_service_status = eSTATUS_SYSTEM_ERROR;
+#endif
+
+#ifdef OSAL_EVENT_LOOP
+/*
+ * The event loop is the timer service's epoll set without its thread. Past the
+ * timer slots, the epoll entries index the watched descriptors, then the kick.
+ */
+enum
+{
+    eLOOP_SOURCE_SLOT = eOSAL_TIMER_MAX_COUNT,
+    eLOOP_KICK_SLOT = eOSAL_TIMER_MAX_COUNT + eOSAL_LOOP_FD_MAX_COUNT
+};
+
+typedef struct
+{
+    LoopHandlerFP handler;
+    void*         arg;
+    int32_t       fd;
+    uint32_t      reserved;
+} LoopSource;
+
+static LoopSource loop_sources[eOSAL_LOOP_FD_MAX_COUNT];
+static int        loop_kick_fd = -1;
+#endif
+
+/* The native objects must fit the storage declared in osal.h */
+typedef char osal_mutex_storage_check[(sizeof(pthread_mutex_t) <= sizeof(OsalMutex)) ? 1 : -1];
+typedef char osal_cond_storage_check[(sizeof(pthread_cond_t) <= sizeof(OsalCond)) ? 1 : -1];
+typedef char osal_thread_storage_check[(sizeof(pthread_t) <= sizeof(OsalThread)) ? 1 : -1];
+typedef char osal_timer_storage_check[(sizeof(TimerContext) <= sizeof(OsalTimer)) ? 1 : -1];
+typedef char osal_sem_storage_check[(sizeof(FutexWord) <= sizeof(OsalSem)) ? 1 : -1];
+typedef char osal_event_storage_check[(sizeof(FutexWord) <= sizeof(OsalEvent)) ? 1 : -1];
+
+/* Arena allocations are aligned for the widest scalar, malloc gives the base at least as much */
+typedef char osal_arena_alignment_check[(__alignof__(long double) <= eOSAL_ARENA_ALIGNMENT) ? 1 : -1];
+
+/*
+ * Delays sleep until the deadline minus the spin window and busy-wait only for
+ * the rest. The window covers the worst wakeup latency seen by osal_init().
+ */
+static uint64_t delay_spin_window_ns = eOSAL_DELAY_SPIN_WINDOW_DEFAULT_US * 1000ull;
+static uint64_t delay_calls;
+static uint64_t delay_sleep_ns;
+static uint64_t delay_spin_ns;
+
+/*
+ * Arenas are registered so osal_dealloc() can recognize their memory, and
+ * osal_alloc() serves the arena bound to the calling thread, if any.
+ */
+static pthread_mutex_t arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+static OsalArena*      arenas[eOSAL_ARENA_MAX_COUNT];
+static __thread OsalArena* bound_arena;
+static uint64_t        alloc_heap_allocations;
+static uint64_t        alloc_heap_bytes;
+static uint64_t        alloc_failed;
+static bool            alloc_sealed;
+
+#ifdef OSAL_VIRTUAL_TIME
+#define SIM_TIME_NEVER UINT64_MAX
+
+typedef struct
+{
+    uint32_t value;     // semaphore count, event flag or wakeup flag
+    uint16_t waiters;   // threads blocked on value
+    uint16_t wakeups;   // waiters released but not running yet
+} SimWord;
+
+typedef struct
+{
+    uint64_t due_ns;    // delay deadline, SIM_TIME_NEVER when not sleeping
+    uint64_t seq;       // orders deadlines that fall on the same time
+    SimWord  wake;      // private word delays block on
+    SimWord  exited;    // set when entry_func returns
+    EntryFP  entry_func;
+    void*    arg;
+    bool     used;
+    bool     timed_out; // set when due_ns is reached while blocked
+    uint8_t  reserved[6];
+} SimThread;
+
+typedef struct
+{
+    uint64_t due_ns;    // next expiration, SIM_TIME_NEVER when disarmed
+    uint64_t period_ns; // 0 for one-time timers
+    uint64_t seq;       // orders expirations that fall on the same time
+} SimTimer;
+
+typedef char osal_sim_cond_storage_check[(sizeof(SimWord) <= sizeof(OsalCond)) ? 1 : -1];
+typedef char osal_sim_sem_storage_check[(sizeof(SimWord) <= sizeof(OsalSem)) ? 1 : -1];
+typedef char osal_sim_event_storage_check[(sizeof(SimWord) <= sizeof(OsalEvent)) ? 1 : -1];
+
+/*
+ * Virtual time: every OSAL thread counts as runnable until it blocks on an
+ * OSAL primitive. The thread advancing the clock waits until none is runnable
+ * and only then jumps to the earliest deadline. Wakers mark the threads they
+ * release as runnable themselves, so the count can't reach zero while a
+ * released thread has yet to run.
+ */
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  sim_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  sim_idle = PTHREAD_COND_INITIALIZER;
+static uint32_t        sim_runnable;
+static uint64_t        sim_now_ns;
+static uint64_t        sim_seq;
+static uint64_t        sim_wall_ns;
+static uint64_t        sim_timer_expirations;
+static uint64_t        sim_delay_wakeups;
+static SimTimer        sim_timers[eOSAL_TIMER_MAX_COUNT];
+static SimThread       sim_threads[eOSAL_SIM_THREAD_MAX_COUNT];
+static pthread_t       sim_thread_ids[eOSAL_SIM_THREAD_MAX_COUNT];
+static __thread SimThread* sim_self;
+#endif
 
 static uint64_t monotonic_ns(void)
 {
@@ -16,11 +173,94 @@ static uint64_t monotonic_ns(void)
     return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
 }
 
-static void timer_expired_handler(union sigval arg)
+#ifndef OSAL_VIRTUAL_TIME
+static void timer_service_dispatch(uint32_t slot)
+{
+    uint64_t expirations = 0;
+
+    (void)pthread_mutex_lock(&timer_service_mutex);
+    TimerContext* context = timer_slots[slot];
+    // Disarming resets the expiration counter, so a read that races with
+    // osal_timer_disarm() returns EAGAIN instead of a stale expiration
+    if(context != NULL &&
+       read(context->fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations) &&
+       expirations > 0)
+    {
+        context->timer_arg->handler(context->timer_arg->arg);
+    }
+    (void)pthread_mutex_unlock(&timer_service_mutex);
+}
+
+#ifndef OSAL_EVENT_LOOP
+static void* timer_service_entry(void* arg)
+{
+    (void)arg;
+    struct epoll_event events[eOSAL_TIMER_SERVICE_MAX_EVENTS];
+
+    for(;;)
+    {
+        int count = epoll_wait(timer_service_epoll_fd, events, eOSAL_TIMER_SERVICE_MAX_EVENTS, -1);
+        if(count < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for(int i = 0; i < count; ++i)
+        {
+            timer_service_dispatch(events[i].data.u32);
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+static void timer_service_start(void)
+{
+    timer_service_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(timer_service_epoll_fd == -1)
+    {
+        return;
+    }
+
+#ifdef OSAL_EVENT_LOOP
+    /* No thread, osal_loop_wait() serves the timers */
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = eLOOP_KICK_SLOT };
+    loop_kick_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(loop_kick_fd == -1 || epoll_ctl(timer_service_epoll_fd, EPOLL_CTL_ADD, loop_kick_fd, &event) == -1)
+    {
+        if(loop_kick_fd != -1)
+        {
+            (void)close(loop_kick_fd);
+            loop_kick_fd = -1;
+        }
+        (void)close(timer_service_epoll_fd);
+        timer_service_epoll_fd = -1;
+        return;
+    }
+#else
+    if(pthread_create(&timer_service_thread, NULL, timer_service_entry, NULL))
+    {
+        (void)close(timer_service_epoll_fd);
+        timer_service_epoll_fd = -1;
+        return;
+    }
+
+    (void)pthread_detach(timer_service_thread);
+#endif
+    timer_service_status = eSTATUS_SUCCESSFUL;
+}
+
+static eStatus timer_service_ready(void)
 {
-    TimerArg *timer_arg = arg.sival_ptr;
-    timer_arg->handler(timer_arg->arg);
+    (void)pthread_once(&timer_service_once, timer_service_start);
+    return timer_service_status;
 }
+#endif
 
 static inline void timespec_set_ms(struct timespec *ts, uint64_t ms)
 {
@@ -28,211 +268,1564 @@ static inline void timespec_set_ms(struct timespec *ts, uint64_t ms)
     ts->tv_nsec = (__time_t)((ms % 1000) * 1000000ULL);
 }
 
+static inline void timespec_set_ns(struct timespec *ts, uint64_t ns)
+{
+    ts->tv_sec  = (__time_t)(ns / 1000000000ULL);
+    ts->tv_nsec = (__time_t)(ns % 1000000000ULL);
+}
+
+#ifndef OSAL_VIRTUAL_TIME
+static void sleep_until_ns(uint64_t deadline_ns)
+{
+    struct timespec wake;
+    timespec_set_ns(&wake, deadline_ns);
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR)
+    {
+        // restart after signal handlers
+    }
+}
+
+static void delay_calibrate(void)
+{
+    uint64_t worst_latency = 0;
+
+    for(uint32_t i = 0; i < eOSAL_DELAY_CALIBRATION_SAMPLES; ++i)
+    {
+        uint64_t target = monotonic_ns() + eOSAL_DELAY_CALIBRATION_SLEEP_US * 1000ull;
+        sleep_until_ns(target);
+        uint64_t latency = monotonic_ns() - target;
+        if(latency > worst_latency)
+        {
+            worst_latency = latency;
+        }
+    }
+
+    uint64_t window = worst_latency + eOSAL_DELAY_SPIN_MARGIN_US * 1000ull;
+    if(window > eOSAL_DELAY_SPIN_WINDOW_MAX_US * 1000ull)
+    {
+        window = eOSAL_DELAY_SPIN_WINDOW_MAX_US * 1000ull;
+    }
+    __atomic_store_n(&delay_spin_window_ns, window, __ATOMIC_RELAXED);
+}
+#endif
+
+eStatus osal_init(void)
+{
+#ifndef OSAL_VIRTUAL_TIME
+    delay_calibrate();
+#endif
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+static bool arena_owns(const void* memory)
+{
+    bool owned = false;
+
+    (void)pthread_mutex_lock(&arena_mutex);
+    for(uint32_t i = 0; i < eOSAL_ARENA_MAX_COUNT && !owned; ++i)
+    {
+        owned = arenas[i] != NULL &&
+                (const uint8_t*)memory >= arenas[i]->base &&
+                (const uint8_t*)memory < arenas[i]->base + arenas[i]->size;
+    }
+    (void)pthread_mutex_unlock(&arena_mutex);
+
+    return owned;
+}
+
 void* osal_alloc(size_t size)
 {
-    return malloc(size);
+    if(bound_arena != NULL)
+    {
+        return osal_arena_alloc(bound_arena, size);
+    }
+
+    if(__atomic_load_n(&alloc_sealed, __ATOMIC_RELAXED))
+    {
+        (void)__atomic_fetch_add(&alloc_failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    void* memory = malloc(size);
+    if(memory == NULL)
+    {
+        (void)__atomic_fetch_add(&alloc_failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    (void)__atomic_fetch_add(&alloc_heap_allocations, 1, __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&alloc_heap_bytes, size, __ATOMIC_RELAXED);
+    return memory;
 }
 
 void osal_dealloc(void* memory)
 {
-    free(memory);
+    if(memory != NULL && !arena_owns(memory))
+    {
+        free(memory);
+    }
 }
 
-eStatus osal_mutex_init(void** mutex)
+void osal_alloc_seal(void)
 {
-    if(mutex == NULL)
+    __atomic_store_n(&alloc_sealed, true, __ATOMIC_RELAXED);
+}
+
+void osal_alloc_get_stats(OsalAllocStats* stats)
+{
+    if(stats != NULL)
+    {
+        stats->heap_allocations = __atomic_load_n(&alloc_heap_allocations, __ATOMIC_RELAXED);
+        stats->heap_bytes = __atomic_load_n(&alloc_heap_bytes, __ATOMIC_RELAXED);
+        stats->failed = __atomic_load_n(&alloc_failed, __ATOMIC_RELAXED);
+        stats->sealed = __atomic_load_n(&alloc_sealed, __ATOMIC_RELAXED);
+    }
+}
+
+eStatus osal_arena_create(OsalArena* arena, size_t size, const char* name)
+{
+    if(arena == NULL || name == NULL || size == 0)
     {
         return eSTATUS_NULL_PARAM;
     }
 
-    *mutex = malloc(sizeof(pthread_mutex_t));
-    if(*mutex == NULL)
+    memset(arena, 0, sizeof(*arena));
+    arena->name = name;
+    arena->size = size;
+    arena->base = malloc(size);
+    if(arena->base == NULL)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    (void)pthread_mutex_lock(&arena_mutex);
+    uint32_t slot = 0;
+    while(slot < eOSAL_ARENA_MAX_COUNT && arenas[slot] != NULL)
+    {
+        ++slot;
+    }
+    if(slot < eOSAL_ARENA_MAX_COUNT)
+    {
+        arenas[slot] = arena;
+    }
+    (void)pthread_mutex_unlock(&arena_mutex);
+
+    if(slot == eOSAL_ARENA_MAX_COUNT)
     {
+        free(arena->base);
+        arena->base = NULL;
         return eSTATUS_SYSTEM_ERROR;
     }
 
-    if(pthread_mutex_init((pthread_mutex_t*)(*mutex), NULL))
+    return eSTATUS_SUCCESSFUL;
+}
+
+void* osal_arena_alloc(OsalArena* arena, size_t size)
+{
+    if(arena == NULL || arena->base == NULL)
+    {
+        return NULL;
+    }
+
+    size_t aligned = (size + (eOSAL_ARENA_ALIGNMENT - 1)) & ~((size_t)eOSAL_ARENA_ALIGNMENT - 1);
+    if(arena->sealed || aligned == 0 || aligned > arena->size - arena->used)
+    {
+        arena->failed++;
+        return NULL;
+    }
+
+    void* memory = arena->base + arena->used;
+    arena->used += aligned;
+    arena->allocations++;
+    if(arena->used > arena->peak)
+    {
+        arena->peak = arena->used;
+    }
+
+    return memory;
+}
+
+void osal_arena_reset(OsalArena* arena)
+{
+    if(arena != NULL)
+    {
+        arena->used = 0;
+    }
+}
+
+void osal_arena_seal(OsalArena* arena)
+{
+    if(arena != NULL)
+    {
+        arena->sealed = true;
+    }
+}
+
+void osal_arena_unseal(OsalArena* arena)
+{
+    if(arena != NULL)
+    {
+        arena->sealed = false;
+    }
+}
+
+void osal_arena_stats(const OsalArena* arena, OsalArenaStats* stats)
+{
+    if(arena != NULL && stats != NULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+        stats->name = arena->name;
+        stats->size = arena->size;
+        stats->used = arena->used;
+        stats->peak = arena->peak;
+        stats->allocations = arena->allocations;
+        stats->failed = arena->failed;
+        stats->sealed = arena->sealed;
+    }
+}
+
+void osal_arena_bind(OsalArena* arena)
+{
+    bound_arena = arena;
+}
+
+void osal_arena_destroy(OsalArena* arena)
+{
+    if(arena != NULL && arena->base != NULL)
+    {
+        (void)pthread_mutex_lock(&arena_mutex);
+        for(uint32_t i = 0; i < eOSAL_ARENA_MAX_COUNT; ++i)
+        {
+            if(arenas[i] == arena)
+            {
+                arenas[i] = NULL;
+            }
+        }
+        (void)pthread_mutex_unlock(&arena_mutex);
+
+        free(arena->base);
+        arena->base = NULL;
+    }
+}
+
+eStatus osal_mutex_init(OsalMutex* mutex)
+{
+    if(mutex == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(pthread_mutex_init((pthread_mutex_t*)mutex, NULL))
     {
-        free(*mutex);
         return eSTATUS_SYSTEM_ERROR;
     }
 
     return eSTATUS_SUCCESSFUL;
 } 
 
-void osal_mutex_lock(void* mutex)
+void osal_mutex_lock(OsalMutex* mutex)
 {
-    (void)pthread_mutex_lock((pthread_mutex_t*)(mutex));
+    (void)pthread_mutex_lock((pthread_mutex_t*)mutex);
 }
 
-void osal_mutex_unlock(void* mutex)
+void osal_mutex_unlock(OsalMutex* mutex)
 {
-    (void)pthread_mutex_unlock((pthread_mutex_t*)(mutex));
+    (void)pthread_mutex_unlock((pthread_mutex_t*)mutex);
 }
 
-void osal_mutex_destroy(void* mutex)
+void osal_mutex_destroy(OsalMutex* mutex)
 {
     if(mutex != NULL)
     {
-        (void)pthread_mutex_destroy((pthread_mutex_t*)(mutex));
-        free(mutex);
+        (void)pthread_mutex_destroy((pthread_mutex_t*)mutex);
     }
 }
 
-eStatus osal_cond_init(void** cond)
+#ifndef OSAL_VIRTUAL_TIME
+eStatus osal_cond_init(OsalCond* cond)
 {
     if(cond == NULL)
     {
         return eSTATUS_NULL_PARAM;
     }
 
-    *cond = malloc(sizeof(pthread_cond_t));
-    if(*cond == NULL)
+    // Timed waits are measured on the monotonic clock like every OSAL timeout
+    pthread_condattr_t attr;
+    if(pthread_condattr_init(&attr))
     {
         return eSTATUS_SYSTEM_ERROR;
     }
 
-    if(pthread_cond_init((pthread_cond_t*)(*cond), NULL))
+    int result = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if(result == 0)
+    {
+        result = pthread_cond_init((pthread_cond_t*)cond, &attr);
+    }
+    (void)pthread_condattr_destroy(&attr);
+
+    if(result)
     {
-        free(*cond);
         return eSTATUS_SYSTEM_ERROR;
     }
 
     return eSTATUS_SUCCESSFUL;
 }
 
-void osal_cond_signal(void* cond)
+void osal_cond_signal(OsalCond* cond)
 {
-    (void)pthread_cond_signal((pthread_cond_t*)(cond));
+    (void)pthread_cond_signal((pthread_cond_t*)cond);
 }
 
-void osal_cond_wait(void* cond, void* mutex)
+void osal_cond_wait(OsalCond* cond, OsalMutex* mutex)
 {
-    (void)pthread_cond_wait((pthread_cond_t*)(cond), (pthread_mutex_t*)(mutex));
+    (void)pthread_cond_wait((pthread_cond_t*)cond, (pthread_mutex_t*)mutex);
 }
 
-void osal_cond_destroy(void* cond)
+eStatus osal_cond_timedwait(OsalCond* cond, OsalMutex* mutex, uint64_t timeout_ms)
 {
-    if(cond != NULL)
+    struct timespec deadline;
+    timespec_set_ns(&deadline, monotonic_ns() + timeout_ms * 1000000ull);
+
+    if(pthread_cond_timedwait((pthread_cond_t*)cond, (pthread_mutex_t*)mutex, &deadline) == ETIMEDOUT)
     {
-        (void)pthread_cond_destroy((pthread_cond_t*)(cond));
-        free(cond);
+        return eSTATUS_TIMEOUT;
     }
+
+    return eSTATUS_SUCCESSFUL;
 }
 
-eStatus osal_thread_create(void** thread, EntryFP entry_func, void* arg)
+void osal_cond_destroy(OsalCond* cond)
 {
-    if(thread == NULL || entry_func == NULL)
+    if(cond != NULL)
     {
-        return eSTATUS_NULL_PARAM;
+        (void)pthread_cond_destroy((pthread_cond_t*)cond);
     }
+}
+
+static void futex_wait(uint32_t* word, uint32_t expected, const struct timespec* timeout)
+{
+    // FUTEX_WAIT takes a relative timeout measured on the monotonic clock
+    (void)syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0);
+}
+
+static void futex_wake(uint32_t* word, int count)
+{
+    (void)syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/*
+ * The waiter registers itself before sleeping and the waker publishes the new
+ * value before checking for waiters, both sequentially consistent, so either
+ * the waker sees the waiter or FUTEX_WAIT sees the new value and returns.
+ */
+static void futex_word_sleep(FutexWord* word, const struct timespec* timeout)
+{
+    (void)__atomic_fetch_add(&word->waiters, 1, __ATOMIC_SEQ_CST);
+    futex_wait(&word->value, 0, timeout);
+    (void)__atomic_fetch_sub(&word->waiters, 1, __ATOMIC_RELAXED);
+}
 
-    *thread = malloc(sizeof(pthread_t));
-    if(*thread == NULL)
+static void futex_word_wake(FutexWord* word)
+{
+    if(__atomic_load_n(&word->waiters, __ATOMIC_SEQ_CST) != 0)
     {
-        return eSTATUS_SYSTEM_ERROR;
+        futex_wake(&word->value, 1);
     }
+}
 
-    if(pthread_create((pthread_t*)(*thread), NULL, entry_func, arg))
+eStatus osal_sem_init(OsalSem* sem, uint32_t count)
+{
+    if(sem == NULL)
     {
-        free(*thread);
-        return eSTATUS_SYSTEM_ERROR;
+        return eSTATUS_NULL_PARAM;
     }
 
+    FutexWord* word = (FutexWord*)sem;
+    word->value = count;
+    word->waiters = 0;
+
     return eSTATUS_SUCCESSFUL;
 }
 
-void osal_thread_join(void* thread)
+void osal_sem_post(OsalSem* sem)
 {
-    if(thread != NULL)
+    FutexWord* word = (FutexWord*)sem;
+    (void)__atomic_fetch_add(&word->value, 1, __ATOMIC_SEQ_CST);
+    futex_word_wake(word);
+}
+
+eStatus osal_sem_trywait(OsalSem* sem)
+{
+    FutexWord* word = (FutexWord*)sem;
+    uint32_t value = __atomic_load_n(&word->value, __ATOMIC_RELAXED);
+
+    while(value != 0)
     {
-        (void)pthread_join(*((pthread_t*)(thread)), NULL);
-        free(thread);
+        if(__atomic_compare_exchange_n(&word->value, &value, value - 1, true,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return eSTATUS_SUCCESSFUL;
+        }
     }
+
+    return eSTATUS_ACTION_FAILED;
 }
 
-void osal_delay_us(uint64_t us)
+void osal_sem_wait(OsalSem* sem)
 {
-    volatile uint64_t start = monotonic_ns();
-    volatile uint64_t duration = us * 1000ull;
+    while(osal_sem_trywait(sem) != eSTATUS_SUCCESSFUL)
+    {
+        futex_word_sleep((FutexWord*)sem, NULL);
+    }
+}
+
+eStatus osal_sem_timedwait(OsalSem* sem, uint64_t timeout_ms)
+{
+    uint64_t deadline = monotonic_ns() + timeout_ms * 1000000ull;
+
+    while(osal_sem_trywait(sem) != eSTATUS_SUCCESSFUL)
+    {
+        uint64_t now = monotonic_ns();
+        if(now >= deadline)
+        {
+            return eSTATUS_TIMEOUT;
+        }
 
-    while ((monotonic_ns() - start) < duration) {
-        // busy wait
+        struct timespec remaining;
+        timespec_set_ns(&remaining, deadline - now);
+        futex_word_sleep((FutexWord*)sem, &remaining);
     }
+
+    return eSTATUS_SUCCESSFUL;
 }
 
-void osal_delay_ms(uint64_t ms)
+void osal_sem_destroy(OsalSem* sem)
 {
-    osal_delay_us(ms * 1000ull);
+    (void)sem;
 }
 
-eStatus osal_timer_init(void** timer, TimerArg* timer_arg)
+eStatus osal_event_init(OsalEvent* event)
 {
-    if(timer == NULL || timer_arg == NULL || timer_arg->handler == NULL)
+    if(event == NULL)
     {
         return eSTATUS_NULL_PARAM;
     }
 
-    *timer = malloc(sizeof(timer_t));
-    if(*timer == NULL)
+    FutexWord* word = (FutexWord*)event;
+    word->value = 0;
+    word->waiters = 0;
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_event_set(OsalEvent* event)
+{
+    FutexWord* word = (FutexWord*)event;
+    if(__atomic_exchange_n(&word->value, 1, __ATOMIC_SEQ_CST) == 0)
     {
-        return eSTATUS_SYSTEM_ERROR;
+        futex_word_wake(word);
     }
+}
 
-    struct sigevent sig_event = {
-        .sigev_notify            = SIGEV_THREAD,
-        .sigev_notify_function   = timer_expired_handler,
-        .sigev_notify_attributes = NULL,
-        .sigev_value.sival_ptr   = timer_arg
-    };
+void osal_event_wait(OsalEvent* event)
+{
+    FutexWord* word = (FutexWord*)event;
+    uint32_t set = 1;
 
-    if(timer_create(CLOCK_MONOTONIC, &sig_event, (timer_t*)(*timer)) == -1)
+    while(!__atomic_compare_exchange_n(&word->value, &set, 0, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
     {
-        free(*timer);
-        return eSTATUS_SYSTEM_ERROR;
+        futex_word_sleep(word, NULL);
+        set = 1;
     }
-
-    return eSTATUS_SUCCESSFUL;
 }
 
-eStatus osal_timer_arm(void* timer, uint64_t ms, eTimerType type)
+eStatus osal_event_timedwait(OsalEvent* event, uint64_t timeout_ms)
 {
-    if(timer == NULL)
+    FutexWord* word = (FutexWord*)event;
+    uint64_t deadline = monotonic_ns() + timeout_ms * 1000000ull;
+    uint32_t set = 1;
+
+    while(!__atomic_compare_exchange_n(&word->value, &set, 0, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
     {
-        return eSTATUS_NULL_PARAM;
+        uint64_t now = monotonic_ns();
+        if(now >= deadline)
+        {
+            return eSTATUS_TIMEOUT;
+        }
+
+        struct timespec remaining;
+        timespec_set_ns(&remaining, deadline - now);
+        futex_word_sleep(word, &remaining);
+        set = 1;
     }
 
-    struct itimerspec its = { 0 };
-    timespec_set_ms(&its.it_value, ms);
+    return eSTATUS_SUCCESSFUL;
+}
 
-    if(type == eTIMER_TYPE_REPEAT)
+void osal_event_destroy(OsalEvent* event)
+{
+    (void)event;
+}
+#endif
+
+eStatus osal_thread_create(OsalThread* thread, EntryFP entry_func, void* arg)
+{
+    return osal_thread_create_ex(thread, entry_func, arg, NULL);
+}
+
+void osal_thread_yield(void)
+{
+    (void)sched_yield();
+}
+
+static eStatus thread_attr_apply(pthread_attr_t* pattr, const OsalThreadAttr* attr, bool scheduling)
+{
+    if(attr->stack_size != 0)
     {
-        timespec_set_ms(&its.it_interval, ms);
+        size_t stack_min = (size_t)PTHREAD_STACK_MIN;
+        size_t stack_size = (attr->stack_size < stack_min) ? stack_min : attr->stack_size;
+        if(pthread_attr_setstacksize(pattr, stack_size))
+        {
+            return eSTATUS_SYSTEM_ERROR;
+        }
     }
-    else if(type != eTIMER_TYPE_ONCE)
+
+    if(attr->affinity_mask != 0)
     {
-        return eSTATUS_INVALID_VALUE;
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for(uint32_t cpu = 0; cpu < 64; ++cpu)
+        {
+            if(attr->affinity_mask & (1ull << cpu))
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if(pthread_attr_setaffinity_np(pattr, sizeof(cpus), &cpus))
+        {
+            return eSTATUS_SYSTEM_ERROR;
+        }
     }
 
-    if(timer_settime(*((timer_t*)(timer)), 0, &its, NULL) == -1) 
+    if(scheduling && attr->policy != eTHREAD_POLICY_INHERIT)
     {
-        return eSTATUS_SYSTEM_ERROR;
+        static const int policies[] = {
+            [eTHREAD_POLICY_OTHER] = SCHED_OTHER,
+            [eTHREAD_POLICY_FIFO]  = SCHED_FIFO,
+            [eTHREAD_POLICY_RR]    = SCHED_RR
+        };
+        int policy = policies[attr->policy];
+        struct sched_param param = { .sched_priority = (policy == SCHED_OTHER) ? 0 : attr->priority };
+
+        if(pthread_attr_setinheritsched(pattr, PTHREAD_EXPLICIT_SCHED) ||
+           pthread_attr_setschedpolicy(pattr, policy) ||
+           pthread_attr_setschedparam(pattr, &param))
+        {
+            return eSTATUS_SYSTEM_ERROR;
+        }
     }
 
     return eSTATUS_SUCCESSFUL;
 }
 
-eStatus osal_timer_disarm(void* timer)
+static int thread_start(pthread_t* thread, EntryFP entry_func, void* arg,
+                        const OsalThreadAttr* attr, bool scheduling)
 {
-    // Arming timer to 0 disarms it
-    return osal_timer_arm(timer, 0, eTIMER_TYPE_REPEAT);
+    pthread_attr_t pattr;
+    if(pthread_attr_init(&pattr))
+    {
+        return EAGAIN;
+    }
+
+    int result = EINVAL;
+    if(thread_attr_apply(&pattr, attr, scheduling) == eSTATUS_SUCCESSFUL)
+    {
+        result = pthread_create(thread, &pattr, entry_func, arg);
+    }
+    (void)pthread_attr_destroy(&pattr);
+
+    return result;
 }
 
-void osal_timer_destroy(void* timer)
+static eStatus thread_create(pthread_t* thread, EntryFP entry_func, void* arg,
+                             const OsalThreadAttr* attr)
 {
-    if(timer != NULL)
+    if(attr == NULL)
+    {
+        return pthread_create(thread, NULL, entry_func, arg) ? eSTATUS_SYSTEM_ERROR : eSTATUS_SUCCESSFUL;
+    }
+
+    if(attr->policy > eTHREAD_POLICY_RR ||
+       ((attr->policy == eTHREAD_POLICY_FIFO || attr->policy == eTHREAD_POLICY_RR) &&
+        (attr->priority < 1 || attr->priority > 99)))
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    int result = thread_start(thread, entry_func, arg, attr, true);
+    if(result == EPERM)
     {
-        (void)timer_delete(*((timer_t*)(timer)));
-        free(timer);
+        // Real-time policies need CAP_SYS_NICE, run with the inherited one instead
+        result = thread_start(thread, entry_func, arg, attr, false);
     }
-}
\ No newline at end of file
+    if(result)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    if(attr->name != NULL)
+    {
+        char name[16];
+        (void)snprintf(name, sizeof(name), "%s", attr->name);
+        (void)pthread_setname_np(*thread, name);
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+#ifndef OSAL_VIRTUAL_TIME
+eStatus osal_thread_create_ex(OsalThread* thread, EntryFP entry_func, void* arg,
+                              const OsalThreadAttr* attr)
+{
+    if(thread == NULL || entry_func == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    return thread_create((pthread_t*)thread, entry_func, arg, attr);
+}
+
+void osal_thread_join(OsalThread* thread)
+{
+    if(thread != NULL)
+    {
+        (void)pthread_join(*((pthread_t*)thread), NULL);
+    }
+}
+
+uint64_t osal_time_now_ns(void)
+{
+    return monotonic_ns();
+}
+
+void osal_sim_advance_us(uint64_t us)
+{
+    sleep_until_ns(monotonic_ns() + us * 1000ull);
+}
+
+void osal_sim_get_stats(OsalSimStats* stats)
+{
+    if(stats != NULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+void osal_delay_us(uint64_t us)
+{
+    uint64_t start = monotonic_ns();
+    uint64_t deadline = start + us * 1000ull;
+    uint64_t window = __atomic_load_n(&delay_spin_window_ns, __ATOMIC_RELAXED);
+
+    if(us * 1000ull > window)
+    {
+        sleep_until_ns(deadline - window);
+    }
+
+    uint64_t spin_start = monotonic_ns();
+    uint64_t now = spin_start;
+    while(now < deadline)
+    {
+        now = monotonic_ns();
+    }
+
+    (void)__atomic_fetch_add(&delay_calls, 1, __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&delay_sleep_ns, spin_start - start, __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&delay_spin_ns, now - spin_start, __ATOMIC_RELAXED);
+}
+#endif
+
+void osal_delay_ms(uint64_t ms)
+{
+    osal_delay_us(ms * 1000ull);
+}
+
+void osal_delay_get_stats(OsalDelayStats* stats)
+{
+    if(stats != NULL)
+    {
+        stats->calls = __atomic_load_n(&delay_calls, __ATOMIC_RELAXED);
+        stats->sleep_ns = __atomic_load_n(&delay_sleep_ns, __ATOMIC_RELAXED);
+        stats->spin_ns = __atomic_load_n(&delay_spin_ns, __ATOMIC_RELAXED);
+        stats->spin_window_ns = __atomic_load_n(&delay_spin_window_ns, __ATOMIC_RELAXED);
+    }
+}
+
+#ifndef OSAL_VIRTUAL_TIME
+eStatus osal_timer_init(OsalTimer* timer, TimerArg* timer_arg)
+{
+    if(timer == NULL || timer_arg == NULL || timer_arg->handler == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(timer_service_ready() != eSTATUS_SUCCESSFUL)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    TimerContext* context = (TimerContext*)timer;
+    context->timer_arg = timer_arg;
+    context->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(context->fd == -1)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    (void)pthread_mutex_lock(&timer_service_mutex);
+    uint32_t slot = 0;
+    while(slot < eOSAL_TIMER_MAX_COUNT && timer_slots[slot] != NULL)
+    {
+        ++slot;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = slot };
+    if(slot == eOSAL_TIMER_MAX_COUNT ||
+       epoll_ctl(timer_service_epoll_fd, EPOLL_CTL_ADD, context->fd, &event) == -1)
+    {
+        (void)pthread_mutex_unlock(&timer_service_mutex);
+        (void)close(context->fd);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+    context->slot = slot;
+    timer_slots[slot] = context;
+    (void)pthread_mutex_unlock(&timer_service_mutex);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus osal_timer_arm(OsalTimer* timer, uint64_t ms, eTimerType type)
+{
+    if(timer == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    struct itimerspec its = { 0 };
+    timespec_set_ms(&its.it_value, ms);
+
+    if(type == eTIMER_TYPE_REPEAT)
+    {
+        timespec_set_ms(&its.it_interval, ms);
+    }
+    else if(type != eTIMER_TYPE_ONCE)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    // Serialized with the service thread so that once disarm returns, no
+    // expiration of the previous arming can still be delivered
+    TimerContext* context = (TimerContext*)timer;
+    (void)pthread_mutex_lock(&timer_service_mutex);
+    int result = timerfd_settime(context->fd, 0, &its, NULL);
+    (void)pthread_mutex_unlock(&timer_service_mutex);
+
+    if(result == -1)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_timer_destroy(OsalTimer* timer)
+{
+    if(timer != NULL)
+    {
+        TimerContext* context = (TimerContext*)timer;
+
+        (void)pthread_mutex_lock(&timer_service_mutex);
+        (void)epoll_ctl(timer_service_epoll_fd, EPOLL_CTL_DEL, context->fd, NULL);
+        timer_slots[context->slot] = NULL;
+        (void)pthread_mutex_unlock(&timer_service_mutex);
+
+        (void)close(context->fd);
+    }
+}
+#endif
+
+eStatus osal_timer_disarm(OsalTimer* timer)
+{
+    // Arming timer to 0 disarms it
+    return osal_timer_arm(timer, 0, eTIMER_TYPE_REPEAT);
+}
+
+#ifdef OSAL_EVENT_LOOP
+static void loop_dispatch(uint32_t slot)
+{
+    if(slot < eLOOP_SOURCE_SLOT)
+    {
+        timer_service_dispatch(slot);
+    }
+    else if(slot == eLOOP_KICK_SLOT)
+    {
+        uint64_t kicks;
+        ssize_t length = read(loop_kick_fd, &kicks, sizeof(kicks));
+        (void)length;
+    }
+    else if(loop_sources[slot - eLOOP_SOURCE_SLOT].handler != NULL)
+    {
+        LoopSource* source = &loop_sources[slot - eLOOP_SOURCE_SLOT];
+        source->handler(source->arg);
+    }
+}
+
+eStatus osal_loop_add_fd(int32_t fd, LoopHandlerFP handler, void* arg)
+{
+    if(handler == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(timer_service_ready() != eSTATUS_SUCCESSFUL)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    uint32_t index = 0;
+    while(index < eOSAL_LOOP_FD_MAX_COUNT && loop_sources[index].handler != NULL)
+    {
+        ++index;
+    }
+    if(index == eOSAL_LOOP_FD_MAX_COUNT)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = eLOOP_SOURCE_SLOT + index };
+    if(epoll_ctl(timer_service_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+    loop_sources[index] = (LoopSource){ .handler = handler, .arg = arg, .fd = fd };
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_loop_remove_fd(int32_t fd)
+{
+    for(uint32_t index = 0; index < eOSAL_LOOP_FD_MAX_COUNT; ++index)
+    {
+        if(loop_sources[index].handler != NULL && loop_sources[index].fd == fd)
+        {
+            (void)epoll_ctl(timer_service_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            loop_sources[index].handler = NULL;
+        }
+    }
+}
+
+eStatus osal_loop_wait(bool block)
+{
+    struct epoll_event events[eOSAL_TIMER_SERVICE_MAX_EVENTS];
+
+    if(timer_service_ready() != eSTATUS_SUCCESSFUL)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    int count = epoll_wait(timer_service_epoll_fd, events, eOSAL_TIMER_SERVICE_MAX_EVENTS, block ? -1 : 0);
+    if(count < 0)
+    {
+        return (errno == EINTR) ? eSTATUS_SUCCESSFUL : eSTATUS_SYSTEM_ERROR;
+    }
+
+    for(int i = 0; i < count; ++i)
+    {
+        loop_dispatch(events[i].data.u32);
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_loop_kick(void)
+{
+    uint64_t kick = 1;
+    if(timer_service_ready() == eSTATUS_SUCCESSFUL)
+    {
+        ssize_t length = write(loop_kick_fd, &kick, sizeof(kick));
+        (void)length;
+    }
+}
+#else
+eStatus osal_loop_add_fd(int32_t fd, LoopHandlerFP handler, void* arg)
+{
+    (void)fd;
+    (void)arg;
+    return (handler == NULL) ? eSTATUS_NULL_PARAM : eSTATUS_ACTION_FAILED;
+}
+
+void osal_loop_remove_fd(int32_t fd)
+{
+    (void)fd;
+}
+
+eStatus osal_loop_wait(bool block)
+{
+    (void)block;
+    return eSTATUS_ACTION_FAILED;
+}
+
+void osal_loop_kick(void)
+{
+}
+#endif
+
+#ifdef OSAL_VIRTUAL_TIME
+/* The sim_* helpers below are called with sim_mutex held */
+
+static void sim_runnable_drop(void)
+{
+    if(--sim_runnable == 0)
+    {
+        (void)pthread_cond_signal(&sim_idle);
+    }
+}
+
+/*
+ * Blocks until the word is released, or until deadline_ns for OSAL threads.
+ * Returns false on timeout.
+ */
+static bool sim_block(SimWord* word, OsalMutex* release, uint64_t deadline_ns)
+{
+    SimThread* self = sim_self;
+    bool released = true;
+
+    // Threads not created by the OSAL aren't counted, count them while blocked
+    if(self == NULL)
+    {
+        ++sim_runnable;
+    }
+    else if(deadline_ns != SIM_TIME_NEVER)
+    {
+        self->due_ns = deadline_ns;
+        self->seq = sim_seq++;
+    }
+
+    word->waiters++;
+    sim_runnable_drop();
+    if(release != NULL)
+    {
+        (void)pthread_mutex_unlock((pthread_mutex_t*)release);
+    }
+
+    while(word->wakeups == 0 && (self == NULL || !self->timed_out))
+    {
+        (void)pthread_cond_wait(&sim_wake, &sim_mutex);
+    }
+
+    if(word->wakeups != 0)
+    {
+        word->wakeups--;
+        if(self != NULL && self->timed_out)
+        {
+            // Released and timed out at once, both counted it as runnable
+            sim_runnable_drop();
+        }
+    }
+    else
+    {
+        // Timed out, so nobody took it off the waiters
+        word->waiters--;
+        released = false;
+    }
+
+    if(self == NULL)
+    {
+        sim_runnable_drop();
+    }
+    else
+    {
+        self->due_ns = SIM_TIME_NEVER;
+        self->timed_out = false;
+    }
+
+    return released;
+}
+
+static void sim_release(SimWord* word, uint32_t count)
+{
+    uint16_t released = (word->waiters < count) ? word->waiters : (uint16_t)count;
+
+    if(released != 0)
+    {
+        word->waiters = (uint16_t)(word->waiters - released);
+        word->wakeups = (uint16_t)(word->wakeups + released);
+        sim_runnable += released;
+        (void)pthread_cond_broadcast(&sim_wake);
+    }
+}
+
+static void sim_wait_idle(void)
+{
+    while(sim_runnable != 0)
+    {
+        (void)pthread_cond_wait(&sim_idle, &sim_mutex);
+    }
+}
+
+static void sim_timer_fire(uint32_t slot, uint64_t seq)
+{
+    // Handlers run under timer_service_mutex as with the timer service, and
+    // it is taken before sim_mutex
+    (void)pthread_mutex_unlock(&sim_mutex);
+    (void)pthread_mutex_lock(&timer_service_mutex);
+    (void)pthread_mutex_lock(&sim_mutex);
+
+    TimerContext* context = timer_slots[slot];
+    SimTimer* timer = &sim_timers[slot];
+    // Skip the expiration if the timer was re-armed, disarmed or destroyed meanwhile
+    bool fire = context != NULL && timer->due_ns != SIM_TIME_NEVER && timer->seq == seq;
+    if(fire)
+    {
+        if(timer->period_ns != 0)
+        {
+            timer->due_ns += timer->period_ns;
+            timer->seq = sim_seq++;
+        }
+        else
+        {
+            timer->due_ns = SIM_TIME_NEVER;
+        }
+        sim_timer_expirations++;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    if(fire)
+    {
+        context->timer_arg->handler(context->timer_arg->arg);
+    }
+    (void)pthread_mutex_unlock(&timer_service_mutex);
+    (void)pthread_mutex_lock(&sim_mutex);
+}
+
+static bool sim_fire_next(uint64_t end_ns)
+{
+    uint64_t due = SIM_TIME_NEVER;
+    uint64_t seq = 0;
+    SimThread* sleeper = NULL;
+    uint32_t slot = eOSAL_TIMER_MAX_COUNT;
+
+    for(uint32_t i = 0; i < eOSAL_SIM_THREAD_MAX_COUNT; ++i)
+    {
+        SimThread* thread = &sim_threads[i];
+        if(thread->used && thread->due_ns != SIM_TIME_NEVER &&
+           (thread->due_ns < due || (thread->due_ns == due && thread->seq < seq)))
+        {
+            due = thread->due_ns;
+            seq = thread->seq;
+            sleeper = thread;
+        }
+    }
+    for(uint32_t i = 0; i < eOSAL_TIMER_MAX_COUNT; ++i)
+    {
+        SimTimer* timer = &sim_timers[i];
+        if(timer_slots[i] != NULL && timer->due_ns != SIM_TIME_NEVER &&
+           (timer->due_ns < due || (timer->due_ns == due && timer->seq < seq)))
+        {
+            due = timer->due_ns;
+            seq = timer->seq;
+            sleeper = NULL;
+            slot = i;
+        }
+    }
+
+    if(due == SIM_TIME_NEVER || due > end_ns)
+    {
+        return false;
+    }
+
+    if(due > sim_now_ns)
+    {
+        sim_now_ns = due;
+    }
+
+    if(sleeper != NULL)
+    {
+        sleeper->due_ns = SIM_TIME_NEVER;
+        sleeper->timed_out = true;
+        ++sim_runnable;
+        (void)pthread_cond_broadcast(&sim_wake);
+        sim_delay_wakeups++;
+    }
+    else
+    {
+        sim_timer_fire(slot, seq);
+    }
+
+    return true;
+}
+
+static void sim_run_until(uint64_t end_ns, const SimWord* done)
+{
+    uint64_t start = monotonic_ns();
+    bool reached = true;
+
+    for(;;)
+    {
+        sim_wait_idle();
+        if(done != NULL && done->value != 0)
+        {
+            reached = false;
+            break;
+        }
+        if(!sim_fire_next(end_ns))
+        {
+            break;
+        }
+    }
+
+    if(reached && end_ns != SIM_TIME_NEVER && end_ns > sim_now_ns)
+    {
+        sim_now_ns = end_ns;
+    }
+    sim_wall_ns += monotonic_ns() - start;
+}
+
+static void* sim_thread_entry(void* arg)
+{
+    SimThread* thread = (SimThread*)arg;
+    sim_self = thread;
+
+    void* result = thread->entry_func(thread->arg);
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    thread->exited.value = 1;
+    sim_release(&thread->exited, UINT32_MAX);
+    sim_runnable_drop();
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    return result;
+}
+
+eStatus osal_cond_init(OsalCond* cond)
+{
+    if(cond == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    memset(cond, 0, sizeof(SimWord));
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_cond_signal(OsalCond* cond)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_release((SimWord*)cond, 1);
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+void osal_cond_wait(OsalCond* cond, OsalMutex* mutex)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    (void)sim_block((SimWord*)cond, mutex, SIM_TIME_NEVER);
+    (void)pthread_mutex_unlock(&sim_mutex);
+    (void)pthread_mutex_lock((pthread_mutex_t*)mutex);
+}
+
+eStatus osal_cond_timedwait(OsalCond* cond, OsalMutex* mutex, uint64_t timeout_ms)
+{
+    bool released = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    uint64_t deadline = sim_now_ns + timeout_ms * 1000000ull;
+    if(sim_self != NULL)
+    {
+        released = sim_block((SimWord*)cond, mutex, deadline);
+    }
+    else
+    {
+        (void)pthread_mutex_unlock((pthread_mutex_t*)mutex);
+        sim_run_until(deadline, NULL);
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    (void)pthread_mutex_lock((pthread_mutex_t*)mutex);
+
+    return released ? eSTATUS_SUCCESSFUL : eSTATUS_TIMEOUT;
+}
+
+void osal_cond_destroy(OsalCond* cond)
+{
+    (void)cond;
+}
+
+eStatus osal_sem_init(OsalSem* sem, uint32_t count)
+{
+    if(sem == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    memset(sem, 0, sizeof(SimWord));
+    ((SimWord*)sem)->value = count;
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_sem_post(OsalSem* sem)
+{
+    SimWord* word = (SimWord*)sem;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    word->value++;
+    sim_release(word, 1);
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+eStatus osal_sem_trywait(OsalSem* sem)
+{
+    SimWord* word = (SimWord*)sem;
+    eStatus status = eSTATUS_ACTION_FAILED;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if(word->value != 0)
+    {
+        word->value--;
+        status = eSTATUS_SUCCESSFUL;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    return status;
+}
+
+void osal_sem_wait(OsalSem* sem)
+{
+    SimWord* word = (SimWord*)sem;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    while(word->value == 0)
+    {
+        (void)sim_block(word, NULL, SIM_TIME_NEVER);
+    }
+    word->value--;
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+eStatus osal_sem_timedwait(OsalSem* sem, uint64_t timeout_ms)
+{
+    SimWord* word = (SimWord*)sem;
+    eStatus status = eSTATUS_TIMEOUT;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    uint64_t deadline = sim_now_ns + timeout_ms * 1000000ull;
+    if(sim_self == NULL && word->value == 0)
+    {
+        sim_run_until(deadline, word);
+    }
+
+    bool waiting = (sim_self != NULL);
+    while(word->value == 0 && waiting)
+    {
+        waiting = sim_block(word, NULL, deadline);
+    }
+
+    // A post may land between the timeout and this thread running again
+    if(word->value != 0)
+    {
+        word->value--;
+        status = eSTATUS_SUCCESSFUL;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    return status;
+}
+
+void osal_sem_destroy(OsalSem* sem)
+{
+    (void)sem;
+}
+
+eStatus osal_event_init(OsalEvent* event)
+{
+    if(event == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    memset(event, 0, sizeof(SimWord));
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_event_set(OsalEvent* event)
+{
+    SimWord* word = (SimWord*)event;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if(word->value == 0)
+    {
+        word->value = 1;
+        sim_release(word, 1);
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+void osal_event_wait(OsalEvent* event)
+{
+    SimWord* word = (SimWord*)event;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    while(word->value == 0)
+    {
+        (void)sim_block(word, NULL, SIM_TIME_NEVER);
+    }
+    word->value = 0;
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+eStatus osal_event_timedwait(OsalEvent* event, uint64_t timeout_ms)
+{
+    SimWord* word = (SimWord*)event;
+    eStatus status = eSTATUS_TIMEOUT;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    uint64_t deadline = sim_now_ns + timeout_ms * 1000000ull;
+    if(sim_self == NULL && word->value == 0)
+    {
+        sim_run_until(deadline, word);
+    }
+
+    bool waiting = (sim_self != NULL);
+    while(word->value == 0 && waiting)
+    {
+        waiting = sim_block(word, NULL, deadline);
+    }
+
+    if(word->value != 0)
+    {
+        word->value = 0;
+        status = eSTATUS_SUCCESSFUL;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    return status;
+}
+
+void osal_event_destroy(OsalEvent* event)
+{
+    (void)event;
+}
+
+eStatus osal_thread_create_ex(OsalThread* thread, EntryFP entry_func, void* arg,
+                              const OsalThreadAttr* attr)
+{
+    if(thread == NULL || entry_func == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    uint32_t slot = 0;
+    while(slot < eOSAL_SIM_THREAD_MAX_COUNT && sim_threads[slot].used)
+    {
+        ++slot;
+    }
+    if(slot == eOSAL_SIM_THREAD_MAX_COUNT)
+    {
+        (void)pthread_mutex_unlock(&sim_mutex);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    SimThread* sim_thread = &sim_threads[slot];
+    memset(sim_thread, 0, sizeof(*sim_thread));
+    sim_thread->due_ns = SIM_TIME_NEVER;
+    sim_thread->entry_func = entry_func;
+    sim_thread->arg = arg;
+    sim_thread->used = true;
+    // Runnable from now on, so the clock can't advance before it first blocks
+    ++sim_runnable;
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    pthread_t id;
+    eStatus status = thread_create(&id, sim_thread_entry, sim_thread, attr);
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if(status == eSTATUS_SUCCESSFUL)
+    {
+        sim_thread_ids[slot] = id;
+        *((pthread_t*)thread) = id;
+    }
+    else
+    {
+        sim_thread->used = false;
+        sim_runnable_drop();
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    return status;
+}
+
+void osal_thread_join(OsalThread* thread)
+{
+    if(thread == NULL)
+    {
+        return;
+    }
+
+    pthread_t id = *((pthread_t*)thread);
+    SimThread* sim_thread = NULL;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    for(uint32_t i = 0; i < eOSAL_SIM_THREAD_MAX_COUNT && sim_thread == NULL; ++i)
+    {
+        if(sim_threads[i].used && pthread_equal(sim_thread_ids[i], id))
+        {
+            sim_thread = &sim_threads[i];
+        }
+    }
+
+    if(sim_thread != NULL && sim_self != NULL)
+    {
+        while(sim_thread->exited.value == 0)
+        {
+            (void)sim_block(&sim_thread->exited, NULL, SIM_TIME_NEVER);
+        }
+    }
+    else if(sim_thread != NULL)
+    {
+        sim_run_until(SIM_TIME_NEVER, &sim_thread->exited);
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    (void)pthread_join(id, NULL);
+
+    if(sim_thread != NULL)
+    {
+        (void)pthread_mutex_lock(&sim_mutex);
+        sim_thread->used = false;
+        (void)pthread_mutex_unlock(&sim_mutex);
+    }
+}
+
+uint64_t osal_time_now_ns(void)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    uint64_t now = sim_now_ns;
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    return now;
+}
+
+void osal_delay_us(uint64_t us)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    if(sim_self != NULL)
+    {
+        // Nothing releases the word, so this returns at the deadline
+        (void)sim_block(&sim_self->wake, NULL, sim_now_ns + us * 1000ull);
+    }
+    else
+    {
+        sim_run_until(sim_now_ns + us * 1000ull, NULL);
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    (void)__atomic_fetch_add(&delay_calls, 1, __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&delay_sleep_ns, us * 1000ull, __ATOMIC_RELAXED);
+}
+
+void osal_sim_advance_us(uint64_t us)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_run_until(sim_now_ns + us * 1000ull, NULL);
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+void osal_sim_get_stats(OsalSimStats* stats)
+{
+    if(stats != NULL)
+    {
+        (void)pthread_mutex_lock(&sim_mutex);
+        stats->now_ns = sim_now_ns;
+        stats->wall_ns = sim_wall_ns;
+        stats->timer_expirations = sim_timer_expirations;
+        stats->delay_wakeups = sim_delay_wakeups;
+        (void)pthread_mutex_unlock(&sim_mutex);
+    }
+}
+
+eStatus osal_timer_init(OsalTimer* timer, TimerArg* timer_arg)
+{
+    if(timer == NULL || timer_arg == NULL || timer_arg->handler == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    TimerContext* context = (TimerContext*)timer;
+    context->timer_arg = timer_arg;
+    context->fd = -1;
+
+    (void)pthread_mutex_lock(&timer_service_mutex);
+    (void)pthread_mutex_lock(&sim_mutex);
+    uint32_t slot = 0;
+    while(slot < eOSAL_TIMER_MAX_COUNT && timer_slots[slot] != NULL)
+    {
+        ++slot;
+    }
+    if(slot < eOSAL_TIMER_MAX_COUNT)
+    {
+        sim_timers[slot].due_ns = SIM_TIME_NEVER;
+        context->slot = slot;
+        timer_slots[slot] = context;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    (void)pthread_mutex_unlock(&timer_service_mutex);
+
+    return (slot < eOSAL_TIMER_MAX_COUNT) ? eSTATUS_SUCCESSFUL : eSTATUS_SYSTEM_ERROR;
+}
+
+eStatus osal_timer_arm(OsalTimer* timer, uint64_t ms, eTimerType type)
+{
+    if(timer == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(type != eTIMER_TYPE_ONCE && type != eTIMER_TYPE_REPEAT)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    TimerContext* context = (TimerContext*)timer;
+    (void)pthread_mutex_lock(&timer_service_mutex);
+    (void)pthread_mutex_lock(&sim_mutex);
+    SimTimer* sim_timer = &sim_timers[context->slot];
+    // As with timerfd, a zero interval disarms the timer
+    sim_timer->due_ns = (ms == 0) ? SIM_TIME_NEVER : sim_now_ns + ms * 1000000ull;
+    sim_timer->period_ns = (type == eTIMER_TYPE_REPEAT) ? ms * 1000000ull : 0;
+    sim_timer->seq = sim_seq++;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    (void)pthread_mutex_unlock(&timer_service_mutex);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void osal_timer_destroy(OsalTimer* timer)
+{
+    if(timer != NULL)
+    {
+        TimerContext* context = (TimerContext*)timer;
+
+        (void)pthread_mutex_lock(&timer_service_mutex);
+        (void)pthread_mutex_lock(&sim_mutex);
+        sim_timers[context->slot].due_ns = SIM_TIME_NEVER;
+        timer_slots[context->slot] = NULL;
+        (void)pthread_mutex_unlock(&sim_mutex);
+        (void)pthread_mutex_unlock(&timer_service_mutex);
+    }
+}
+#endif
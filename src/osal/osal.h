@@ -2,104 +2,459 @@
 #define OSAL_H
 
 /* Standard library includes */
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
 /* User library includes */
 #include "status.h"
 
+/* Storage sizes of the OSAL objects, large enough for the native objects of
+ * every supported target (checked at compile time in osal.c) */
+typedef enum eOsalStorageSize
+{
+    eOSAL_MUTEX_STORAGE_SIZE = 48,
+    eOSAL_COND_STORAGE_SIZE = 48,
+    eOSAL_THREAD_STORAGE_SIZE = 8,
+    eOSAL_TIMER_STORAGE_SIZE = 32,
+    eOSAL_SEM_STORAGE_SIZE = 8,
+    eOSAL_EVENT_STORAGE_SIZE = 8
+} eOsalStorageSize;
+
+/* The OSAL objects below are opaque: they are sized and aligned so they can be
+ * embedded by value in their owners, but only the OSAL touches their content */
+typedef union
+{
+    uint8_t storage[eOSAL_MUTEX_STORAGE_SIZE];
+    long    align;
+    void*   align_ptr;
+} OsalMutex;
+
+typedef union
+{
+    uint8_t storage[eOSAL_COND_STORAGE_SIZE];
+    long    align;
+    void*   align_ptr;
+} OsalCond;
+
+typedef union
+{
+    uint8_t storage[eOSAL_THREAD_STORAGE_SIZE];
+    long    align;
+    void*   align_ptr;
+} OsalThread;
+
+typedef union
+{
+    uint8_t storage[eOSAL_TIMER_STORAGE_SIZE];
+    long    align;
+    void*   align_ptr;
+} OsalTimer;
+
+typedef union
+{
+    uint8_t  storage[eOSAL_SEM_STORAGE_SIZE];
+    uint32_t align;
+} OsalSem;
+
+typedef union
+{
+    uint8_t  storage[eOSAL_EVENT_STORAGE_SIZE];
+    uint32_t align;
+} OsalEvent;
+
+typedef enum eThreadPolicy
+{
+    eTHREAD_POLICY_INHERIT,     // creator's policy and priority
+    eTHREAD_POLICY_OTHER,       // SCHED_OTHER
+    eTHREAD_POLICY_FIFO,        // SCHED_FIFO
+    eTHREAD_POLICY_RR           // SCHED_RR
+} eThreadPolicy;
+
+typedef struct
+{
+    uint64_t      affinity_mask;    // bit n allows CPU n, 0 allows every CPU
+    const char*   name;             // truncated to 15 characters, NULL keeps the default
+    size_t        stack_size;       // bytes, 0 keeps the default
+    eThreadPolicy policy;           // a value from @ref eThreadPolicy
+    int32_t       priority;         // 1..99 for FIFO and RR, ignored otherwise
+} OsalThreadAttr;
+
 typedef enum eTimerType
 {
     eTIMER_TYPE_ONCE,       // one-time expiration
     eTIMER_TYPE_REPEAT      // repeated intervals
 } eTimerType;
 
+/**
+ * @brief   A bump allocator over one contiguous region.
+ * @details Allocations are only released all at once by @ref osal_arena_reset
+ *          or @ref osal_arena_destroy. The fields are private to the OSAL.
+ */
+typedef struct
+{
+    uint8_t*    base;
+    const char* name;
+    size_t      size;
+    size_t      used;
+    size_t      peak;
+    uint32_t    allocations;
+    uint32_t    failed;
+    bool        sealed;
+    uint8_t     reserved[7];
+} OsalArena;
+
+typedef struct
+{
+    const char* name;
+    size_t      size;           // capacity of the region in bytes
+    size_t      used;           // bytes currently handed out
+    size_t      peak;           // highest value of used since creation
+    uint32_t    allocations;    // successful allocations
+    uint32_t    failed;         // refused allocations (full or sealed)
+    bool        sealed;
+    uint8_t     reserved[7];
+} OsalArenaStats;
+
+typedef struct
+{
+    uint64_t heap_allocations;  // allocations served by the heap
+    uint64_t heap_bytes;        // bytes requested from the heap
+    uint64_t failed;            // allocations refused or failed
+    bool     sealed;
+    uint8_t  reserved[7];
+} OsalAllocStats;
+
+typedef struct
+{
+    uint64_t calls;             // number of completed delays
+    uint64_t sleep_ns;          // total time spent sleeping
+    uint64_t spin_ns;           // total time spent busy-waiting
+    uint64_t spin_window_ns;    // calibrated busy-wait window
+} OsalDelayStats;
+
+typedef struct
+{
+    uint64_t now_ns;            // current virtual time
+    uint64_t wall_ns;           // real time spent advancing it
+    uint64_t timer_expirations; // timer handlers called
+    uint64_t delay_wakeups;     // delays and timed waits ended by the clock
+} OsalSimStats;
+
+/**
+ * @brief   OSAL initialization.
+ * @details Calibrates the delay spin window from the measured wakeup latency.
+ *          Delays requested before this call use a default window. With
+ *          OSAL_VIRTUAL_TIME there is nothing to calibrate.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ */
+eStatus osal_init(void);
+
 /**
  * @brief   Absrtact malloc.
+ * @details Served from the arena bound to the calling thread if there is one,
+ *          otherwise from the heap unless @ref osal_alloc_seal was called.
  * @param   size The number of bytes to be allocated.
  */
 void* osal_alloc(size_t size);
 
 /**
  * @brief   Absrtact free.
+ * @details Memory that belongs to an arena is released with the arena instead.
  * @param   memory A pointer to previously allocated memory.
  */
 void osal_dealloc(void* memory);
 
+/**
+ * @brief   Refuse every later heap allocation made through @ref osal_alloc.
+ * @details Meant to be called once initialization is done, so that any
+ *          allocation in steady state fails and is counted.
+ */
+void osal_alloc_seal(void);
+
+/**
+ * @brief   Reads the allocation counters of @ref osal_alloc.
+ * @param   stats A pointer to the struct to be filled.
+ */
+void osal_alloc_get_stats(OsalAllocStats* stats);
+
+/**
+ * @brief   Arena creation.
+ * @details Allocates the backing region once. At most eOSAL_ARENA_MAX_COUNT
+ *          arenas can exist at the same time.
+ * @param   arena A pointer to an uninitialized OsalArena struct.
+ * @param   size The size of the region in bytes.
+ * @param   name A name used in reports, must outlive the arena.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      arena or name are NULL or size is 0
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate the region or too many arenas exist
+ */
+eStatus osal_arena_create(OsalArena* arena, size_t size, const char* name);
+
+/**
+ * @brief   Arena allocation.
+ * @details The returned memory is aligned to eOSAL_ARENA_ALIGNMENT bytes,
+ *          enough for any scalar type including long double. An arena is
+ *          not thread safe, it is meant to be filled by one thread.
+ * @param   arena A pointer to a created arena.
+ * @param   size The number of bytes to be allocated.
+ * @returns A pointer to the memory, or NULL if the arena is full or sealed.
+ */
+void* osal_arena_alloc(OsalArena* arena, size_t size);
+
+/**
+ * @brief   Releases every allocation of an arena at once.
+ * @details The peak usage is kept.
+ * @param   arena A pointer to a created arena.
+ */
+void osal_arena_reset(OsalArena* arena);
+
+/**
+ * @brief   Refuse every later allocation from an arena.
+ * @param   arena A pointer to a created arena.
+ */
+void osal_arena_seal(OsalArena* arena);
+
+/**
+ * @brief   Accept allocations from a sealed arena again.
+ * @details For an owner that reset its arena to rebuild what it held, to be
+ *          sealed again once done.
+ * @param   arena A pointer to a created arena.
+ */
+void osal_arena_unseal(OsalArena* arena);
+
+/**
+ * @brief   Reads the usage of an arena.
+ * @param   arena A pointer to a created arena.
+ * @param   stats A pointer to the struct to be filled.
+ */
+void osal_arena_stats(const OsalArena* arena, OsalArenaStats* stats);
+
+/**
+ * @brief   Makes @ref osal_alloc on the calling thread allocate from an arena.
+ * @param   arena A pointer to a created arena, or NULL to go back to the heap.
+ */
+void osal_arena_bind(OsalArena* arena);
+
+/**
+ * @brief   Arena destroying.
+ * @details Frees the region, every allocation of the arena becomes invalid.
+ * @param   arena A pointer to a created arena.
+ */
+void osal_arena_destroy(OsalArena* arena);
+
 
 /**
  * @brief   Absrtact mutex initialization.
- * @param   mutex A pointer address at which a mutex will be constructed.
+ * @param   mutex A pointer to the storage in which a mutex will be constructed.
  */
-eStatus osal_mutex_init(void** mutex);
+eStatus osal_mutex_init(OsalMutex* mutex);
 
 /**
  * @brief   Absrtact mutex lock.
  * @param   mutex A pointer to an initialized mutex.
  */
-void osal_mutex_lock(void* mutex);
+void osal_mutex_lock(OsalMutex* mutex);
 
 /**
  * @brief   Absrtact mutex unlock.
  * @param   mutex A pointer to an initialized mutex.
  */
-void osal_mutex_unlock(void* mutex);
+void osal_mutex_unlock(OsalMutex* mutex);
 
 /**
  * @brief   Absrtact mutex destroy.
  * @param   mutex A pointer to an initialized mutex.
  */
-void osal_mutex_destroy(void* mutex);
+void osal_mutex_destroy(OsalMutex* mutex);
 
 
 /**
  * @brief   Absrtact conditional variable initialization.
- * @param   cond A pointer address at which a conditional
+ * @param   cond A pointer to the storage in which a conditional
  *          variable will be constructed.
  */
-eStatus osal_cond_init(void** cond);
+eStatus osal_cond_init(OsalCond* cond);
 
 /**
  * @brief   Absrtact conditional variable signal.
  * @param   cond A pointer to an an initialized conditional variable.
  */
-void osal_cond_signal(void* cond);
+void osal_cond_signal(OsalCond* cond);
 
 /**
  * @brief   Absrtact conditional variable wait.
  * @param   cond A pointer to an an initialized conditional variable.
  * @param   mutex A pointer to an initialized mutex.
  */
-void osal_cond_wait(void* cond, void* mutex);
+void osal_cond_wait(OsalCond* cond, OsalMutex* mutex);
+
+/**
+ * @brief   Absrtact conditional variable wait with a timeout.
+ * @details The timeout is measured on the monotonic clock. With
+ *          OSAL_VIRTUAL_TIME, a caller that was not created by the OSAL
+ *          advances the virtual clock by timeout_ms instead of waiting for
+ *          a signal.
+ * @param   cond A pointer to an an initialized conditional variable.
+ * @param   mutex A pointer to an initialized mutex.
+ * @param   timeout_ms Maximal wait in miliseconds.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      signaled (or woken spuriously)
+ * @retval  eSTATUS_TIMEOUT         timeout_ms elapsed
+ */
+eStatus osal_cond_timedwait(OsalCond* cond, OsalMutex* mutex, uint64_t timeout_ms);
 
 /**
  * @brief   Absrtact conditional variable destroy.
  * @param   cond A pointer to an an initialized conditional variable.
  */
-void osal_cond_destroy(void* cond);
+void osal_cond_destroy(OsalCond* cond);
+
+/**
+ * @brief   Counting semaphore initialization.
+ * @details The semaphore is futex based: posting only enters the kernel when
+ *          a thread is waiting, and waiting only when the count is 0.
+ * @param   sem A pointer to the storage in which a semaphore will be constructed.
+ * @param   count The initial count.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      sem is NULL
+ */
+eStatus osal_sem_init(OsalSem* sem, uint32_t count);
+
+/**
+ * @brief   Increments a semaphore, waking one waiter if there is one.
+ * @param   sem A pointer to an initialized semaphore.
+ */
+void osal_sem_post(OsalSem* sem);
+
+/**
+ * @brief   Decrements a semaphore, blocking while its count is 0.
+ * @param   sem A pointer to an initialized semaphore.
+ */
+void osal_sem_wait(OsalSem* sem);
+
+/**
+ * @brief   Decrements a semaphore, blocking while its count is 0 for up to
+ *          timeout_ms on the monotonic clock.
+ * @param   sem A pointer to an initialized semaphore.
+ * @param   timeout_ms Maximal wait in miliseconds.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      the semaphore was decremented
+ * @retval  eSTATUS_TIMEOUT         the count stayed 0 for timeout_ms
+ */
+eStatus osal_sem_timedwait(OsalSem* sem, uint64_t timeout_ms);
+
+/**
+ * @brief   Decrements a semaphore if its count isn't 0.
+ * @param   sem A pointer to an initialized semaphore.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      the count was decremented
+ * @retval  eSTATUS_ACTION_FAILED   the count is 0
+ */
+eStatus osal_sem_trywait(OsalSem* sem);
+
+/**
+ * @brief   Semaphore destroying.
+ * @param   sem A pointer to an initialized semaphore.
+ */
+void osal_sem_destroy(OsalSem* sem);
+
+/**
+ * @brief   Binary event initialization.
+ * @details The event is futex based and starts cleared. Setting it only
+ *          enters the kernel when a thread is waiting.
+ * @param   event A pointer to the storage in which an event will be constructed.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      event is NULL
+ */
+eStatus osal_event_init(OsalEvent* event);
+
+/**
+ * @brief   Sets an event, waking one waiter if there is one.
+ * @details Setting an event that is already set has no effect.
+ * @param   event A pointer to an initialized event.
+ */
+void osal_event_set(OsalEvent* event);
+
+/**
+ * @brief   Waits for an event to be set, then clears it.
+ * @param   event A pointer to an initialized event.
+ */
+void osal_event_wait(OsalEvent* event);
+
+/**
+ * @brief   Waits for an event to be set for up to timeout_ms on the monotonic
+ *          clock, then clears it.
+ * @param   event A pointer to an initialized event.
+ * @param   timeout_ms Maximal wait in miliseconds.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      the event was set
+ * @retval  eSTATUS_TIMEOUT         the event stayed clear for timeout_ms
+ */
+eStatus osal_event_timedwait(OsalEvent* event, uint64_t timeout_ms);
+
+/**
+ * @brief   Event destroying.
+ * @param   event A pointer to an initialized event.
+ */
+void osal_event_destroy(OsalEvent* event);
 
 typedef void* (*EntryFP)(void* arg);
 
 /**
  * @brief   Absrtact thread creation.
- * @param   thread A pointer address at which a thread will be constructed.
+ * @param   thread A pointer to the storage in which a thread will be constructed.
  * @param   entry_func A function pointer to the thread's function.
  * @param   arg A pointer to the arg required by entry_func.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      thread or entry_func are NULL 
- * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory or initiate thread
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't initiate thread
+ */
+eStatus osal_thread_create(OsalThread* thread, EntryFP entry_func, void* arg);
+
+/**
+ * @brief   Absrtact thread creation with scheduling attributes.
+ * @details If the process isn't allowed to use a real-time policy, the thread
+ *          is still created and inherits the creator's scheduling instead.
+ * @param   thread A pointer to the storage in which a thread will be constructed.
+ * @param   entry_func A function pointer to the thread's function.
+ * @param   arg A pointer to the arg required by entry_func.
+ * @param   attr A pointer to the thread attributes, NULL for the defaults.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      thread or entry_func are NULL
+ * @retval  eSTATUS_INVALID_VALUE   attr holds an unknown policy or an invalid priority
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't apply the attributes or initiate thread
  */
-eStatus osal_thread_create(void** thread, EntryFP entry_func, void* arg);
+eStatus osal_thread_create_ex(OsalThread* thread, EntryFP entry_func, void* arg,
+                              const OsalThreadAttr* attr);
 
 /**
  * @brief   Absrtact thread join.
+ * @details With OSAL_VIRTUAL_TIME, a caller that was not created by the OSAL
+ *          advances the virtual clock until the thread exits.
  * @param   thread A pointer to an initialized thread.
  */
-void osal_thread_join(void* thread);
+void osal_thread_join(OsalThread* thread);
+
+/**
+ * @brief   Abstract thread yield.
+ * @details Gives up the processor to another ready thread, for short waits
+ *          on a condition another thread is about to change.
+ */
+void osal_thread_yield(void);
 
 /**
  * @brief   Abstract microseconds delay.
+ * @details Sleeps until the deadline minus the calibrated spin window and
+ *          busy-waits only for the remainder. With OSAL_VIRTUAL_TIME, an OSAL
+ *          thread blocks until the virtual clock reaches the deadline and any
+ *          other caller advances the clock by us (see @ref osal_sim_advance_us).
  * @param   us Number of microseconds to wait.
  */
 void osal_delay_us(uint64_t us);
@@ -110,6 +465,39 @@ void osal_delay_us(uint64_t us);
  */
 void osal_delay_ms(uint64_t ms);
 
+/**
+ * @brief   Reads the accumulated delay counters.
+ * @param   stats A pointer to the struct to be filled.
+ */
+void osal_delay_get_stats(OsalDelayStats* stats);
+
+/**
+ * @brief   Reads the OSAL monotonic clock.
+ * @returns Nanoseconds on CLOCK_MONOTONIC, or on the virtual clock when built
+ *          with OSAL_VIRTUAL_TIME.
+ */
+uint64_t osal_time_now_ns(void);
+
+/**
+ * @brief   Advances the virtual clock.
+ * @details Runs the system in discrete-event fashion: once every OSAL thread
+ *          is blocked, the clock jumps to the earliest pending timer expiration
+ *          or delay deadline and that event is delivered, until the clock has
+ *          advanced by us. Timer handlers run on the calling thread, which must
+ *          not be an OSAL thread. Threads blocked outside the OSAL primitives
+ *          (e.g. in a system call) count as running and hold the clock back.
+ *          Without OSAL_VIRTUAL_TIME this just waits for us in real time.
+ * @param   us Number of virtual microseconds to run.
+ */
+void osal_sim_advance_us(uint64_t us);
+
+/**
+ * @brief   Reads the virtual time counters.
+ * @details Without OSAL_VIRTUAL_TIME all the counters read 0.
+ * @param   stats A pointer to the struct to be filled.
+ */
+void osal_sim_get_stats(OsalSimStats* stats);
+
 typedef void (*TimerHandlerFP)(void* arg);
 
 typedef struct
@@ -120,14 +508,21 @@ typedef struct
 
 /**
  * @brief   Abstract timer initialization.
- * @param   timer A pointer to the address which will hold a timer.
+ * @details All timers are multiplexed over timerfds by a single service thread,
+ *          started on the first call. Handlers run on that thread, one at a
+ *          time, and must not arm, disarm or destroy timers themselves. With
+ *          OSAL_VIRTUAL_TIME they run on the thread advancing the clock instead,
+ *          and with OSAL_EVENT_LOOP on the thread calling @ref osal_loop_wait.
+ * @param   timer A pointer to the storage in which a timer will be constructed.
  * @param   timer_arg A pointer to a TimerArg struct.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      timer, timer_arg or timer_arg's handler are NULL
- * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory or create the timer
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't create the timer
+ *                                  or start the service thread, or all
+ *                                  eOSAL_TIMER_MAX_COUNT timers are in use
  */
-eStatus osal_timer_init(void** timer, TimerArg* timer_arg);
+eStatus osal_timer_init(OsalTimer* timer, TimerArg* timer_arg);
 
 /**
  * @brief   Abstract timer arming.
@@ -140,22 +535,67 @@ eStatus osal_timer_init(void** timer, TimerArg* timer_arg);
  * @retval  eSTATUS_INVALID_VALUE   type is not a value from @ref eTimerType
  * @retval  eSTATUS_SYSTEM_ERROR    system couldn't configure timer interval
  */
-eStatus osal_timer_arm(void* timer, uint64_t ms, eTimerType type);
+eStatus osal_timer_arm(OsalTimer* timer, uint64_t ms, eTimerType type);
 
 /**
  * @brief   Abstract timer disarming.
+ * @details Once this returns, no expiration of the previous arming is delivered.
  * @param   timer A pointer to a timer.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      timer is NULL
  * @retval  eSTATUS_SYSTEM_ERROR    system couldn't configure timer interval
  */
-eStatus osal_timer_disarm(void* timer);
+eStatus osal_timer_disarm(OsalTimer* timer);
 
 /**
  * @brief   Abstract timer destroying.
  * @param   timer A pointer to a timer.
  */
-void osal_timer_destroy(void* timer);
+void osal_timer_destroy(OsalTimer* timer);
+
+typedef void (*LoopHandlerFP)(void* arg);
+
+/**
+ * @brief   Watch a file descriptor from the event loop.
+ * @details With OSAL_EVENT_LOOP, handler is called from @ref osal_loop_wait
+ *          for as long as fd is readable. To be called from the loop thread.
+ * @param   fd The descriptor to watch.
+ * @param   handler The function to call when fd is readable.
+ * @param   arg Passed to handler.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      handler is NULL
+ * @retval  eSTATUS_ACTION_FAILED   built without OSAL_EVENT_LOOP, or all
+ *                                  eOSAL_LOOP_FD_MAX_COUNT slots are in use
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't start the loop or watch fd
+ */
+eStatus osal_loop_add_fd(int32_t fd, LoopHandlerFP handler, void* arg);
+
+/**
+ * @brief   Stop watching a file descriptor added by @ref osal_loop_add_fd.
+ * @param   fd The watched descriptor, to be closed only after this call.
+ */
+void osal_loop_remove_fd(int32_t fd);
+
+/**
+ * @brief   Run the event loop once.
+ * @details With OSAL_EVENT_LOOP the timers have no service thread. The single
+ *          thread calling this waits for timer expirations, watched
+ *          descriptors and kicks, and runs their handlers before returning.
+ * @param   block false to only handle what is ready already.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution, also when a signal ended the wait
+ * @retval  eSTATUS_ACTION_FAILED   built without OSAL_EVENT_LOOP
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't start the loop or wait
+ */
+eStatus osal_loop_wait(bool block);
+
+/**
+ * @brief   Wake the thread blocked in @ref osal_loop_wait.
+ * @details For work handed to the loop from another thread. Does nothing
+ *          without OSAL_EVENT_LOOP.
+ */
+void osal_loop_kick(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef OSAL_CONFIG_H
+#define OSAL_CONFIG_H
+
+typedef enum eOsalConfig
+{
+    eOSAL_ARENA_MAX_COUNT = 8,
+    eOSAL_ARENA_ALIGNMENT = 16,
+    eOSAL_TIMER_MAX_COUNT = 16,
+    eOSAL_TIMER_SERVICE_MAX_EVENTS = 8,
+    eOSAL_LOOP_FD_MAX_COUNT = 4,
+    eOSAL_DELAY_CALIBRATION_SAMPLES = 16,
+    eOSAL_DELAY_CALIBRATION_SLEEP_US = 200,
+    eOSAL_DELAY_SPIN_MARGIN_US = 10,
+    eOSAL_DELAY_SPIN_WINDOW_DEFAULT_US = 100,
+    eOSAL_DELAY_SPIN_WINDOW_MAX_US = 1000,
+    eOSAL_SIM_THREAD_MAX_COUNT = 16
+} eOsalConfig;
+
+#endif
@@ -13,7 +13,8 @@ typedef enum eStatus
     eSTATUS_SYSTEM_ERROR,   /**< Calling the API caused a system error        */
     eSTATUS_ACTION_FAILED,  /**< Requested action failed                      */
     eSTATUS_INVALID_CONFIG, /**< Invalid configuration                        */
-    eSTATUS_DEVICE_ERROR    /**< Device error occurred                        */
+    eSTATUS_DEVICE_ERROR,   /**< Device error occurred                        */
+    eSTATUS_TIMEOUT         /**< Timed out before the operation could finish  */
 } eStatus;
 
 #endif
\ No newline at end of file
@@ -2,12 +2,172 @@
 
 /* Standard libraries */
 #include <stddef.h>
+#include <string.h>
+
+/* The shared tick. time_mutex guards the time events of every AO, the list
+ * of AOs that have some and the count of armed ones. tick_mutex orders the
+ * arming and disarming of the timer, it is never taken with time_mutex held */
+static OsalMutex     time_mutex;
+static OsalMutex     tick_mutex;
+static OsalTimer     tick_timer;
+static TimerArg      tick_arg;
+static ActiveObject* timed_objects[eACTIVE_OBJECT_TIMED_MAX_COUNT];
+static uint32_t      armed_count;   // time events with a due time
+static bool          time_ready;
+static bool          ticking;
+
+/* Only the AO thread writes the stats, the stores just keep readers from seeing torn values */
+static void active_count_batch(ActiveObjectStats* stats, uint32_t count)
+{
+    __atomic_store_n(&stats->events, stats->events + count, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->batches, stats->batches + 1, __ATOMIC_RELAXED);
+    if(count > stats->batch_max)
+    {
+        __atomic_store_n(&stats->batch_max, count, __ATOMIC_RELAXED);
+    }
+}
+
+/* The AO's time event that event is, NULL for any other event */
+static ActiveObjectTimeEvent* active_time_event(ActiveObject* active_object, const Event* event)
+{
+    for(uint32_t i = 0; i < eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT; ++i)
+    {
+        if(event == &active_object->time_events[i].event)
+        {
+            return &active_object->time_events[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Runs the tick while a time event is armed. Every change of armed_count is
+ * followed by a call, so the last one to take tick_mutex sees the final count.
+ * Not from the tick itself, the timer service is locked while it runs */
+static eStatus active_tick_sync(void)
+{
+    eStatus status = eSTATUS_SUCCESSFUL;
+
+    osal_mutex_lock(&tick_mutex);
+    bool needed = __atomic_load_n(&armed_count, __ATOMIC_ACQUIRE) != 0;
+    if(needed && !ticking)
+    {
+        if(osal_timer_arm(&tick_timer, eACTIVE_OBJECT_TICK_MS, eTIMER_TYPE_REPEAT))
+        {
+            status = eSTATUS_SYSTEM_ERROR;
+        }
+        else
+        {
+            __atomic_store_n(&ticking, true, __ATOMIC_RELEASE);
+        }
+    }
+    else if(!needed && ticking)
+    {
+        (void)osal_timer_disarm(&tick_timer);
+        __atomic_store_n(&ticking, false, __ATOMIC_RELEASE);
+    }
+    osal_mutex_unlock(&tick_mutex);
+
+    return status;
+}
+
+/* Takes a popped expiration off the count, false if it is stale. Being FIFO,
+ * the queue hands out the stale ones first */
+static bool active_time_event_take(ActiveObjectTimeEvent* time_event)
+{
+    osal_mutex_lock(&time_mutex);
+    time_event->queued--;
+    bool stale = time_event->stale != 0;
+    if(stale)
+    {
+        time_event->stale--;
+    }
+    osal_mutex_unlock(&time_mutex);
+
+    return !stale;
+}
+
+/* Dispatch one event posted at stamp, returns false once the AO has to stop.
+ * The queue's reference to a pooled event is dropped either way */
+static bool active_handle(ActiveObject* active_object, Event* event, uint64_t stamp)
+{
+    if(__atomic_load_n(&active_object->end_requested, __ATOMIC_ACQUIRE) || event->type == eFSM_EVENT_END)
+    {
+        util_event_pool_release(event);
+        return false;
+    }
+
+    ActiveObjectTimeEvent* time_event = active_time_event(active_object, event);
+    if(time_event != NULL)
+    {
+        if(!active_time_event_take(time_event))
+        {
+            return true;
+        }
+
+        /* The tick can't stop itself once its last one-shot fired, its AO does */
+        if(__atomic_load_n(&armed_count, __ATOMIC_ACQUIRE) == 0 && __atomic_load_n(&ticking, __ATOMIC_ACQUIRE))
+        {
+            (void)active_tick_sync();
+        }
+    }
+
+    uint64_t start = osal_time_now_ns();
+    util_trace_record_at(eTRACE_KIND_DISPATCH_BEGIN, active_object, event->type, start - stamp, start);
+    util_histogram_record(&active_object->stats.wait, start - stamp);
+    __atomic_store_n(&active_object->dispatch_ns, start, __ATOMIC_RELAXED);
+    (void)util_fsm_send_event(&active_object->active_fsm, event);
+    uint64_t end = osal_time_now_ns();
+    __atomic_store_n(&active_object->dispatch_ns, 0, __ATOMIC_RELAXED);
+    util_histogram_record(&active_object->stats.run, end - start);
+    util_trace_record_at(eTRACE_KIND_DISPATCH_END, active_object, event->type, 0, end);
+    util_event_pool_release(event);
+
+    return true;
+}
+
+/* Dispatch a batch run-to-completion, returns false once the AO has to stop */
+static bool active_dispatch(ActiveObject* active_object, void** events, const uint64_t* stamps, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        /* Urgent events posted while the batch runs go ahead of the rest of it */
+        void* urgent;
+        uint64_t urgent_stamp;
+        while(active_object->event_priorities != NULL &&
+              util_queue_pop_urgent(&active_object->event_queue, &urgent, &urgent_stamp) == eSTATUS_SUCCESSFUL)
+        {
+            active_count_batch(&active_object->stats, 1);
+            if(!active_handle(active_object, urgent, urgent_stamp))
+            {
+                for(; i < count; ++i)
+                {
+                    util_event_pool_release(events[i]);
+                }
+                return false;
+            }
+        }
+
+        if(!active_handle(active_object, events[i], stamps[i]))
+        {
+            while(++i < count)
+            {
+                util_event_pool_release(events[i]);
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
 
 /* The entry function with which we start the Active Object thread*/
 static void* active_entry(void* arg)
 {
     ActiveObject* active_object = (ActiveObject*)arg;
-    void* event;
+    void* events[eACTIVE_OBJECT_BATCH_MAX_COUNT];
+    uint64_t stamps[eACTIVE_OBJECT_BATCH_MAX_COUNT];
+    uint32_t count;
 
     /* Initialize the FSM */
     (void)util_fsm_init(&active_object->active_fsm, active_object->init_state, arg);
@@ -15,20 +175,88 @@ static void* active_entry(void* arg)
     /* FSM event loop */
     for(;;)
     {
-        (void)util_queue_pop(&active_object->event_queue, &event);
-        if(((Event*)event)->type == eFSM_EVENT_END)
+        eStatus status;
+        if(active_object->idle_hook != NULL)
         {
-            break;
+            status = util_queue_pop_batch_timeout(&active_object->event_queue, events, stamps,
+                                                  eACTIVE_OBJECT_BATCH_MAX_COUNT, &count,
+                                                  active_object->idle_timeout_ms);
+        }
+        else
+        {
+            status = util_queue_pop_batch(&active_object->event_queue, events, stamps,
+                                          eACTIVE_OBJECT_BATCH_MAX_COUNT, &count);
+        }
+
+        if(status == eSTATUS_TIMEOUT)
+        {
+            if(__atomic_load_n(&active_object->end_requested, __ATOMIC_ACQUIRE))
+            {
+                break;
+            }
+            active_object->idle_hook(active_object->idle_arg);
+            continue;
         }
 
-        (void)util_fsm_send_event(&active_object->active_fsm, event);
+        active_count_batch(&active_object->stats, count);
+        if(!active_dispatch(active_object, events, stamps, count))
+        {
+            break;
+        }
     }
 
-    /* ---- NOT REACHABLE ---- */
     return NULL;
 }
 
-eStatus util_active_object_init(ActiveObject* active_object, uint32_t capacity, StateFP init_state)
+static void active_stop(ActiveObject* active_object)
+{
+    __atomic_store_n(&active_object->stopped, true, __ATOMIC_RELEASE);
+    osal_event_set(&active_object->stopped_event);
+}
+
+/* The executor task of an AO in executor mode. Dispatches one batch per run so
+ * the other tasks on the worker get their turn, returns true while events are left */
+static bool active_run(void* arg)
+{
+    ActiveObject* active_object = (ActiveObject*)arg;
+    void* events[eACTIVE_OBJECT_BATCH_MAX_COUNT];
+    uint64_t stamps[eACTIVE_OBJECT_BATCH_MAX_COUNT];
+    uint32_t count;
+
+    if(active_object->stopped)
+    {
+        return false;
+    }
+
+    if(!active_object->started)
+    {
+        (void)util_fsm_init(&active_object->active_fsm, active_object->init_state, arg);
+        active_object->started = true;
+    }
+
+    if(util_queue_try_pop_batch(&active_object->event_queue, events, stamps,
+                                eACTIVE_OBJECT_BATCH_MAX_COUNT, &count) != eSTATUS_SUCCESSFUL)
+    {
+        /* END didn't fit in the queue, the flag is all there is */
+        if(__atomic_load_n(&active_object->end_requested, __ATOMIC_ACQUIRE))
+        {
+            active_stop(active_object);
+        }
+        return false;
+    }
+
+    active_count_batch(&active_object->stats, count);
+    if(!active_dispatch(active_object, events, stamps, count))
+    {
+        active_stop(active_object);
+        return false;
+    }
+
+    return util_queue_depth(&active_object->event_queue) != 0;
+}
+
+eStatus util_active_object_init(ActiveObject* active_object, uint32_t capacity, StateFP init_state,
+                                const ActiveObjectAttr* attr)
 {
     if(active_object == NULL || init_state == NULL)
     {
@@ -36,13 +264,82 @@ eStatus util_active_object_init(ActiveObject* active_object, uint32_t capacity,
     }
 
     active_object->init_state = init_state;
+    active_object->idle_hook = (attr != NULL) ? attr->idle_hook : NULL;
+    active_object->idle_arg = (attr != NULL) ? attr->idle_arg : NULL;
+    active_object->idle_timeout_ms = (attr != NULL) ? attr->idle_timeout_ms : 0;
+    active_object->event_priorities = (attr != NULL) ? attr->event_priorities : NULL;
+    active_object->event_priority_count = (attr != NULL) ? attr->event_priority_count : 0;
+    active_object->event_coalesced = (attr != NULL) ? attr->event_coalesced : NULL;
+    active_object->event_coalesced_count = (attr != NULL) ? attr->event_coalesced_count : 0;
+    active_object->end_requested = false;
+#ifdef OSAL_EVENT_LOOP
+    /* A single thread runs everything, every AO is a task of the loop */
+    active_object->executor = true;
+#else
+    active_object->executor = (attr != NULL) ? attr->executor : false;
+#endif
+    active_object->started = false;
+    active_object->stopped = false;
+    active_object->dispatch_ns = 0;
+    memset(active_object->time_events, 0, sizeof(active_object->time_events));
+    memset(&active_object->stats, 0, sizeof(active_object->stats));
+
+    /* Idle hooks wait on the queue, which a task never does */
+    if(active_object->executor && active_object->idle_hook != NULL)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    /* Only the locked queue has an urgent lane and can be searched for pending events */
+    if((active_object->event_priorities != NULL || active_object->event_coalesced != NULL) &&
+       attr->queue_type != eQUEUE_TYPE_LOCKED)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    eStatus status;
+    if(active_object->event_priorities != NULL)
+    {
+        status = util_queue_init_urgent(&active_object->event_queue, capacity, attr->urgent_capacity);
+    }
+    else
+    {
+        status = util_queue_init_ex(&active_object->event_queue, capacity,
+                                    (attr != NULL) ? attr->queue_type : eQUEUE_TYPE_LOCKED);
+    }
+
+    if(status != eSTATUS_SUCCESSFUL)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
 
-    if(util_queue_init(&active_object->event_queue, capacity))
+    /* Enqueue times for the wait histogram */
+    if(util_queue_enable_stamps(&active_object->event_queue))
     {
+        util_queue_delete(&active_object->event_queue);
         return eSTATUS_SYSTEM_ERROR;
     }
 
-    if(osal_thread_create(&active_object->thread, active_entry, active_object))
+    if(active_object->executor)
+    {
+        if(osal_event_init(&active_object->stopped_event))
+        {
+            util_queue_delete(&active_object->event_queue);
+            return eSTATUS_SYSTEM_ERROR;
+        }
+
+        if(util_executor_task_init(&active_object->task, active_run, active_object))
+        {
+            osal_event_destroy(&active_object->stopped_event);
+            util_queue_delete(&active_object->event_queue);
+            return eSTATUS_SYSTEM_ERROR;
+        }
+
+        /* The first run initializes the FSM, as the thread would */
+        util_executor_schedule(&active_object->task);
+    }
+    else if(osal_thread_create_ex(&active_object->thread, active_entry, active_object,
+                                  (attr != NULL) ? &attr->thread : NULL))
     {
         util_queue_delete(&active_object->event_queue);
         return eSTATUS_SYSTEM_ERROR;
@@ -58,27 +355,353 @@ eStatus util_active_object_post(ActiveObject* active_object, Event* event)
         return eSTATUS_NULL_PARAM;
     }
 
-    eStatus status = util_queue_push(&active_object->event_queue, event);
-    if(status == eSTATUS_ACTION_FAILED || status != eSTATUS_SUCCESSFUL)
+    eStatus status;
+    if(active_object->event_priorities != NULL && event->type < active_object->event_priority_count &&
+       active_object->event_priorities[event->type] == eEVENT_PRIORITY_URGENT)
+    {
+        status = util_queue_push_urgent(&active_object->event_queue, event);
+    }
+    else if(active_object->event_coalesced != NULL && event->type < active_object->event_coalesced_count &&
+            active_object->event_coalesced[event->type] && !util_event_pool_owns(event) &&
+            active_time_event(active_object, event) == NULL)
+    {
+        status = util_queue_push_coalesced(&active_object->event_queue, event);
+    }
+    else
+    {
+        status = util_queue_push(&active_object->event_queue, event);
+    }
+    util_trace_record(eTRACE_KIND_POST, active_object, event->type, (uint64_t)status);
+    if(status != eSTATUS_SUCCESSFUL)
     {
+        /* Posters usually ignore the result, the drop counters keep the loss visible */
+        uint32_t slot = (event->type < eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT) ?
+                        event->type : eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT - 1;
+        (void)__atomic_fetch_add(&active_object->stats.drops[slot], 1, __ATOMIC_RELAXED);
         return eSTATUS_ACTION_FAILED;
     }
 
+    if(active_object->executor)
+    {
+        util_executor_schedule(&active_object->task);
+    }
+
     return eSTATUS_SUCCESSFUL;
 }
 
 eStatus util_active_object_end(ActiveObject* active_object)
 {
     static Event end_event = { .type = eFSM_EVENT_END };
-    return util_active_object_post(active_object, &end_event);
+
+    eStatus status = util_active_object_post(active_object, &end_event);
+    if(status == eSTATUS_ACTION_FAILED)
+    {
+        /* The queue is full, so the AO thread is busy and will see the flag */
+        __atomic_store_n(&active_object->end_requested, true, __ATOMIC_RELEASE);
+        if(active_object->executor)
+        {
+            util_executor_schedule(&active_object->task);
+        }
+        status = eSTATUS_SUCCESSFUL;
+    }
+
+    return status;
+}
+
+eStatus util_active_object_get_stats(const ActiveObject* active_object, ActiveObjectStats* stats)
+{
+    if(active_object == NULL || stats == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    stats->events = __atomic_load_n(&active_object->stats.events, __ATOMIC_RELAXED);
+    stats->batches = __atomic_load_n(&active_object->stats.batches, __ATOMIC_RELAXED);
+    uint64_t dispatch_ns = __atomic_load_n(&active_object->dispatch_ns, __ATOMIC_RELAXED);
+    uint64_t now = (dispatch_ns != 0) ? osal_time_now_ns() : 0;
+    stats->busy_ns = (now > dispatch_ns) ? now - dispatch_ns : 0;
+    stats->batch_max = __atomic_load_n(&active_object->stats.batch_max, __ATOMIC_RELAXED);
+    stats->merged = __atomic_load_n(&active_object->event_queue.merged, __ATOMIC_RELAXED);
+    stats->depth = util_queue_depth(&active_object->event_queue);
+    stats->depth_peak = __atomic_load_n(&active_object->event_queue.peak, __ATOMIC_RELAXED);
+    for(uint32_t i = 0; i < eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT; ++i)
+    {
+        stats->drops[i] = __atomic_load_n(&active_object->stats.drops[i], __ATOMIC_RELAXED);
+    }
+    (void)util_histogram_read(&active_object->stats.wait, &stats->wait);
+    (void)util_histogram_read(&active_object->stats.run, &stats->run);
+
+    return eSTATUS_SUCCESSFUL;
 }
 
 void util_active_object_join(ActiveObject* active_object)
 {
-    osal_thread_join(active_object->thread);
+    if(active_object->executor)
+    {
+#ifdef OSAL_EVENT_LOOP
+        /* The joining thread is the loop, it runs every AO until this one stops */
+        (void)util_executor_run_until(&active_object->stopped);
+#else
+        osal_event_wait(&active_object->stopped_event);
+#endif
+    }
+    else
+    {
+        osal_thread_join(&active_object->thread);
+    }
 }
 
 void util_active_object_delete(ActiveObject* active_object)
 {
+    /* Off the tick before the AO can be initialized again */
+    if(time_ready)
+    {
+        osal_mutex_lock(&time_mutex);
+        for(uint32_t i = 0; i < eACTIVE_OBJECT_TIMED_MAX_COUNT; ++i)
+        {
+            if(timed_objects[i] == active_object)
+            {
+                timed_objects[i] = NULL;
+            }
+        }
+        for(uint32_t i = 0; i < eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT; ++i)
+        {
+            if(active_object->time_events[i].due_ns != 0)
+            {
+                active_object->time_events[i].due_ns = 0;
+                __atomic_store_n(&armed_count, armed_count - 1, __ATOMIC_RELEASE);
+            }
+        }
+        osal_mutex_unlock(&time_mutex);
+        (void)active_tick_sync();
+    }
+
+    if(active_object->executor)
+    {
+        /* The run that stopped the AO may still be finishing */
+        util_executor_task_deinit(&active_object->task);
+        osal_event_destroy(&active_object->stopped_event);
+    }
+
+    /* Events left behind by an urgent END still hold their pool references */
+    void* events[eACTIVE_OBJECT_BATCH_MAX_COUNT];
+    uint32_t count = 0;
+    while(util_queue_try_pop_batch(&active_object->event_queue, events, NULL, eACTIVE_OBJECT_BATCH_MAX_COUNT,
+                                   &count) == eSTATUS_SUCCESSFUL)
+    {
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            util_event_pool_release(events[i]);
+        }
+    }
     util_queue_delete(&active_object->event_queue);
+}
+
+/* Runs on the timer service, posts the time events that are due */
+static void active_tick(void* arg)
+{
+    (void)arg;
+    uint64_t now = osal_time_now_ns();
+
+    osal_mutex_lock(&time_mutex);
+    for(uint32_t i = 0; i < eACTIVE_OBJECT_TIMED_MAX_COUNT; ++i)
+    {
+        ActiveObject* active_object = timed_objects[i];
+        for(uint32_t j = 0; active_object != NULL && j < eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT; ++j)
+        {
+            ActiveObjectTimeEvent* time_event = &active_object->time_events[j];
+            if(time_event->due_ns == 0 || time_event->due_ns > now)
+            {
+                continue;
+            }
+
+            /* A failed post is counted in the AO's drops and the event stays
+             * due, the next tick tries again */
+            if(util_active_object_post(active_object, &time_event->event) != eSTATUS_SUCCESSFUL)
+            {
+                continue;
+            }
+            time_event->queued++;
+
+            /* Periods missed by a late tick are skipped, not posted in a burst */
+            if(time_event->period_ns != 0)
+            {
+                do
+                {
+                    time_event->due_ns += time_event->period_ns;
+                } while(time_event->due_ns <= now);
+            }
+            else
+            {
+                time_event->due_ns = 0;
+                __atomic_store_n(&armed_count, armed_count - 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+    osal_mutex_unlock(&time_mutex);
+}
+
+/* The AO's time event for type, bound to it on first use and the AO listed
+ * for the tick. NULL if the AO or the list are full. time_mutex held */
+static ActiveObjectTimeEvent* active_time_bind(ActiveObject* active_object, uint32_t type)
+{
+    ActiveObjectTimeEvent* free_event = NULL;
+    for(uint32_t i = 0; i < eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT; ++i)
+    {
+        ActiveObjectTimeEvent* time_event = &active_object->time_events[i];
+        if(time_event->bound && time_event->event.type == type)
+        {
+            return time_event;
+        }
+        if(!time_event->bound && free_event == NULL)
+        {
+            free_event = time_event;
+        }
+    }
+    if(free_event == NULL)
+    {
+        return NULL;
+    }
+
+    uint32_t slot = eACTIVE_OBJECT_TIMED_MAX_COUNT;
+    for(uint32_t i = 0; i < eACTIVE_OBJECT_TIMED_MAX_COUNT; ++i)
+    {
+        if(timed_objects[i] == active_object)
+        {
+            slot = i;
+            break;
+        }
+        if(timed_objects[i] == NULL && slot == eACTIVE_OBJECT_TIMED_MAX_COUNT)
+        {
+            slot = i;
+        }
+    }
+    if(slot == eACTIVE_OBJECT_TIMED_MAX_COUNT)
+    {
+        return NULL;
+    }
+
+    timed_objects[slot] = active_object;
+    free_event->event.type = type;
+    free_event->bound = true;
+    return free_event;
+}
+
+eStatus util_active_object_time_init(void)
+{
+    if(osal_mutex_init(&time_mutex))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    if(osal_mutex_init(&tick_mutex))
+    {
+        osal_mutex_destroy(&time_mutex);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    tick_arg.handler = active_tick;
+    tick_arg.arg = NULL;
+    if(osal_timer_init(&tick_timer, &tick_arg))
+    {
+        osal_mutex_destroy(&tick_mutex);
+        osal_mutex_destroy(&time_mutex);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    memset(timed_objects, 0, sizeof(timed_objects));
+    armed_count = 0;
+    ticking = false;
+    time_ready = true;
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus util_active_object_arm(ActiveObject* active_object, const Event* event, uint64_t ms, bool repeat)
+{
+    if(active_object == NULL || event == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+    if(ms == 0)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+    if(!time_ready)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    osal_mutex_lock(&time_mutex);
+    ActiveObjectTimeEvent* time_event = active_time_bind(active_object, event->type);
+    if(time_event != NULL)
+    {
+        if(time_event->due_ns == 0)
+        {
+            __atomic_store_n(&armed_count, armed_count + 1, __ATOMIC_RELEASE);
+        }
+        time_event->stale = time_event->queued;
+        time_event->due_ns = osal_time_now_ns() + ms * 1000000u;
+        time_event->period_ns = repeat ? ms * 1000000u : 0;
+    }
+    osal_mutex_unlock(&time_mutex);
+
+    if(time_event == NULL)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    /* Armed outside time_mutex, which the tick takes with the timer service locked */
+    return active_tick_sync();
+}
+
+eStatus util_active_object_disarm(ActiveObject* active_object, const Event* event)
+{
+    if(active_object == NULL || event == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+    if(!time_ready)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    eStatus status = eSTATUS_ACTION_FAILED;
+    osal_mutex_lock(&time_mutex);
+    for(uint32_t i = 0; i < eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT; ++i)
+    {
+        ActiveObjectTimeEvent* time_event = &active_object->time_events[i];
+        if(time_event->bound && time_event->event.type == event->type)
+        {
+            if(time_event->due_ns != 0)
+            {
+                __atomic_store_n(&armed_count, armed_count - 1, __ATOMIC_RELEASE);
+            }
+            time_event->stale = time_event->queued;
+            time_event->due_ns = 0;
+            time_event->period_ns = 0;
+            status = eSTATUS_SUCCESSFUL;
+            break;
+        }
+    }
+    osal_mutex_unlock(&time_mutex);
+
+    /* The last armed one stops the tick until the next arm */
+    if(status == eSTATUS_SUCCESSFUL)
+    {
+        (void)active_tick_sync();
+    }
+
+    return status;
+}
+
+void util_active_object_time_delete(void)
+{
+    if(time_ready)
+    {
+        time_ready = false;
+        osal_timer_destroy(&tick_timer);
+        osal_mutex_destroy(&tick_mutex);
+        osal_mutex_destroy(&time_mutex);
+    }
 }
\ No newline at end of file
@@ -3,35 +3,119 @@
 
 /* Standard libraries */
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 /* User libraries */
 #include "util/queue/queue.h"
+#include "util/histogram/histogram.h"
+#include "util/event_pool/event_pool.h"
+#include "util/trace/trace.h"
 #include "util/fsm/fsm.h"
+#include "util/executor/executor.h"
 #include "status.h"
+#include "active_object_config.h"
+
+typedef void (*IdleHookFP)(void* arg);
+
+typedef struct
+{
+    OsalThreadAttr thread;          // attributes of the AO's thread
+    IdleHookFP     idle_hook;       // run on the AO's thread when its queue stays empty, NULL for none
+    void*          idle_arg;        // passed to idle_hook
+    uint64_t       idle_timeout_ms; // how long the queue must stay empty before idle_hook runs
+    eQueueType     queue_type;      // eQUEUE_TYPE_SPSC only if a single thread posts, including END; MPSC otherwise
+    uint32_t       urgent_capacity; // slots for urgent events, used with event_priorities
+    const uint8_t* event_priorities;        // eEventPriority indexed by event type, NULL for a single FIFO
+    size_t         event_priority_count;    // entries in event_priorities, later types are normal
+    const bool*    event_coalesced;         // true for idempotent event types, indexed by event type, NULL for none
+    size_t         event_coalesced_count;   // entries in event_coalesced
+    bool           executor;        // run as a task on the executor instead of on a thread of its own
+    uint8_t        reserved[7];
+} ActiveObjectAttr;
+
+typedef struct
+{
+    uint64_t  events;       // events popped from the queue, END included
+    uint64_t  batches;      // queue drains that returned events, events / batches is the average batch size
+    uint64_t  busy_ns;      // how long the handler running when the stats were read has been at it, 0 between events
+    uint32_t  batch_max;    // most events returned by a single drain
+    uint32_t  merged;       // posts of idempotent events merged into a pending one
+    uint32_t  depth;        // events queued when the stats were read
+    uint32_t  depth_peak;   // most events queued at once, to size the queue capacity
+    uint32_t  drops[eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT];   // failed posts by event type, the last entry also counts the later types
+    Histogram wait;         // ns from the post to the start of the handler
+    Histogram run;          // ns spent in the handler
+} ActiveObjectStats;
+
+/* Posted by the shared tick, the fields are private to the AO */
+typedef struct
+{
+    Event    event;         // what the AO gets, first so that the queue holds the time event itself
+    uint32_t queued;        // expirations in the AO's queue
+    uint32_t stale;         // the oldest of those, from before the last arm or disarm
+    bool     bound;         // event.type is set
+    uint8_t  reserved[3];
+    uint64_t due_ns;        // next expiration, 0 when disarmed
+    uint64_t period_ns;     // 0 for a one-time event
+} ActiveObjectTimeEvent;
 
 typedef struct
 {
-    void*   thread;
-    Queue   event_queue;
-    FSM     active_fsm;
-    StateFP init_state;
+    OsalThread thread;
+    Queue      event_queue;
+    FSM        active_fsm;
+    StateFP    init_state;
+    IdleHookFP idle_hook;
+    void*      idle_arg;
+    uint64_t   idle_timeout_ms;
+    const uint8_t* event_priorities;
+    size_t     event_priority_count;
+    const bool* event_coalesced;
+    size_t     event_coalesced_count;
+    ExecutorTask task;
+    OsalEvent  stopped_event;
+    bool       end_requested;
+    bool       executor;
+    bool       started;
+    bool       stopped;
+    uint8_t    reserved[4];
+    uint64_t   dispatch_ns;     // start of the handler call in progress, 0 if none
+    ActiveObjectTimeEvent time_events[eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT];
+    ActiveObjectStats stats;
 } ActiveObject;
 
 /**
  * @brief   Initialize an Active Object.
  * @details Initializes a queue and creates a thread for the Active Object.
+ *          With attr->executor set no thread is created, the AO runs as a task
+ *          on the executor, which must be running. Each run dispatches a
+ *          single batch, run-to-completion, then leaves the worker to the
+ *          next task. Such an AO can't have an idle hook. With
+ *          OSAL_EVENT_LOOP every AO runs this way, from the single thread
+ *          that joins them.
  * @param   active_object A pointer to an uninitialized ActiveObject struct.
  * @param   capacity The number of slots to be in the AO's queue.
  * @param   init_state A function pointer to the initial FSM state.
+ * @param   attr A pointer to the AO's attributes, NULL for the defaults.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      active_object or init_state are NULL
- * @retval  eSTATUS_SYSTEM_ERROR    thread or queue initalization failed
+ * @retval  eSTATUS_INVALID_VALUE   event priorities or coalescing were given for a lock-free queue type,
+ *                                  or an idle hook for the executor
+ * @retval  eSTATUS_SYSTEM_ERROR    thread, task or queue initalization failed
  */
-eStatus util_active_object_init(ActiveObject* active_object, uint32_t capacity, StateFP init_state);
+eStatus util_active_object_init(ActiveObject* active_object, uint32_t capacity, StateFP init_state,
+                                const ActiveObjectAttr* attr);
 
 /**
  * @brief   Send an event to an Active Object.
+ * @details Urgent events, per the AO's event priorities, are dispatched before
+ *          the normal events already queued, in the order they were posted.
+ *          Idempotent events, per the AO's event coalescing, are merged into
+ *          the same event if it is still pending instead of taking a slot.
+ *          A pooled event is never merged, the caller's reference moves to the
+ *          queue on success and the AO releases it once the event is handled.
  * @param   active_object A pointer to an initialized ActiveObject struct.
  * @param   event An event from @ref eFSMEvent (to be expanded for practical use).
  * @returns A value from @ref eStatus.
@@ -43,24 +127,102 @@ eStatus util_active_object_post(ActiveObject* active_object, Event* event);
 
 /**
  * @brief   Move to the END state of an Active Object.
+ * @details Posts an END event so the events already queued are handled first,
+ *          unless the AO's event priorities make END urgent. If the queue is
+ *          full, the AO stops when it pops the next event and the events left
+ *          in the queue are dropped.
  * @param   active_object A pointer to an initialized ActiveObject struct.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      active_object is NULL
- * @retval  eSTATUS_ACTION_FAILED   thread or queue action failed
  */
 eStatus util_active_object_end(ActiveObject* active_object);
 
+/**
+ * @brief   Read the queue and dispatch statistics of an Active Object.
+ * @details The AO thread drains up to eACTIVE_OBJECT_BATCH_MAX_COUNT events
+ *          at a time and dispatches them run-to-completion. The counters are
+ *          read one by one, so they may be an event apart if the AO runs.
+ *          Every post is stamped, so the wait histogram covers the time in
+ *          the queue and behind the earlier events of the same batch. A
+ *          growing busy_ns tells a handler that is stuck.
+ * @param   active_object A pointer to an initialized ActiveObject struct.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      active_object or stats are NULL
+ */
+eStatus util_active_object_get_stats(const ActiveObject* active_object, ActiveObjectStats* stats);
+
 /**
  * @brief   Wait for an Active Object to stop.
+ * @details With OSAL_EVENT_LOOP the caller runs the event loop, and so every
+ *          AO, timer and watched descriptor, until the AO stops.
  * @param   active_object A pointer to an initialized ActiveObject struct.
  */
 void util_active_object_join(ActiveObject* active_object);
 
 /**
  * @brief   Free an Active Object.
+ * @details Pooled events still in the queue, such as the ones an urgent END
+ *          overtook, are released.
  * @param   active_object A pointer to an initialized ActiveObject struct.
  */
 void util_active_object_delete(ActiveObject* active_object);
 
+/**
+ * @brief   Start the shared tick that serves the time events of every AO.
+ * @details Must be called once before any time event is armed. The tick is
+ *          an OSAL timer of eACTIVE_OBJECT_TICK_MS. It runs while a time
+ *          event is armed, and stops with the last one disarmed, deleted or
+ *          dispatched after firing once.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_SYSTEM_ERROR    mutex or timer initialization failed
+ */
+eStatus util_active_object_time_init(void);
+
+/**
+ * @brief   Have an event posted to an Active Object after a delay.
+ * @details Only the event's type is posted, from a time event the AO owns,
+ *          on the first tick past the delay. Arming an event type that is
+ *          already armed restarts it. Expirations still queued from an
+ *          earlier arming are dropped instead of being dispatched, so the
+ *          AO never gets a timeout armed by a state it has left. An
+ *          expiration the full queue refuses is counted in the drops and
+ *          posted again on the next tick.
+ * @param   active_object A pointer to an initialized ActiveObject struct.
+ * @param   event The event to be posted, its type picks the time event.
+ * @param   ms The delay in milliseconds, and the period if repeat is set.
+ * @param   repeat true to post the event every ms until disarmed.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      active_object or event are NULL
+ * @retval  eSTATUS_INVALID_VALUE   ms is 0
+ * @retval  eSTATUS_ACTION_FAILED   the tick isn't running, the AO already has
+ *                                  eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT event types
+ *                                  or eACTIVE_OBJECT_TIMED_MAX_COUNT AOs have time events
+ * @retval  eSTATUS_SYSTEM_ERROR    the tick couldn't be armed
+ */
+eStatus util_active_object_arm(ActiveObject* active_object, const Event* event, uint64_t ms, bool repeat);
+
+/**
+ * @brief   Cancel a time event.
+ * @details Once this returns the event is neither posted again nor
+ *          dispatched from an expiration already queued.
+ * @param   active_object A pointer to an initialized ActiveObject struct.
+ * @param   event An event given to @ref util_active_object_arm, by type.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      active_object or event are NULL
+ * @retval  eSTATUS_ACTION_FAILED   the tick isn't running or the event type was never armed
+ */
+eStatus util_active_object_disarm(ActiveObject* active_object, const Event* event);
+
+/**
+ * @brief   Stop the shared tick.
+ * @details After the AOs with time events are deleted.
+ */
+void util_active_object_time_delete(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef UTIL_ACTIVE_OBJECT_CONFIG_H
+#define UTIL_ACTIVE_OBJECT_CONFIG_H
+
+typedef enum eActiveObjectConfig
+{
+    eACTIVE_OBJECT_BATCH_MAX_COUNT = 8,
+    eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT = 16,
+    eACTIVE_OBJECT_TIME_EVENT_MAX_COUNT = 2,    // event types an AO can arm
+    eACTIVE_OBJECT_TIMED_MAX_COUNT = 16,        // AOs with time events
+    eACTIVE_OBJECT_TICK_MS = 10                 // period of the shared tick, time events are late by up to this
+} eActiveObjectConfig;
+
+#endif
@@ -6,6 +6,8 @@
 
 /* User library includes */
 #include "util/event_bus/event_bus_config.h"
+#include "util/event_pool/event_pool.h"
+#include "util/trace/trace.h"
 #include "util/log/log.h"
 #include "osal/osal.h"
 
@@ -19,9 +21,118 @@ typedef struct
     uint8_t         reserved[7];
 } Subscription;
 
+enum { eROUTE_KEY_COUNT = eAO_COUNT * eEVENT_BUS_MAX_EVENT_TYPES };
+
+typedef struct
+{
+    EventBusPostFP  post_fn;
+    Event*          event;
+    uint32_t        module;
+    uint32_t        reserved;
+} Route;
+
+/* A snapshot of the subscriptions indexed by route key. The routes of a key
+ * are routes[start[key]] up to routes[start[key + 1]], in subscription order.
+ * readers counts the publishers currently walking the snapshot */
+typedef struct
+{
+    uint32_t        readers;
+    uint16_t        start[eROUTE_KEY_COUNT + 1];
+    uint8_t         reserved[2];
+    Route           routes[eEVENT_BUS_MAX_SUBSCRIPTIONS];
+} RouteTable;
+
 static Subscription subscriptions[eEVENT_BUS_MAX_SUBSCRIPTIONS];
 static uint32_t     subscription_count;
-static void*        bus_mutex;
+static OsalMutex    bus_mutex;
+
+/* Publishers read route_current without the bus mutex. Writers hold the mutex,
+ * build the other table and swap it in, then wait for the publishers still on
+ * the previous table before it can be rebuilt (read-copy-update) */
+static RouteTable   route_tables[2];
+static RouteTable*  route_current = &route_tables[0];
+static OsalEvent    grace_event;    // set by the last publisher to leave a table that was swapped out
+
+static uint32_t route_key(eActiveObjectID ao_id, uint32_t event_type)
+{
+    return (uint32_t)ao_id * eEVENT_BUS_MAX_EVENT_TYPES + event_type;
+}
+
+static void route_table_build(RouteTable* table)
+{
+    // Count the subscriptions of each key, then turn the counts into running totals
+    for(uint32_t key = 0; key <= eROUTE_KEY_COUNT; key++)
+    {
+        table->start[key] = 0;
+    }
+    for(uint32_t i = 0; i < eEVENT_BUS_MAX_SUBSCRIPTIONS; i++)
+    {
+        if(subscriptions[i].active)
+        {
+            table->start[route_key(subscriptions[i].ao_id, subscriptions[i].event->type)]++;
+        }
+    }
+    for(uint32_t key = 1; key <= eROUTE_KEY_COUNT; key++)
+    {
+        table->start[key] = (uint16_t)(table->start[key] + table->start[key - 1]);
+    }
+
+    // Filling each key from its end backwards leaves start[key] at its first route
+    for(uint32_t i = eEVENT_BUS_MAX_SUBSCRIPTIONS; i-- > 0;)
+    {
+        if(subscriptions[i].active)
+        {
+            uint32_t key = route_key(subscriptions[i].ao_id, subscriptions[i].event->type);
+            Route* route = &table->routes[--table->start[key]];
+            route->post_fn = subscriptions[i].post_fn;
+            route->event = subscriptions[i].event;
+            route->module = subscriptions[i].module;
+        }
+    }
+}
+
+/* Called with bus_mutex held */
+static void route_table_update(void)
+{
+    RouteTable* previous = route_current;
+    RouteTable* next = (previous == &route_tables[0]) ? &route_tables[1] : &route_tables[0];
+
+    route_table_build(next);
+    __atomic_store_n(&route_current, next, __ATOMIC_SEQ_CST);
+
+    // Grace period, the publishers that picked the previous table are done with it.
+    // Sleep rather than yield, a real-time writer would never let them run on one core
+    while(__atomic_load_n(&previous->readers, __ATOMIC_SEQ_CST) != 0)
+    {
+        osal_event_wait(&grace_event);
+    }
+}
+
+static void route_table_release(RouteTable* table)
+{
+    // Both sequentially consistent: either the writer sees this reader gone or it sees the swap
+    if(__atomic_fetch_sub(&table->readers, 1, __ATOMIC_SEQ_CST) == 1 &&
+       __atomic_load_n(&route_current, __ATOMIC_SEQ_CST) != table)
+    {
+        osal_event_set(&grace_event);
+    }
+}
+
+static RouteTable* route_table_acquire(void)
+{
+    for(;;)
+    {
+        RouteTable* table = __atomic_load_n(&route_current, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&table->readers, 1, __ATOMIC_SEQ_CST);
+
+        // Still current once counted, so a writer waits for this reader before rebuilding it
+        if(__atomic_load_n(&route_current, __ATOMIC_SEQ_CST) == table)
+        {
+            return table;
+        }
+        route_table_release(table);
+    }
+}
 
 eStatus util_event_bus_init(void)
 {
@@ -32,12 +143,19 @@ eStatus util_event_bus_init(void)
     {
         subscriptions[i].active = false;
     }
+    route_table_build(route_current);
 
     if(osal_mutex_init(&bus_mutex))
     {
         return eSTATUS_SYSTEM_ERROR;
     }
 
+    if(osal_event_init(&grace_event))
+    {
+        osal_mutex_destroy(&bus_mutex);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
     return eSTATUS_SUCCESSFUL;
 }
 
@@ -54,13 +172,18 @@ eStatus util_event_bus_subscribe(eActiveObjectID ao_id, EventBusPostFP post_fn,
         return eSTATUS_NULL_PARAM;
     }
 
+    if(event->type >= eEVENT_BUS_MAX_EVENT_TYPES)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
     LOG_DEBUG("Active object ID %d subscribed to the event bus with event %u",
                 ao_id, event->type);
-    osal_mutex_lock(bus_mutex);
+    osal_mutex_lock(&bus_mutex);
 
     if(subscription_count >= eEVENT_BUS_MAX_SUBSCRIPTIONS)
     {
-        osal_mutex_unlock(bus_mutex);
+        osal_mutex_unlock(&bus_mutex);
         return eSTATUS_ACTION_FAILED;
     }
 
@@ -75,46 +198,128 @@ eStatus util_event_bus_subscribe(eActiveObjectID ao_id, EventBusPostFP post_fn,
             subscriptions[i].event = event;
             subscriptions[i].active = true;
             subscription_count++;
+            route_table_update();
 
-            osal_mutex_unlock(bus_mutex);
+            osal_mutex_unlock(&bus_mutex);
             return eSTATUS_SUCCESSFUL;
         }
     }
 
-    osal_mutex_unlock(bus_mutex);
+    osal_mutex_unlock(&bus_mutex);
     return eSTATUS_ACTION_FAILED;
 }
 
-eStatus util_event_bus_publish(eActiveObjectID ao_id, uint32_t event_type)
+/* Posts data to every subscriber of the key, or each subscriber's stored event
+ * when data is NULL. Each queued copy of data holds its own reference */
+static eStatus bus_dispatch(eActiveObjectID ao_id, uint32_t event_type, Event* data)
+{
+    RouteTable* table = route_table_acquire();
+    uint32_t key = route_key(ao_id, event_type);
+    uint32_t first = table->start[key];
+    uint32_t last = table->start[key + 1];
+
+    util_trace_record(eTRACE_KIND_PUBLISH, data, event_type, (uint64_t)ao_id);
+    for(uint32_t r = first; r < last; r++)
+    {
+        if(data == NULL)
+        {
+            /* Call the subscriber's layer's post function with its stored event */
+            table->routes[r].post_fn(table->routes[r].module, table->routes[r].event);
+        }
+        else
+        {
+            util_event_pool_retain(data);
+            if(table->routes[r].post_fn(table->routes[r].module, data) != eSTATUS_SUCCESSFUL)
+            {
+                util_event_pool_release(data);
+            }
+        }
+    }
+
+    route_table_release(table);
+
+    return (first != last) ? eSTATUS_SUCCESSFUL : eSTATUS_ACTION_FAILED;
+}
+
+eStatus util_event_bus_unsubscribe(eActiveObjectID ao_id, EventBusPostFP post_fn,
+                                    uint32_t module, Event* event)
 {
     if(ao_id >= eAO_COUNT)
     {
         return eSTATUS_INVALID_VALUE;
     }
 
-    bool matched = false;
+    if(post_fn == NULL || event == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(event->type >= eEVENT_BUS_MAX_EVENT_TYPES)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
 
-    osal_mutex_lock(bus_mutex);
+    osal_mutex_lock(&bus_mutex);
 
     for(uint32_t i = 0; i < eEVENT_BUS_MAX_SUBSCRIPTIONS; i++)
     {
-        if(subscriptions[i].active && subscriptions[i].ao_id == ao_id &&
-           subscriptions[i].event->type == event_type)
+        if(subscriptions[i].active && subscriptions[i].ao_id == ao_id && subscriptions[i].post_fn == post_fn &&
+           subscriptions[i].module == module && subscriptions[i].event == event)
         {
-            /* Call the subscriber's layer's post function with its stored event */
-            subscriptions[i].post_fn(subscriptions[i].module, subscriptions[i].event);
-            matched = true;
+            subscriptions[i].active = false;
+            subscription_count--;
+            // Returns once no publisher can reach the subscription anymore
+            route_table_update();
+
+            osal_mutex_unlock(&bus_mutex);
+            LOG_DEBUG("Active object ID %d unsubscribed from the event bus with event %u",
+                        ao_id, event->type);
+            return eSTATUS_SUCCESSFUL;
         }
     }
 
-    osal_mutex_unlock(bus_mutex);
+    osal_mutex_unlock(&bus_mutex);
+
+    return eSTATUS_ACTION_FAILED;
+}
+
+eStatus util_event_bus_publish(eActiveObjectID ao_id, uint32_t event_type)
+{
+    if(ao_id >= eAO_COUNT || event_type >= eEVENT_BUS_MAX_EVENT_TYPES)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    return bus_dispatch(ao_id, event_type, NULL);
+}
+
+eStatus util_event_bus_publish_data(eActiveObjectID ao_id, Event* event)
+{
+    if(event == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(!util_event_pool_owns(event))
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    eStatus status = eSTATUS_INVALID_VALUE;
+    if(ao_id < eAO_COUNT && event->type < eEVENT_BUS_MAX_EVENT_TYPES)
+    {
+        status = bus_dispatch(ao_id, event->type, event);
+    }
+
+    // The publisher's reference, the last dispatcher returns the event to the pool
+    util_event_pool_release(event);
 
-    return matched ? eSTATUS_SUCCESSFUL : eSTATUS_ACTION_FAILED;
+    return status;
 }
 
 void util_event_bus_delete(void)
 {
-    osal_mutex_lock(bus_mutex);
+    osal_mutex_lock(&bus_mutex);
 
     for(uint32_t i = 0; i < eEVENT_BUS_MAX_SUBSCRIPTIONS; i++)
     {
@@ -122,7 +327,9 @@ void util_event_bus_delete(void)
     }
 
     subscription_count = 0;
+    route_table_update();
 
-    osal_mutex_unlock(bus_mutex);
-    osal_mutex_destroy(bus_mutex);
+    osal_mutex_unlock(&bus_mutex);
+    osal_event_destroy(&grace_event);
+    osal_mutex_destroy(&bus_mutex);
 }
\ No newline at end of file
@@ -21,14 +21,16 @@ typedef eStatus (*EventBusPostFP)(uint32_t module, Event* event);
  * @details Must be called once before any subscribe or publish calls.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
- * @retval  eSTATUS_SYSTEM_ERROR    mutex initialization failed
+ * @retval  eSTATUS_SYSTEM_ERROR    mutex or event initialization failed
  */
 eStatus util_event_bus_init(void);
 
 /**
  * @brief   Subscribe to an event on the bus.
  * @details Registers a callback to be invoked when the specified event
- *          is published for the given Active Object module.
+ *          is published for the given Active Object module. Publishers that
+ *          are running keep the previous subscriptions, subscribing waits
+ *          until they are done with them. Must not be called from a post_fn.
  * @param   ao_id The Active Object module ID from @ref eActiveObjectID.
  * @param   post_fn A function pointer to the module's post function.
  * @param   module The index of the AO module in its layer (doesn't check for
@@ -37,26 +39,68 @@ eStatus util_event_bus_init(void);
  *          on publish. Must remain valid for the lifetime of the subscription.
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
- * @retval  eSTATUS_INVALID_VALUE   ao_id is out of bounds
+ * @retval  eSTATUS_INVALID_VALUE   ao_id or the event type are out of bounds
  * @retval  eSTATUS_NULL_PARAM      post_fn or event are NULL
- * @retval  eSTATUS_ACTION_FAILED   subscription table is full
+ * @retval  eSTATUS_ACTION_FAILED   subscription table is full, see
+ *                                  @ref util_event_bus_unsubscribe
  */
 eStatus util_event_bus_subscribe(eActiveObjectID ao_id, EventBusPostFP post_fn,
                                     uint32_t module, Event* event);
 
+/**
+ * @brief   Cancel a subscription made with @ref util_event_bus_subscribe.
+ * @details Frees the subscription's slot for later subscriptions. Publishes
+ *          to a key left without subscriptions cost only the route lookup.
+ *          Publishers that are running may still post through the
+ *          subscription, unsubscribing waits until they are done, after
+ *          which it is never used again. Must not be called from a post_fn.
+ * @param   ao_id The Active Object module ID given on subscription.
+ * @param   post_fn The post function given on subscription.
+ * @param   module The module index given on subscription.
+ * @param   event The event given on subscription.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   ao_id or the event type are out of bounds
+ * @retval  eSTATUS_NULL_PARAM      post_fn or event are NULL
+ * @retval  eSTATUS_ACTION_FAILED   no such subscription
+ */
+eStatus util_event_bus_unsubscribe(eActiveObjectID ao_id, EventBusPostFP post_fn,
+                                    uint32_t module, Event* event);
+
 /**
  * @brief   Publish an event through the bus.
  * @details Looks up all subscriptions matching the given parameter pair and
  *          invokes each subscriber's post function with its stored event pointer.
+ *          The lookup is a routing table access on the current snapshot of the
+ *          subscriptions and doesn't take a lock, so publishers don't block
+ *          each other.
  * @param   ao_id The target Active Object module identifier from @ref eActiveObjectID.
  * @param   event_type The event type to publish (from a module's event enum).
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution, at least one subscriber notified
- * @retval  eSTATUS_INVALID_VALUE   ao_id is out of bounds
+ * @retval  eSTATUS_INVALID_VALUE   ao_id or event_type are out of bounds
  * @retval  eSTATUS_ACTION_FAILED   no matching subscription found
  */
 eStatus util_event_bus_publish(eActiveObjectID ao_id, uint32_t event_type);
 
+/**
+ * @brief   Publish an event that carries a payload through the bus.
+ * @details Posts the same pooled event to all subscriptions matching ao_id and
+ *          the event's type, instead of their stored events, without copying
+ *          it. Each subscriber's queue holds a reference of its own, which
+ *          its Active Object releases once the event is handled. The caller's
+ *          reference is consumed in every case but a NULL or unpooled event.
+ * @param   ao_id The target Active Object module identifier from @ref eActiveObjectID.
+ * @param   event A pointer to an event from @ref util_event_pool_alloc, with
+ *          its payload filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution, at least one subscriber notified
+ * @retval  eSTATUS_NULL_PARAM      event is NULL
+ * @retval  eSTATUS_INVALID_VALUE   event is not from the pool, ao_id or its type are out of bounds
+ * @retval  eSTATUS_ACTION_FAILED   no matching subscription found
+ */
+eStatus util_event_bus_publish_data(eActiveObjectID ao_id, Event* event);
+
 /**
  * @brief   Destroy the event bus.
  * @details Deactivates all subscriptions and frees resources.
@@ -3,7 +3,8 @@
 
 typedef enum eEventBusConfig
 {
-    eEVENT_BUS_MAX_SUBSCRIPTIONS = 32
+    eEVENT_BUS_MAX_SUBSCRIPTIONS = 32,
+    eEVENT_BUS_MAX_EVENT_TYPES = 16
 } eEventBusConfig;
 
 #endif
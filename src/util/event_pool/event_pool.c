@@ -0,0 +1,117 @@
+#include "event_pool.h"
+
+/* Standard library includes */
+#include <stddef.h>
+
+typedef struct
+{
+    Event       event;      // first, so an Event* converts back to its block
+    uint32_t    refs;
+    uint64_t    payload[eEVENT_POOL_PAYLOAD_SIZE / sizeof(uint64_t)];
+} EventBlock;
+
+/* Free blocks form a stack linked by index (Treiber stack). The head packs
+ * the top index in its low half and a tag in its high half, bumped on every
+ * change, so a pop can't succeed on a head that was popped and pushed back */
+static EventBlock   blocks[eEVENT_POOL_BLOCK_COUNT];
+static uint32_t     free_next[eEVENT_POOL_BLOCK_COUNT];
+static uint64_t     free_head;
+static uint32_t     free_count;
+
+static uint64_t pool_head(uint64_t head, uint32_t index)
+{
+    return (((head >> 32) + 1) << 32) | index;
+}
+
+static EventBlock* pool_block(const Event* event)
+{
+    uintptr_t address = (uintptr_t)event;
+    uintptr_t first = (uintptr_t)&blocks[0];
+
+    if(event == NULL || address < first || address >= (uintptr_t)&blocks[eEVENT_POOL_BLOCK_COUNT] ||
+       (address - first) % sizeof(EventBlock) != 0)
+    {
+        return NULL;
+    }
+
+    return &blocks[(address - first) / sizeof(EventBlock)];
+}
+
+void util_event_pool_init(void)
+{
+    for(uint32_t i = 0; i < eEVENT_POOL_BLOCK_COUNT; ++i)
+    {
+        blocks[i].refs = 0;
+        free_next[i] = i + 1;
+    }
+    free_count = eEVENT_POOL_BLOCK_COUNT;
+    __atomic_store_n(&free_head, pool_head(free_head, 0), __ATOMIC_RELEASE);
+}
+
+Event* util_event_pool_alloc(uint32_t type)
+{
+    uint64_t head = __atomic_load_n(&free_head, __ATOMIC_ACQUIRE);
+    uint32_t index;
+
+    do
+    {
+        index = (uint32_t)head;
+        if(index >= eEVENT_POOL_BLOCK_COUNT)
+        {
+            return NULL;
+        }
+    } while(!__atomic_compare_exchange_n(&free_head, &head,
+                                         pool_head(head, __atomic_load_n(&free_next[index], __ATOMIC_RELAXED)),
+                                         true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+    __atomic_fetch_sub(&free_count, 1, __ATOMIC_RELAXED);
+    blocks[index].event.type = type;
+    blocks[index].refs = 1;
+
+    return &blocks[index].event;
+}
+
+void* util_event_pool_payload(Event* event)
+{
+    EventBlock* block = pool_block(event);
+    return (block != NULL) ? block->payload : NULL;
+}
+
+bool util_event_pool_owns(const Event* event)
+{
+    return pool_block(event) != NULL;
+}
+
+void util_event_pool_retain(Event* event)
+{
+    EventBlock* block = pool_block(event);
+    if(block != NULL)
+    {
+        __atomic_fetch_add(&block->refs, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void util_event_pool_release(Event* event)
+{
+    EventBlock* block = pool_block(event);
+    if(block == NULL || __atomic_fetch_sub(&block->refs, 1, __ATOMIC_ACQ_REL) != 1)
+    {
+        return;
+    }
+
+    // Counted before it can be taken again, so the count never wraps below zero
+    __atomic_fetch_add(&free_count, 1, __ATOMIC_RELAXED);
+
+    uint32_t index = (uint32_t)(block - blocks);
+    uint64_t head = __atomic_load_n(&free_head, __ATOMIC_RELAXED);
+    do
+    {
+        __atomic_store_n(&free_next[index], (uint32_t)head, __ATOMIC_RELAXED);
+    } while(!__atomic_compare_exchange_n(&free_head, &head, pool_head(head, index),
+                                         true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+uint32_t util_event_pool_available(void)
+{
+    return __atomic_load_n(&free_count, __ATOMIC_RELAXED);
+}
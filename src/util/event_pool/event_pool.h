@@ -0,0 +1,73 @@
+#ifndef UTIL_EVENT_POOL_H
+#define UTIL_EVENT_POOL_H
+
+/* Standard library includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* User library includes */
+#include "util/event_pool/event_pool_config.h"
+#include "util/fsm/fsm.h"
+
+/*
+    Fixed-size pool of events that carry a payload of up to
+    eEVENT_POOL_PAYLOAD_SIZE bytes. A pooled event is reference counted, so
+    the same buffer can be handed to several Active Objects, and returns to
+    the pool when its last reference is released. Taking and returning
+    events is lock-free and can be done from any thread.
+    The release and payload functions accept any Event and do nothing for
+    events that are not from the pool, such as static events.
+*/
+
+/**
+ * @brief   Initialize the event pool.
+ * @details Must be called once before any event is taken, every block is free
+ *          afterwards.
+ */
+void util_event_pool_init(void);
+
+/**
+ * @brief   Take an event from the pool.
+ * @details The event is returned holding one reference, owned by the caller.
+ * @param   type The event type.
+ * @returns A pointer to the event, NULL if the pool is exhausted.
+ */
+Event* util_event_pool_alloc(uint32_t type);
+
+/**
+ * @brief   Get the payload of a pooled event.
+ * @param   event A pointer to an Event.
+ * @returns A pointer to eEVENT_POOL_PAYLOAD_SIZE bytes aligned for any
+ *          scalar type, NULL if event is not from the pool.
+ */
+void* util_event_pool_payload(Event* event);
+
+/**
+ * @brief   Check whether an event was taken from the pool.
+ * @param   event A pointer to an Event.
+ * @returns true if event is a pooled event.
+ */
+bool util_event_pool_owns(const Event* event);
+
+/**
+ * @brief   Add a reference to a pooled event.
+ * @details The caller must already hold a reference.
+ * @param   event A pointer to an Event, ignored if not from the pool.
+ */
+void util_event_pool_retain(Event* event);
+
+/**
+ * @brief   Drop a reference to a pooled event.
+ * @details The last reference returns the event to the pool, it must not be
+ *          used by the caller afterwards.
+ * @param   event A pointer to an Event, ignored if not from the pool.
+ */
+void util_event_pool_release(Event* event);
+
+/**
+ * @brief   Count the free events of the pool.
+ * @returns The number of events that can be taken.
+ */
+uint32_t util_event_pool_available(void);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef UTIL_EVENT_POOL_CONFIG_H
+#define UTIL_EVENT_POOL_CONFIG_H
+
+typedef enum eEventPoolConfig
+{
+    eEVENT_POOL_BLOCK_COUNT = 32,
+    eEVENT_POOL_PAYLOAD_SIZE = 24   // bytes, a multiple of 8
+} eEventPoolConfig;
+
+#endif
@@ -0,0 +1,437 @@
+#include "executor.h"
+
+/* Standard library includes */
+#include <stddef.h>
+
+/* User library includes */
+#include "osal/osal.h"
+
+enum
+{
+    eTASK_PENDING = 1u << 0,    // scheduled since its current run started
+    eTASK_ACTIVE  = 1u << 1,    // queued or running, owned by the executor
+    eTASK_RETIRED = 1u << 2     // deinitialized, kept ACTIVE so that no schedule queues it
+};
+
+/* Tasks are pushed at bottom by a single producer at a time and taken at top
+ * by any worker. A task is queued at most once, so eEXECUTOR_TASK_MAX_COUNT
+ * slots never overflow, and top only grows, so a taker that lost the race for
+ * a slot never takes it twice */
+typedef struct
+{
+    uint64_t      top;
+    uint64_t      bottom;
+    ExecutorTask* tasks[eEXECUTOR_TASK_MAX_COUNT];
+} WorkQueue;
+
+typedef struct
+{
+    WorkQueue  queue;       // pushed to by this worker only
+    OsalThread thread;
+    uint32_t   index;
+    uint32_t   reserved;
+    uint64_t   runs;        // counters written by this worker only
+    uint64_t   steals;
+    uint64_t   parks;
+} Worker;
+
+static Worker    workers[eEXECUTOR_THREAD_MAX_COUNT];
+static uint32_t  worker_count;
+static uint32_t  task_count;
+static WorkQueue shared_queue;      // tasks scheduled from other threads, pushed with shared_mutex held
+static OsalMutex shared_mutex;
+static OsalSem   wakeups;
+static uint32_t  sleepers;          // workers that may be waiting on wakeups
+static bool      stopping;
+
+static __thread Worker* current_worker;
+
+static void work_push(WorkQueue* queue, ExecutorTask* task)
+{
+    uint64_t bottom = __atomic_load_n(&queue->bottom, __ATOMIC_RELAXED);
+    __atomic_store_n(&queue->tasks[bottom & (eEXECUTOR_TASK_MAX_COUNT - 1)], task, __ATOMIC_RELAXED);
+    __atomic_store_n(&queue->bottom, bottom + 1, __ATOMIC_RELEASE);
+}
+
+static ExecutorTask* work_take(WorkQueue* queue)
+{
+    uint64_t top = __atomic_load_n(&queue->top, __ATOMIC_ACQUIRE);
+    for(;;)
+    {
+        if(top >= __atomic_load_n(&queue->bottom, __ATOMIC_ACQUIRE))
+        {
+            return NULL;
+        }
+
+        ExecutorTask* task = __atomic_load_n(&queue->tasks[top & (eEXECUTOR_TASK_MAX_COUNT - 1)], __ATOMIC_RELAXED);
+        if(__atomic_compare_exchange_n(&queue->top, &top, top + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return task;
+        }
+    }
+}
+
+/* Wakes a sleeping worker if there is one. Pairs with the fence in
+ * executor_entry: either the worker sees the queued task or we see it asleep */
+static void executor_wake(void)
+{
+#ifdef OSAL_EVENT_LOOP
+    /* The loop thread runs what it queued itself before it waits again */
+    if(current_worker == NULL)
+    {
+        osal_loop_kick();
+    }
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint32_t count = __atomic_load_n(&sleepers, __ATOMIC_RELAXED);
+    while(count != 0)
+    {
+        if(__atomic_compare_exchange_n(&sleepers, &count, count - 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            osal_sem_post(&wakeups);
+            break;
+        }
+    }
+#endif
+}
+
+static void executor_enqueue(ExecutorTask* task)
+{
+    if(current_worker != NULL)
+    {
+        work_push(&current_worker->queue, task);
+    }
+    else
+    {
+        osal_mutex_lock(&shared_mutex);
+        work_push(&shared_queue, task);
+        osal_mutex_unlock(&shared_mutex);
+    }
+
+    executor_wake();
+}
+
+/* The shared queue first, a task that keeps requeueing itself on the own
+ * queue would starve it otherwise, then the own queue, then the other workers' */
+static ExecutorTask* executor_find(Worker* worker)
+{
+    ExecutorTask* task = work_take(&shared_queue);
+    if(task == NULL)
+    {
+        task = work_take(&worker->queue);
+    }
+
+    for(uint32_t i = 1; task == NULL && i < worker_count; ++i)
+    {
+        task = work_take(&workers[(worker->index + i) % worker_count].queue);
+        if(task != NULL)
+        {
+            __atomic_store_n(&worker->steals, worker->steals + 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return task;
+}
+
+static void executor_run(Worker* worker, ExecutorTask* task)
+{
+    /* Schedules from here on set PENDING again, whatever they announced before
+     * is visible to this run */
+    (void)__atomic_fetch_and(&task->state, ~(uint32_t)eTASK_PENDING, __ATOMIC_ACQ_REL);
+    bool more = task->run(task->arg);
+    __atomic_store_n(&worker->runs, worker->runs + 1, __ATOMIC_RELAXED);
+
+    uint32_t idle = eTASK_ACTIVE;
+    if(more || !__atomic_compare_exchange_n(&task->state, &idle, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        /* Behind the tasks already queued, so that a busy task doesn't starve the others */
+        work_push(&worker->queue, task);
+        executor_wake();
+    }
+}
+
+#ifndef OSAL_EVENT_LOOP
+static void* executor_entry(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    current_worker = worker;
+
+    while(!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE))
+    {
+        ExecutorTask* task = executor_find(worker);
+        if(task == NULL)
+        {
+            /* Announce the sleep, then look once more before taking it */
+            (void)__atomic_fetch_add(&sleepers, 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            task = executor_find(worker);
+            if(task == NULL && !__atomic_load_n(&stopping, __ATOMIC_ACQUIRE))
+            {
+                __atomic_store_n(&worker->parks, worker->parks + 1, __ATOMIC_RELAXED);
+                osal_sem_wait(&wakeups);
+                continue;
+            }
+
+            /* Still awake, withdraw the announcement unless a waker took it already */
+            uint32_t count = __atomic_load_n(&sleepers, __ATOMIC_RELAXED);
+            while(count != 0 &&
+                  !__atomic_compare_exchange_n(&sleepers, &count, count - 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+            }
+            if(task == NULL)
+            {
+                continue;
+            }
+        }
+
+        executor_run(worker, task);
+    }
+
+    current_worker = NULL;
+    return NULL;
+}
+#endif
+
+eStatus util_executor_init(uint32_t thread_count)
+{
+#ifndef OSAL_EVENT_LOOP
+    static const OsalThreadAttr attr = {
+        .affinity_mask  = eEXECUTOR_THREAD_AFFINITY_MASK,
+        .name           = EXECUTOR_THREAD_NAME,
+        .stack_size     = eEXECUTOR_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eEXECUTOR_THREAD_POLICY,
+        .priority       = eEXECUTOR_THREAD_PRIORITY
+    };
+#endif
+
+    if(thread_count == 0 || thread_count > eEXECUTOR_THREAD_MAX_COUNT)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    if(osal_mutex_init(&shared_mutex))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    if(osal_sem_init(&wakeups, 0))
+    {
+        osal_mutex_destroy(&shared_mutex);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    shared_queue.top = 0;
+    shared_queue.bottom = 0;
+    task_count = 0;
+    sleepers = 0;
+    stopping = false;
+#ifdef OSAL_EVENT_LOOP
+    /* The loop thread is the only worker */
+    workers[0] = (Worker){ .index = 0 };
+    __atomic_store_n(&worker_count, 1, __ATOMIC_RELEASE);
+#else
+    for(uint32_t i = 0; i < thread_count; ++i)
+    {
+        workers[i] = (Worker){ .index = i };
+    }
+
+    /* Every worker steals from all thread_count queues, set before any runs */
+    __atomic_store_n(&worker_count, thread_count, __ATOMIC_RELEASE);
+    for(uint32_t i = 0; i < thread_count; ++i)
+    {
+        if(osal_thread_create_ex(&workers[i].thread, executor_entry, &workers[i], &attr))
+        {
+            __atomic_store_n(&stopping, true, __ATOMIC_RELEASE);
+            for(uint32_t j = 0; j < i; ++j)
+            {
+                osal_sem_post(&wakeups);
+            }
+            for(uint32_t j = 0; j < i; ++j)
+            {
+                osal_thread_join(&workers[j].thread);
+            }
+            __atomic_store_n(&worker_count, 0, __ATOMIC_RELEASE);
+            osal_sem_destroy(&wakeups);
+            osal_mutex_destroy(&shared_mutex);
+            return eSTATUS_SYSTEM_ERROR;
+        }
+    }
+#endif
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+uint32_t util_executor_thread_count(void)
+{
+    return __atomic_load_n(&worker_count, __ATOMIC_ACQUIRE);
+}
+
+eStatus util_executor_task_init(ExecutorTask* task, ExecutorRunFP run, void* arg)
+{
+    if(task == NULL || run == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(util_executor_thread_count() == 0)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    /* A queued or running task would end up queued twice */
+    uint32_t state = __atomic_load_n(&task->state, __ATOMIC_ACQUIRE);
+    if((state & eTASK_ACTIVE) != 0 && (state & eTASK_RETIRED) == 0)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    /* Only a task that gets a slot takes it */
+    uint32_t count = __atomic_load_n(&task_count, __ATOMIC_RELAXED);
+    do
+    {
+        if(count >= eEXECUTOR_TASK_MAX_COUNT)
+        {
+            return eSTATUS_ACTION_FAILED;
+        }
+    } while(!__atomic_compare_exchange_n(&task_count, &count, count + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    task->run = run;
+    task->arg = arg;
+    task->reserved = 0;
+    __atomic_store_n(&task->state, 0, __ATOMIC_RELEASE);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void util_executor_task_deinit(ExecutorTask* task)
+{
+    uint64_t backoff_us = 1;
+    uint32_t idle = 0;
+
+    /* Claim the task once it is neither queued nor running, the run that
+     * queued it last is then over */
+    while(!__atomic_compare_exchange_n(&task->state, &idle, eTASK_ACTIVE | eTASK_RETIRED, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        if((idle & eTASK_RETIRED) != 0)
+        {
+            return;
+        }
+
+        /* Stopped workers won't run it, the queues are dropped with them */
+        if(util_executor_thread_count() == 0)
+        {
+            __atomic_store_n(&task->state, eTASK_ACTIVE | eTASK_RETIRED, __ATOMIC_RELEASE);
+            return;
+        }
+
+        /* On a worker, and on the loop thread, the task may be queued behind
+         * us, run the queues instead of waiting for them */
+        ExecutorTask* next = (current_worker != NULL) ? executor_find(current_worker) : NULL;
+        if(next != NULL)
+        {
+            executor_run(current_worker, next);
+        }
+        else
+        {
+            osal_delay_us(backoff_us);
+            if(backoff_us < eEXECUTOR_DEINIT_BACKOFF_MAX_US)
+            {
+                backoff_us *= 2;
+            }
+        }
+        idle = 0;
+    }
+
+    (void)__atomic_fetch_sub(&task_count, 1, __ATOMIC_RELAXED);
+}
+
+void util_executor_schedule(ExecutorTask* task)
+{
+    /* Only the schedule that finds the task idle queues it */
+    uint32_t previous = __atomic_fetch_or(&task->state, eTASK_PENDING | eTASK_ACTIVE, __ATOMIC_ACQ_REL);
+    if((previous & eTASK_ACTIVE) == 0)
+    {
+        executor_enqueue(task);
+    }
+}
+
+void util_executor_get_stats(ExecutorStats* stats)
+{
+    uint32_t count = util_executor_thread_count();
+
+    *stats = (ExecutorStats){ 0 };
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        stats->runs += __atomic_load_n(&workers[i].runs, __ATOMIC_RELAXED);
+        stats->steals += __atomic_load_n(&workers[i].steals, __ATOMIC_RELAXED);
+        stats->parks += __atomic_load_n(&workers[i].parks, __ATOMIC_RELAXED);
+    }
+}
+
+eStatus util_executor_run_until(const bool* done)
+{
+#ifdef OSAL_EVENT_LOOP
+    Worker* worker = &workers[0];
+    if(util_executor_thread_count() == 0)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    current_worker = worker;
+    while(!__atomic_load_n(done, __ATOMIC_ACQUIRE))
+    {
+        /* A bounded number of runs between two looks at the loop, so I/O isn't held back */
+        uint32_t runs = 0;
+        ExecutorTask* task = NULL;
+        while(runs < eEXECUTOR_TASK_MAX_COUNT && !__atomic_load_n(done, __ATOMIC_ACQUIRE) &&
+              (task = executor_find(worker)) != NULL)
+        {
+            executor_run(worker, task);
+            ++runs;
+        }
+
+        /* Block only once nothing is left to run */
+        bool idle = (task == NULL);
+        if(idle)
+        {
+            __atomic_store_n(&worker->parks, worker->parks + 1, __ATOMIC_RELAXED);
+        }
+        if(!__atomic_load_n(done, __ATOMIC_ACQUIRE) && osal_loop_wait(idle) != eSTATUS_SUCCESSFUL)
+        {
+            return eSTATUS_SYSTEM_ERROR;
+        }
+    }
+
+    return eSTATUS_SUCCESSFUL;
+#else
+    (void)done;
+    return eSTATUS_ACTION_FAILED;
+#endif
+}
+
+void util_executor_delete(void)
+{
+    uint32_t count = util_executor_thread_count();
+    if(count == 0)
+    {
+        return;
+    }
+
+#ifndef OSAL_EVENT_LOOP
+    __atomic_store_n(&stopping, true, __ATOMIC_RELEASE);
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        osal_sem_post(&wakeups);
+    }
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        osal_thread_join(&workers[i].thread);
+    }
+#endif
+
+    __atomic_store_n(&worker_count, 0, __ATOMIC_RELEASE);
+    osal_sem_destroy(&wakeups);
+    osal_mutex_destroy(&shared_mutex);
+}
@@ -0,0 +1,132 @@
+#ifndef UTIL_EXECUTOR_H
+#define UTIL_EXECUTOR_H
+
+/* Standard library includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* User library includes */
+#include "util/executor/executor_config.h"
+#include "status.h"
+
+/*
+    Runs tasks on a fixed pool of worker threads. A scheduled task is queued
+    once on the queue of the worker that scheduled it, or on a shared queue
+    when scheduled from another thread, and runs on a single worker at a
+    time. A worker takes from the shared queue first, so that a busy worker
+    doesn't hold back the tasks scheduled from outside, then runs its own
+    queue in FIFO order, then steals from the other workers, and sleeps once
+    every queue is empty.
+
+    With OSAL_EVENT_LOOP there are no worker threads: the thread calling
+    util_executor_run_until is the only worker, and waits in the OSAL event
+    loop, which also runs the timers and watched descriptors, when no task
+    is queued.
+*/
+
+/**
+ * @brief   Function run by the executor for a task.
+ * @param   arg The argument given to @ref util_executor_task_init.
+ * @returns true if the task has more work, it is queued again behind the
+ *          tasks already waiting.
+ */
+typedef bool (*ExecutorRunFP)(void* arg);
+
+/* Fields are private to the executor */
+typedef struct
+{
+    ExecutorRunFP run;
+    void*         arg;
+    uint32_t      state;
+    uint32_t      reserved;
+} ExecutorTask;
+
+typedef struct
+{
+    uint64_t runs;      // task runs
+    uint64_t steals;    // tasks a worker took from another worker's queue
+    uint64_t parks;     // times a worker went to sleep for lack of tasks
+} ExecutorStats;
+
+/**
+ * @brief   Start the executor's workers.
+ * @details Must be called once before any task is scheduled. The workers use
+ *          the thread attributes of executor_config.h. With OSAL_EVENT_LOOP
+ *          no thread is started, whatever thread_count.
+ * @param   thread_count The number of workers, up to eEXECUTOR_THREAD_MAX_COUNT.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   thread_count is 0 or above the maximum
+ * @retval  eSTATUS_SYSTEM_ERROR    mutex, semaphore or thread creation failed
+ */
+eStatus util_executor_init(uint32_t thread_count);
+
+/**
+ * @brief   Get the number of running workers.
+ * @returns 0 before @ref util_executor_init and after @ref util_executor_delete.
+ */
+uint32_t util_executor_thread_count(void);
+
+/**
+ * @brief   Prepare a task.
+ * @details At most eEXECUTOR_TASK_MAX_COUNT tasks may be initialized at a
+ *          time, @ref util_executor_task_deinit gives the slot back. A task
+ *          is zeroed before its first init, a scheduled one has to be
+ *          deinitialized before it is initialized again.
+ * @param   task A pointer to the task, must stay valid while it is scheduled.
+ * @param   run The function the workers run for the task.
+ * @param   arg Passed to run.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      task or run are NULL
+ * @retval  eSTATUS_ACTION_FAILED   the executor isn't running, has no room for the task or the task
+ *                                  is still queued or running
+ */
+eStatus util_executor_task_init(ExecutorTask* task, ExecutorRunFP run, void* arg);
+
+/**
+ * @brief   Retire a task.
+ * @details Waits until the task is neither queued nor running, sleeping
+ *          between looks or running the queued tasks when called from a
+ *          worker, then frees its slot. Schedules from then on are ignored.
+ *          Not to be called from the task itself.
+ * @param   task A pointer to a task from @ref util_executor_task_init.
+ */
+void util_executor_task_deinit(ExecutorTask* task);
+
+/**
+ * @brief   Have a task run.
+ * @details Queues the task unless it is already queued. A task scheduled
+ *          while it runs is run again afterwards, so work announced before
+ *          this call is always seen by a later run. Lock-free from the
+ *          workers, other threads take a mutex. Can be called from any thread.
+ * @param   task A pointer to a task from @ref util_executor_task_init.
+ */
+void util_executor_schedule(ExecutorTask* task);
+
+/**
+ * @brief   Read the executor's counters, summed over the workers.
+ * @param   stats A pointer to the struct to be filled.
+ */
+void util_executor_get_stats(ExecutorStats* stats);
+
+/**
+ * @brief   Run the tasks on the calling thread until done is set.
+ * @details With OSAL_EVENT_LOOP only, from a single thread. Runs the queued
+ *          tasks and waits in @ref osal_loop_wait when there are none, so
+ *          the timer and descriptor handlers run on this thread as well.
+ * @param   done A flag set by a task, read once per task run.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      done was set
+ * @retval  eSTATUS_ACTION_FAILED   built without OSAL_EVENT_LOOP or the executor isn't running
+ * @retval  eSTATUS_SYSTEM_ERROR    the event loop failed
+ */
+eStatus util_executor_run_until(const bool* done);
+
+/**
+ * @brief   Stop and join the workers.
+ * @details Tasks still queued are not run. Not to be called from a task.
+ */
+void util_executor_delete(void);
+
+#endif
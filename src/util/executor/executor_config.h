@@ -0,0 +1,21 @@
+#ifndef UTIL_EXECUTOR_CONFIG_H
+#define UTIL_EXECUTOR_CONFIG_H
+
+/* User library includes */
+#include "osal/osal.h"
+
+#define EXECUTOR_THREAD_NAME "executor"
+
+typedef enum eExecutorConfig
+{
+    eEXECUTOR_THREAD_COUNT = 2,             // workers started by main
+    eEXECUTOR_THREAD_MAX_COUNT = 8,
+    eEXECUTOR_TASK_MAX_COUNT = 32,          // tasks on the executor, a power of two
+    eEXECUTOR_DEINIT_BACKOFF_MAX_US = 1000, // longest sleep between two looks at a task being deinitialized
+    eEXECUTOR_THREAD_POLICY = eTHREAD_POLICY_INHERIT,
+    eEXECUTOR_THREAD_PRIORITY = 0,
+    eEXECUTOR_THREAD_AFFINITY_MASK = 0,
+    eEXECUTOR_THREAD_STACK_SIZE = 0
+} eExecutorConfig;
+
+#endif
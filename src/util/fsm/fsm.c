@@ -2,6 +2,142 @@
 
 /* Standard library includes */
 #include <stddef.h>
+#include <string.h>
+
+/* User library includes */
+#include "util/fsm/fsm_table.h"
+#include "util/trace/trace.h"
+#include "osal/osal.h"
+
+/* Index of a state in the stats table, the state is added on its first
+ * entry. eFSM_STATS_STATE_MAX_COUNT once the table is full */
+static uint32_t fsm_stats_slot(FSMStats* stats, StateFP state)
+{
+    uint32_t slot = 0;
+    for(; slot < eFSM_STATS_STATE_MAX_COUNT; ++slot)
+    {
+        if(stats->states[slot] == state)
+        {
+            break;
+        }
+        if(stats->states[slot] == NULL)
+        {
+            __atomic_store_n(&stats->states[slot], state, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+
+    return slot;
+}
+
+/* Start a stay in the state at slot */
+static void fsm_stats_enter(FSMStats* stats, uint32_t slot, uint64_t now)
+{
+    __atomic_store_n(&stats->entered_ns, now, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->current, slot, __ATOMIC_RELAXED);
+    if(slot < eFSM_STATS_STATE_MAX_COUNT)
+    {
+        FSMStateStats* state_stats = &stats->state_stats[slot];
+        __atomic_store_n(&state_stats->entries, state_stats->entries + 1, __ATOMIC_RELAXED);
+    }
+}
+
+/* Run handler for the current state and charge its duration to slot,
+ * returns the time it returned at */
+static uint64_t fsm_call(FSM* fsm, uint32_t slot, StateFP handler, Event* event)
+{
+    uint64_t start = osal_time_now_ns();
+    handler(fsm, event);
+    uint64_t end = osal_time_now_ns();
+
+    if(slot < eFSM_STATS_STATE_MAX_COUNT)
+    {
+        FSMStateStats* state_stats = &fsm->stats.state_stats[slot];
+        util_histogram_record(&state_stats->handler, end - start);
+        if(end - start > (uint64_t)eFSM_STATS_BUDGET_MS * 1000000u)
+        {
+            __atomic_store_n(&state_stats->overruns, state_stats->overruns + 1, __ATOMIC_RELAXED);
+        }
+    }
+    else
+    {
+        __atomic_store_n(&fsm->stats.untracked, fsm->stats.untracked + 1, __ATOMIC_RELAXED);
+    }
+
+    return end;
+}
+
+/* The entry of state in the table, NULL if it isn't part of it */
+static const FSMTableState* fsm_table_state(const FSMTable* table, StateFP state)
+{
+    for(uint32_t i = 0; i < table->state_count; ++i)
+    {
+        if(table->states[i].state == state)
+        {
+            return &table->states[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Exit the current state and enter next_state, whose table entry is
+ * next_table_state, NULL when the FSM doesn't run from a table */
+static void fsm_transition(FSM* fsm, StateFP next_state, const FSMTableState* next_table_state)
+{
+    /* Calls current state with exit event, sets the next state and calls it
+       with an entry event */
+    Event exit_event = { .type = eFSM_EVENT_EXIT };
+    Event entry_event = { .type = eFSM_EVENT_ENTRY };
+    FSMStats* stats = &fsm->stats;
+    util_trace_record(eTRACE_KIND_TRANSITION, fsm, 0, (uint64_t)(uintptr_t)next_state);
+    uint32_t slot = stats->current;
+    uint64_t now = fsm_call(fsm, slot, fsm->current_state, &exit_event);
+
+    /* The stay ends once the exit action is done */
+    if(slot < eFSM_STATS_STATE_MAX_COUNT)
+    {
+        FSMStateStats* state_stats = &stats->state_stats[slot];
+        __atomic_store_n(&state_stats->time_ns, state_stats->time_ns + (now - stats->entered_ns), __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&stats->transitions, stats->transitions + 1, __ATOMIC_RELAXED);
+
+    fsm->current_state = next_state;
+    fsm->table_state = next_table_state;
+    slot = fsm_stats_slot(stats, next_state);
+    fsm_stats_enter(stats, slot, now);
+    (void)fsm_call(fsm, slot, next_state, &entry_event);
+}
+
+/* Handler of the events a table FSM's state has rows for: takes the first
+ * row for the event whose guard passes */
+static void fsm_table_run(FSM* fsm, Event* event)
+{
+    const FSMTable* table = fsm->table;
+    const FSMTableRow* row = &table->rows[fsm->table_state->first_row];
+    const FSMTableRow* end = row + fsm->table_state->row_count;
+
+    for(; row < end; ++row)
+    {
+        if(row->event != event->type || (row->guard != NULL && !row->guard(fsm, event)))
+        {
+            continue;
+        }
+        if(row->action != NULL)
+        {
+            row->action(fsm, event);
+        }
+        if(row->target != eFSM_TABLE_INTERNAL)
+        {
+            const FSMTableState* next = &table->states[row->target];
+            fsm_transition(fsm, next->state, next);
+        }
+        return;
+    }
+
+    /* Types past the filter's bits, or every guard failed */
+    __atomic_store_n(&fsm->stats.filtered, fsm->stats.filtered + 1, __ATOMIC_RELAXED);
+}
 
 eStatus util_fsm_init(FSM* fsm, StateFP init_state, void* arg)
 {
@@ -13,10 +149,15 @@ eStatus util_fsm_init(FSM* fsm, StateFP init_state, void* arg)
     /* Assign the fsm object values */
     fsm->current_state = init_state;
     fsm->arg           = arg;
+    fsm->table         = NULL;
+    fsm->table_state   = NULL;
+    memset(&fsm->stats, 0, sizeof(fsm->stats));
 
     /* Calls the init states with an init event */
     Event init_event = { .type = eFSM_EVENT_INIT };
-    fsm->current_state(fsm, &init_event);
+    uint32_t slot = fsm_stats_slot(&fsm->stats, init_state);
+    fsm_stats_enter(&fsm->stats, slot, osal_time_now_ns());
+    (void)fsm_call(fsm, slot, init_state, &init_event);
 
     return eSTATUS_SUCCESSFUL;
 }
@@ -28,8 +169,20 @@ eStatus util_fsm_send_event(FSM* fsm, Event* event)
         return eSTATUS_NULL_PARAM;
     }
 
-    /* Calls the current state with the provided event and data */
-    fsm->current_state(fsm, event);
+    if(fsm->table == NULL)
+    {
+        /* Calls the current state with the provided event and data */
+        (void)fsm_call(fsm, fsm->stats.current, fsm->current_state, event);
+    }
+    else if(event->type >= eFSM_TABLE_FILTER_TYPES || (fsm->table_state->handled & (1u << event->type)) != 0u)
+    {
+        (void)fsm_call(fsm, fsm->stats.current, fsm_table_run, event);
+    }
+    else
+    {
+        /* No row for it, not worth reading the clock */
+        __atomic_store_n(&fsm->stats.filtered, fsm->stats.filtered + 1, __ATOMIC_RELAXED);
+    }
 
     return eSTATUS_SUCCESSFUL;
 }
@@ -41,13 +194,50 @@ eStatus util_fsm_transition(FSM* fsm, StateFP next_state)
         return eSTATUS_NULL_PARAM;
     }
 
-    /* Calls current state with exit event, sets the next state and calls it
-       with an entry event */
-    Event exit_event = { .type = eFSM_EVENT_EXIT };
-    Event entry_event = { .type = eFSM_EVENT_ENTRY };
-    fsm->current_state(fsm, &exit_event);
-    fsm->current_state = next_state;
-    fsm->current_state(fsm, &entry_event);
+    /* A state outside the table leaves it */
+    const FSMTableState* next_table_state = NULL;
+    if(fsm->table != NULL)
+    {
+        next_table_state = fsm_table_state(fsm->table, next_state);
+        if(next_table_state == NULL)
+        {
+            fsm->table = NULL;
+        }
+    }
+    fsm_transition(fsm, next_state, next_table_state);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus util_fsm_get_stats(const FSM* fsm, FSMStats* stats)
+{
+    if(fsm == NULL || stats == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    for(uint32_t i = 0; i < eFSM_STATS_STATE_MAX_COUNT; ++i)
+    {
+        const FSMStateStats* state_stats = &fsm->stats.state_stats[i];
+        stats->states[i] = __atomic_load_n(&fsm->stats.states[i], __ATOMIC_ACQUIRE);
+        stats->state_stats[i].entries = __atomic_load_n(&state_stats->entries, __ATOMIC_RELAXED);
+        stats->state_stats[i].time_ns = __atomic_load_n(&state_stats->time_ns, __ATOMIC_RELAXED);
+        stats->state_stats[i].overruns = __atomic_load_n(&state_stats->overruns, __ATOMIC_RELAXED);
+        stats->state_stats[i].reserved = 0;
+        (void)util_histogram_read(&state_stats->handler, &stats->state_stats[i].handler);
+    }
+    stats->transitions = __atomic_load_n(&fsm->stats.transitions, __ATOMIC_RELAXED);
+    stats->entered_ns = __atomic_load_n(&fsm->stats.entered_ns, __ATOMIC_RELAXED);
+    stats->current = __atomic_load_n(&fsm->stats.current, __ATOMIC_RELAXED);
+    stats->untracked = __atomic_load_n(&fsm->stats.untracked, __ATOMIC_RELAXED);
+    stats->filtered = __atomic_load_n(&fsm->stats.filtered, __ATOMIC_RELAXED);
+
+    /* Add the current stay so far */
+    uint64_t now = osal_time_now_ns();
+    if(stats->current < eFSM_STATS_STATE_MAX_COUNT && now > stats->entered_ns)
+    {
+        stats->state_stats[stats->current].time_ns += now - stats->entered_ns;
+    }
 
     return eSTATUS_SUCCESSFUL;
-}
\ No newline at end of file
+}
@@ -5,6 +5,8 @@
 #include <stdint.h>
 
 /* User library includes */
+#include "util/fsm/fsm_config.h"
+#include "util/histogram/histogram.h"
 #include "status.h"
 
 typedef enum eFSMEvent
@@ -16,8 +18,17 @@ typedef enum eFSMEvent
     eFSM_EVENT_USER
 } eFSMEvent;
 
+/* Dispatch priority of an event type, see ActiveObjectAttr */
+typedef enum eEventPriority
+{
+    eEVENT_PRIORITY_NORMAL,     // FIFO order
+    eEVENT_PRIORITY_URGENT      // ahead of every normal event already queued
+} eEventPriority;
+
 typedef struct Event Event;
 typedef struct FSM FSM;
+typedef struct FSMTable FSMTable;
+typedef struct FSMTableState FSMTableState;
 
 typedef void (*StateFP)(FSM* fsm, Event* event);
 
@@ -26,15 +37,40 @@ struct Event
     uint32_t type;
 };
 
+typedef struct
+{
+    uint64_t  entries;      // times the state was entered, the initial state included
+    uint64_t  time_ns;      // time spent in the state, the current stay included when read
+    uint32_t  overruns;     // handler calls longer than eFSM_STATS_BUDGET_MS
+    uint32_t  reserved;
+    Histogram handler;      // ns per handler call, an event's includes the transition it makes
+} FSMStateStats;
+
+/* Written by the thread running the FSM only */
+typedef struct
+{
+    StateFP       states[eFSM_STATS_STATE_MAX_COUNT];       // in order of first entry, NULL past the last one
+    FSMStateStats state_stats[eFSM_STATS_STATE_MAX_COUNT];  // indexed like states
+    uint64_t      transitions;  // calls to util_fsm_transition and table rows taken to another state
+    uint64_t      entered_ns;   // when the current state was entered
+    uint32_t      current;      // index of the current state, eFSM_STATS_STATE_MAX_COUNT if untracked
+    uint32_t      untracked;    // handler calls of the states that didn't fit in the table
+    uint64_t      filtered;     // events a table FSM had no row for, see fsm_table.h
+} FSMStats;
+
 struct FSM
 {
     StateFP current_state;
     void*   arg;
+    const FSMTable*      table;         // NULL unless run from a table, see fsm_table.h
+    const FSMTableState* table_state;   // the entry of current_state in table
+    FSMStats stats;
 };
 
 /**
  * @brief   Initialize an FSM.
  * @details Initializes a Finite-State Machine to be used with Active Object.
+ *          Clears the stats, see @ref util_fsm_get_stats.
  * @param   fsm A pointer to an uninitialized FSM struct.
  * @param   init_state A function pointer to the machine's initial state.
  * @param   arg An argument (if required - can be of any type).
@@ -46,6 +82,9 @@ eStatus util_fsm_init(FSM* fsm, StateFP init_state, void* arg);
 
 /**
  * @brief   Send an event to an FSM.
+ * @details The handler call is timed into the current state's stats. An FSM
+ *          run from a table looks the event up in it instead of calling
+ *          the state's handler, see @ref util_fsm_table_start.
  * @param   fsm A pointer to an initialized FSM struct.
  * @param   event An event from @ref eFSMEvent (to be expanded for practical use).
  * @returns A value from @ref eStatus.
@@ -64,4 +103,19 @@ eStatus util_fsm_send_event(FSM* fsm, Event* event);
  */
 eStatus util_fsm_transition(FSM* fsm, StateFP next_state);
 
+/**
+ * @brief   Read the per-state timings of an FSM.
+ * @details Every handler call made through this module is timed and charged
+ *          to the state it was made to, so a state whose handlers block, or
+ *          whose events lead to blocking entry actions, stands out in its
+ *          histogram's max and overruns. Can be called from any thread while
+ *          the FSM runs, the copy may then be a transition behind.
+ * @param   fsm A pointer to an initialized FSM struct.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      fsm or stats are NULL
+ */
+eStatus util_fsm_get_stats(const FSM* fsm, FSMStats* stats);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,10 @@
+#ifndef UTIL_FSM_CONFIG_H
+#define UTIL_FSM_CONFIG_H
+
+typedef enum eFSMConfig
+{
+    eFSM_STATS_STATE_MAX_COUNT = 8,     // states tracked per FSM, even so the table keeps 8 byte alignment
+    eFSM_STATS_BUDGET_MS = 333          // handler calls longer than this count as overruns, the scheduler's tick
+} eFSMConfig;
+
+#endif
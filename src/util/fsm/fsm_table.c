@@ -0,0 +1,110 @@
+#include "fsm_table.h"
+
+/* Standard library includes */
+#include <stddef.h>
+
+eStatus util_fsm_table_start(FSM* fsm, const FSMTable* table)
+{
+    if(fsm == NULL || table == NULL || fsm->current_state == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(table->state_count == 0 || table->states == NULL || table->states[0].state == NULL)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    /* The transition finds the first state in the table */
+    fsm->table = table;
+    return util_fsm_transition(fsm, table->states[0].state);
+}
+
+/* The rows of state are its own, in range, and match its filter bits */
+static bool fsm_table_state_valid(const FSMTable* table, uint32_t index)
+{
+    const FSMTableState* state = &table->states[index];
+    uint32_t handled = 0;
+
+    if(state->state == NULL || state->first_row + state->row_count > table->row_count)
+    {
+        return false;
+    }
+
+    for(uint32_t i = state->first_row; i < state->first_row + state->row_count; ++i)
+    {
+        const FSMTableRow* row = &table->rows[i];
+        if(row->source != index || (row->target != eFSM_TABLE_INTERNAL && row->target >= table->state_count))
+        {
+            return false;
+        }
+        if(row->event < eFSM_TABLE_FILTER_TYPES)
+        {
+            handled |= 1u << row->event;
+        }
+
+        /* An unguarded row takes every later one's event */
+        for(uint32_t j = state->first_row; j < i; ++j)
+        {
+            if(table->rows[j].event == row->event && table->rows[j].guard == NULL)
+            {
+                return false;
+            }
+        }
+    }
+
+    return handled == state->handled;
+}
+
+eStatus util_fsm_table_validate(const FSMTable* table)
+{
+    if(table == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(table->states == NULL || table->state_count == 0 || table->state_count > eFSM_TABLE_STATE_MAX_COUNT ||
+       (table->rows == NULL && table->row_count != 0))
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    /* The states' ranges follow each other and cover every row */
+    uint32_t next_row = 0;
+    for(uint32_t i = 0; i < table->state_count; ++i)
+    {
+        if(table->states[i].first_row != next_row || !fsm_table_state_valid(table, i))
+        {
+            return eSTATUS_INVALID_VALUE;
+        }
+        next_row += table->states[i].row_count;
+    }
+    if(next_row != table->row_count)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    /* Follow the rows from the first state until no new state is reached */
+    uint64_t reached = 1;
+    uint64_t previous;
+    do
+    {
+        previous = reached;
+        for(uint32_t i = 0; i < table->row_count; ++i)
+        {
+            const FSMTableRow* row = &table->rows[i];
+            if((reached & (1ull << row->source)) != 0 && row->target != eFSM_TABLE_INTERNAL)
+            {
+                reached |= 1ull << row->target;
+            }
+        }
+    } while(reached != previous);
+
+    uint64_t all = (table->state_count == 64) ? UINT64_MAX : (1ull << table->state_count) - 1;
+    if(reached != all)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
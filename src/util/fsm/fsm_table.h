@@ -0,0 +1,155 @@
+#ifndef UTIL_FSM_TABLE_H
+#define UTIL_FSM_TABLE_H
+
+/* Standard library includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* User library includes */
+#include "util/fsm/fsm.h"
+#include "status.h"
+
+/*
+    Table-driven FSMs. The states, the events they take and the transitions
+    between them are const tables, usually generated from two X-macros:
+
+        #define MY_STATES(X, T)                                 \
+            X(T, eMY_STATE_IDLE, my_idle_state)                 \
+            X(T, eMY_STATE_BUSY, my_busy_state)
+
+        #define MY_TRANSITIONS(X, S)                            \
+            X(S, eMY_STATE_IDLE, eMY_EVENT_GO,   NULL, start, eMY_STATE_BUSY) \
+            X(S, eMY_STATE_BUSY, eMY_EVENT_DONE, NULL, NULL,  eMY_STATE_IDLE)
+
+        typedef enum { MY_STATES(FSM_TABLE_STATE_ID, ~) eMY_STATE_COUNT } eMyState;
+        static const FSMTableRow my_rows[] = { MY_TRANSITIONS(FSM_TABLE_ROW, ~) };
+        static const FSMTableState my_states[] = { MY_STATES(FSM_TABLE_STATE, MY_TRANSITIONS) };
+        MY_STATES(FSM_TABLE_CHECK_ENTERED, MY_TRANSITIONS)
+        static const FSMTable my_table = FSM_TABLE(my_states, my_rows);
+
+    The rows of a state are listed together, in the order of the states. An
+    event the current state has no row for is dropped before anything is
+    called. Otherwise the rows for the event are tried in order and the first
+    whose guard passes is taken: its action runs, then the FSM moves to the
+    target with the usual EXIT and ENTRY events, sent to the states'
+    handlers. Each state's StateFP only handles ENTRY and EXIT, and keys its
+    stats like in any other FSM.
+*/
+
+typedef enum eFSMTable
+{
+    eFSM_TABLE_FILTER_TYPES    = 32,    // event types below this are filtered with FSMTableState.handled
+    eFSM_TABLE_STATE_MAX_COUNT = 64,    // states util_fsm_table_validate can follow
+    eFSM_TABLE_INTERNAL        = 0xFFFF // row target that stays in the state, without EXIT or ENTRY
+} eFSMTable;
+
+/**
+ * @brief   Decide whether a row is taken.
+ * @returns true to take the row, false to try the next one.
+ */
+typedef bool (*FSMGuardFP)(FSM* fsm, const Event* event);
+
+/**
+ * @brief   Run when a row is taken, before the EXIT of the current state.
+ */
+typedef void (*FSMActionFP)(FSM* fsm, Event* event);
+
+typedef struct
+{
+    uint32_t    source;     // index of the state the row belongs to
+    uint32_t    event;      // event type
+    uint32_t    target;     // index of the next state, or eFSM_TABLE_INTERNAL
+    uint32_t    reserved;
+    FSMGuardFP  guard;      // NULL always passes
+    FSMActionFP action;     // NULL for none
+} FSMTableRow;
+
+struct FSMTableState
+{
+    StateFP  state;         // ENTRY and EXIT handler, the state's identity in the stats
+    uint32_t handled;       // bit per event type below eFSM_TABLE_FILTER_TYPES that has a row
+    uint32_t first_row;     // index of the state's first row
+    uint32_t row_count;
+    uint32_t reserved;
+};
+
+struct FSMTable
+{
+    const FSMTableState* states;        // the first one is entered by util_fsm_table_start
+    const FSMTableRow*   rows;
+    uint32_t             state_count;
+    uint32_t             row_count;
+};
+
+/* X-macro expanders, see the example above. T is the transitions X-macro,
+ * S the state a row is being counted for */
+#define FSM_TABLE_STATE_ID(T, id, handler)  id,
+
+#define FSM_TABLE_ROW(S, source, event, guard, action, target)     \
+    { (uint32_t)(source), (uint32_t)(event), (uint32_t)(target), 0u, (guard), (action) },
+
+#define FSM_TABLE_ROW_BIT(S, source, event, guard, action, target) \
+    | (((uint32_t)(source) == (uint32_t)(S) && (uint32_t)(event) < (uint32_t)eFSM_TABLE_FILTER_TYPES) ? \
+       (1u << ((uint32_t)(event) & 31u)) : 0u)
+
+#define FSM_TABLE_ROW_BEFORE(S, source, event, guard, action, target) \
+    + (((uint32_t)(source) < (uint32_t)(S)) ? 1u : 0u)
+
+#define FSM_TABLE_ROW_FROM(S, source, event, guard, action, target) \
+    + (((uint32_t)(source) == (uint32_t)(S)) ? 1u : 0u)
+
+#define FSM_TABLE_ROW_INTO(S, source, event, guard, action, target) \
+    + (((uint32_t)(target) == (uint32_t)(S) && (uint32_t)(source) != (uint32_t)(S)) ? 1u : 0u)
+
+#define FSM_TABLE_STATE(T, id, handler)                     \
+    [id] = {                                                \
+        .state     = (handler),                             \
+        .handled   = 0u T(FSM_TABLE_ROW_BIT, id),           \
+        .first_row = 0u T(FSM_TABLE_ROW_BEFORE, id),        \
+        .row_count = 0u T(FSM_TABLE_ROW_FROM, id),          \
+        .reserved  = 0u                                     \
+    },
+
+/* Fails the build for a state, other than the first, that no row of
+ * another state leads to */
+#define FSM_TABLE_CHECK_ENTERED(T, id, handler) \
+    typedef char fsm_table_entered_##id[((id) == 0 || (0u T(FSM_TABLE_ROW_INTO, id)) > 0u) ? 1 : -1];
+
+#define FSM_TABLE(states, rows)                                         \
+    {                                                                   \
+        (states), (rows),                                               \
+        (uint32_t)(sizeof(states) / sizeof((states)[0])),               \
+        (uint32_t)(sizeof(rows) / sizeof((rows)[0]))                    \
+    }
+
+/**
+ * @brief   Hand an FSM over to a table.
+ * @details Called from the INIT handler of the FSM's initial state, which
+ *          isn't part of the table. Moves to the table's first state, from
+ *          then on events are dispatched through the table. A transition
+ *          made with @ref util_fsm_transition to a state outside the table
+ *          leaves it, the FSM then runs like any other.
+ * @param   fsm A pointer to an initialized FSM.
+ * @param   table A pointer to the table, must stay valid while the FSM runs.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      fsm or table are NULL or fsm is uninitialized
+ * @retval  eSTATUS_INVALID_VALUE   the table has no state
+ */
+eStatus util_fsm_table_start(FSM* fsm, const FSMTable* table);
+
+/**
+ * @brief   Check a table.
+ * @details Checks what the build can't: that every row is in its state's
+ *          range and targets a state of the table, that the filter bits
+ *          match the rows, that no row follows an unguarded one for the
+ *          same event, and that every state can be reached from the first.
+ * @param   table A pointer to the table.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      the table is consistent
+ * @retval  eSTATUS_NULL_PARAM      table is NULL
+ * @retval  eSTATUS_INVALID_VALUE   the table is inconsistent
+ */
+eStatus util_fsm_table_validate(const FSMTable* table);
+
+#endif
@@ -0,0 +1,72 @@
+#include "histogram.h"
+
+/* Standard library includes */
+#include <stddef.h>
+#include <string.h>
+
+/* Bucket n holds values below 2^n, so 0 lands in bucket 0 and 1 in bucket 1 */
+static uint32_t histogram_bucket(uint64_t value)
+{
+    uint32_t bucket = (value == 0) ? 0 : (uint32_t)(64 - __builtin_clzll(value));
+    return (bucket < eHISTOGRAM_BUCKET_COUNT) ? bucket : eHISTOGRAM_BUCKET_COUNT - 1;
+}
+
+void util_histogram_reset(Histogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void util_histogram_record(Histogram* histogram, uint64_t value)
+{
+    /* Single writer: the atomic stores only keep readers from seeing torn values */
+    uint32_t* bucket = &histogram->buckets[histogram_bucket(value)];
+    __atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->count, histogram->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->sum, histogram->sum + value, __ATOMIC_RELAXED);
+    if(value > histogram->max)
+    {
+        __atomic_store_n(&histogram->max, value, __ATOMIC_RELAXED);
+    }
+}
+
+eStatus util_histogram_read(const Histogram* histogram, Histogram* copy)
+{
+    if(histogram == NULL || copy == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    for(uint32_t i = 0; i < eHISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        copy->buckets[i] = __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+    }
+    copy->count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+    copy->sum = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+    copy->max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+uint64_t util_histogram_percentile(const Histogram* histogram, uint32_t percent)
+{
+    if(histogram == NULL || histogram->count == 0)
+    {
+        return 0;
+    }
+
+    /* Rank of the percentile, rounded up so p100 is the last value */
+    uint64_t rank = (histogram->count * (percent > 100 ? 100 : percent) + 99) / 100;
+    uint64_t seen = 0;
+
+    for(uint32_t i = 0; i < eHISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        seen += histogram->buckets[i];
+        if(seen >= rank && seen != 0)
+        {
+            uint64_t bound = (i == 0) ? 0 : (UINT64_C(1) << i) - 1;
+            return (i == eHISTOGRAM_BUCKET_COUNT - 1 || bound > histogram->max) ? histogram->max : bound;
+        }
+    }
+
+    return histogram->max;
+}
@@ -0,0 +1,56 @@
+#ifndef UTIL_HISTOGRAM_H
+#define UTIL_HISTOGRAM_H
+
+/* Standard library includes */
+#include <stdint.h>
+
+/* User library includes */
+#include "util/histogram/histogram_config.h"
+#include "status.h"
+
+/* Log2 histogram, for latencies in nanoseconds. A single thread records,
+ * any thread may read a copy with util_histogram_read */
+typedef struct
+{
+    uint32_t buckets[eHISTOGRAM_BUCKET_COUNT];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+} Histogram;
+
+/**
+ * @brief   Clear a histogram.
+ * @param   histogram A pointer to a Histogram struct.
+ */
+void util_histogram_reset(Histogram* histogram);
+
+/**
+ * @brief   Count a value in a histogram.
+ * @details Must only be called by one thread at a time per histogram.
+ * @param   histogram A pointer to a Histogram struct.
+ * @param   value The value to count.
+ */
+void util_histogram_record(Histogram* histogram, uint64_t value);
+
+/**
+ * @brief   Copy a histogram that another thread may be recording into.
+ * @details Each field is read atomically, the copy may miss the values
+ *          recorded while it is taken.
+ * @param   histogram A pointer to the Histogram to read.
+ * @param   copy A pointer to the Histogram to be filled.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      histogram or copy are NULL
+ */
+eStatus util_histogram_read(const Histogram* histogram, Histogram* copy);
+
+/**
+ * @brief   Estimate a percentile of the recorded values.
+ * @param   histogram A pointer to a Histogram struct.
+ * @param   percent The percentile, 0..100.
+ * @returns The upper bound of the bucket holding the percentile, capped by the
+ *          largest recorded value. 0 if nothing was recorded.
+ */
+uint64_t util_histogram_percentile(const Histogram* histogram, uint32_t percent);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef UTIL_HISTOGRAM_CONFIG_H
+#define UTIL_HISTOGRAM_CONFIG_H
+
+typedef enum eHistogramConfig
+{
+    eHISTOGRAM_BUCKET_COUNT = 32    // bucket n counts values in [2^(n-1), 2^n), the last one everything above
+} eHistogramConfig;
+
+#endif
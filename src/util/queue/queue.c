@@ -2,15 +2,35 @@
 
 /* Standard library includes */
 #include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+static uint32_t round_up_pow2(uint32_t value)
+{
+    uint32_t result = 1;
+    while(result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
 
 eStatus util_queue_init(Queue* queue, uint32_t capacity)
 {
-    if(queue == NULL || capacity == 0)
+    return util_queue_init_ex(queue, capacity, eQUEUE_TYPE_LOCKED);
+}
+
+static eStatus queue_init(Queue* queue, uint32_t capacity, eQueueType type, uint32_t urgent_capacity)
+{
+    if(type != eQUEUE_TYPE_LOCKED)
     {
-        return eSTATUS_NULL_PARAM;
+        /* Lets the lock-free types index with a mask instead of a division */
+        capacity = round_up_pow2(capacity);
     }
 
-    queue->buffer = osal_alloc(sizeof(void*) * capacity);
+    /* The urgent lane and the MPSC sequence counters share the allocation, after the slots */
+    size_t slot_size = sizeof(void*) + ((type == eQUEUE_TYPE_MPSC) ? sizeof(uint32_t) : 0);
+    queue->buffer = osal_alloc(slot_size * capacity + sizeof(void*) * urgent_capacity);
     if(queue->buffer == NULL)
     {
         return eSTATUS_SYSTEM_ERROR;
@@ -20,6 +40,39 @@ eStatus util_queue_init(Queue* queue, uint32_t capacity)
     queue->head     = 0;
     queue->tail     = 0;
     queue->size     = 0;
+    queue->type     = type;
+    queue->mask     = capacity - 1;
+    queue->sequence = NULL;
+    queue->stamps   = NULL;
+    queue->merged   = 0;
+    queue->peak     = 0;
+    memset(&queue->ring, 0, sizeof(queue->ring));
+    memset(&queue->urgent, 0, sizeof(queue->urgent));
+    if(urgent_capacity != 0)
+    {
+        queue->urgent.buffer = queue->buffer + capacity;
+        queue->urgent.capacity = urgent_capacity;
+    }
+
+    if(type == eQUEUE_TYPE_MPSC)
+    {
+        queue->sequence = (uint32_t*)(queue->buffer + capacity);
+        for(uint32_t i = 0; i < capacity; ++i)
+        {
+            queue->sequence[i] = i;
+        }
+    }
+
+    if(type != eQUEUE_TYPE_LOCKED)
+    {
+        if(osal_event_init(&queue->ring.ready))
+        {
+            osal_dealloc(queue->buffer);
+            return eSTATUS_SYSTEM_ERROR;
+        }
+
+        return eSTATUS_SUCCESSFUL;
+    }
 
     if(osal_mutex_init(&queue->mutex))
     {
@@ -27,8 +80,9 @@ eStatus util_queue_init(Queue* queue, uint32_t capacity)
         return eSTATUS_SYSTEM_ERROR;
     }
 
-    if(osal_cond_init(&queue->not_empty))
+    if(osal_sem_init(&queue->items, 0))
     {
+        osal_mutex_destroy(&queue->mutex);
         osal_dealloc(queue->buffer);
         return eSTATUS_SYSTEM_ERROR;
     }
@@ -36,33 +90,422 @@ eStatus util_queue_init(Queue* queue, uint32_t capacity)
     return eSTATUS_SUCCESSFUL;
 }
 
-eStatus util_queue_push(Queue* queue, void* element)
+eStatus util_queue_init_ex(Queue* queue, uint32_t capacity, eQueueType type)
+{
+    if(queue == NULL || capacity == 0)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(type > eQUEUE_TYPE_MPSC || capacity > (UINT32_C(1) << 31))
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+    return queue_init(queue, capacity, type, 0);
+}
+
+eStatus util_queue_init_urgent(Queue* queue, uint32_t capacity, uint32_t urgent_capacity)
+{
+    if(queue == NULL || capacity == 0 || urgent_capacity == 0)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    return queue_init(queue, capacity, eQUEUE_TYPE_LOCKED, urgent_capacity);
+}
+
+eStatus util_queue_enable_stamps(Queue* queue)
 {
     if(queue == NULL || queue->buffer == NULL)
     {
         return eSTATUS_NULL_PARAM;
     }
-    
+
+    queue->stamps = osal_alloc(sizeof(uint64_t) * (queue->capacity + queue->urgent.capacity));
+    if(queue->stamps == NULL)
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+uint32_t util_queue_depth(const Queue* queue)
+{
+    if(queue == NULL || queue->buffer == NULL)
+    {
+        return 0;
+    }
+
+    if(queue->type != eQUEUE_TYPE_LOCKED)
+    {
+        return __atomic_load_n(&queue->ring.tail, __ATOMIC_RELAXED) -
+               __atomic_load_n(&queue->ring.head, __ATOMIC_RELAXED);
+    }
+
+    return __atomic_load_n(&queue->size, __ATOMIC_RELAXED) + __atomic_load_n(&queue->urgent.size, __ATOMIC_RELAXED);
+}
+
+/* Stamp slot with the enqueue time, slots past capacity belong to the urgent lane */
+static void queue_stamp(Queue* queue, uint32_t slot)
+{
+    if(queue->stamps != NULL)
+    {
+        queue->stamps[slot] = osal_time_now_ns();
+    }
+}
+
+static void queue_read_stamp(const Queue* queue, uint32_t slot, uint64_t* stamp)
+{
+    if(stamp != NULL)
+    {
+        *stamp = (queue->stamps != NULL) ? queue->stamps[slot] : 0;
+    }
+}
+
+static void queue_note_depth(Queue* queue, uint32_t depth)
+{
+    uint32_t peak = __atomic_load_n(&queue->peak, __ATOMIC_RELAXED);
+    while(depth > peak &&
+          !__atomic_compare_exchange_n(&queue->peak, &peak, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/*
+ * Lock-free rings: head and tail run freely and are masked on access. A
+ * consumer about to sleep raises `sleeping` and re-checks the ring, while a
+ * producer publishes its element and then checks `sleeping`; the fences on
+ * both sides guarantee at least one of them sees the other.
+ */
+static void ring_wake(QueueRing* ring)
+{
+    /* Only the first push after the consumer went to sleep wakes it */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&ring->sleeping, __ATOMIC_RELAXED) &&
+       __atomic_exchange_n(&ring->sleeping, 0, __ATOMIC_RELAXED))
+    {
+        (void)__atomic_fetch_add(&ring->wakeups, 1, __ATOMIC_RELAXED);
+        osal_event_set(&ring->ready);
+    }
+}
+
+/*
+ * SPSC: each side re-reads the other's index only when its cached copy says
+ * full / empty.
+ */
+static eStatus spsc_push(Queue* queue, void* element)
+{
+    QueueRing* ring = &queue->ring;
+    uint32_t tail = ring->tail;
+
+    if(tail - ring->head_cache == queue->capacity)
+    {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if(tail - ring->head_cache == queue->capacity)
+        {
+            return eSTATUS_ACTION_FAILED;
+        }
+    }
+
+    queue->buffer[tail & queue->mask] = element;
+    if(queue->stamps != NULL)
+    {
+        /* Instrumented rings also read the consumer's index for the peak depth */
+        queue_stamp(queue, tail & queue->mask);
+        queue_note_depth(queue, tail + 1 - __atomic_load_n(&ring->head, __ATOMIC_RELAXED));
+    }
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    ring_wake(ring);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+static bool spsc_try_pop(Queue* queue, void** element, uint64_t* stamp)
+{
+    QueueRing* ring = &queue->ring;
+    uint32_t head = ring->head;
+
+    if(head == ring->tail_cache)
+    {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if(head == ring->tail_cache)
+        {
+            return false;
+        }
+    }
+
+    *element = queue->buffer[head & queue->mask];
+    queue_read_stamp(queue, head & queue->mask, stamp);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/*
+ * MPSC (bounded, after D. Vyukov): producers claim a slot by advancing the tail
+ * with a CAS, then publish it by setting its sequence to position + 1. The
+ * consumer hands the slot back to the next lap by setting it to position +
+ * capacity. A claimed but unpublished slot reads as empty to the consumer.
+ */
+static eStatus mpsc_push(Queue* queue, void* element)
+{
+    QueueRing* ring = &queue->ring;
+    uint32_t position = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+
+    for(;;)
+    {
+        uint32_t sequence = __atomic_load_n(&queue->sequence[position & queue->mask], __ATOMIC_ACQUIRE);
+        int32_t lag = (int32_t)(sequence - position);
+
+        if(lag == 0)
+        {
+            if(__atomic_compare_exchange_n(&ring->tail, &position, position + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if(lag < 0)
+        {
+            /* The slot still holds the previous lap's element */
+            return eSTATUS_ACTION_FAILED;
+        }
+        else
+        {
+            position = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    queue->buffer[position & queue->mask] = element;
+    if(queue->stamps != NULL)
+    {
+        queue_stamp(queue, position & queue->mask);
+        queue_note_depth(queue, position + 1 - __atomic_load_n(&ring->head, __ATOMIC_RELAXED));
+    }
+    __atomic_store_n(&queue->sequence[position & queue->mask], position + 1, __ATOMIC_RELEASE);
+    ring_wake(ring);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+static bool mpsc_try_pop(Queue* queue, void** element, uint64_t* stamp)
+{
+    QueueRing* ring = &queue->ring;
+    uint32_t position = ring->head;
+    uint32_t sequence = __atomic_load_n(&queue->sequence[position & queue->mask], __ATOMIC_ACQUIRE);
+
+    if(sequence != position + 1)
+    {
+        return false;
+    }
+
+    *element = queue->buffer[position & queue->mask];
+    queue_read_stamp(queue, position & queue->mask, stamp);
+    __atomic_store_n(&queue->sequence[position & queue->mask], position + queue->capacity, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, position + 1, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+static bool ring_try_pop(Queue* queue, void** element, uint64_t* stamp)
+{
+    return (queue->type == eQUEUE_TYPE_SPSC) ? spsc_try_pop(queue, element, stamp) :
+                                               mpsc_try_pop(queue, element, stamp);
+}
+
+/* Returns true if an element was popped, false if the queue stayed empty */
+static bool ring_pop(Queue* queue, void** element, uint64_t* stamp, bool timed, uint64_t timeout_ms)
+{
+    QueueRing* ring = &queue->ring;
+    uint64_t deadline = timed ? osal_time_now_ns() + timeout_ms * 1000000ull : 0;
+
+    while(!ring_try_pop(queue, element, stamp))
+    {
+        __atomic_store_n(&ring->sleeping, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if(ring_try_pop(queue, element, stamp))
+        {
+            __atomic_store_n(&ring->sleeping, 0, __ATOMIC_RELAXED);
+            break;
+        }
+
+        if(!timed)
+        {
+            osal_event_wait(&ring->ready);
+        }
+        else
+        {
+            uint64_t now = osal_time_now_ns();
+            if(now >= deadline)
+            {
+                __atomic_store_n(&ring->sleeping, 0, __ATOMIC_RELAXED);
+                return false;
+            }
+            /* Round up, waking early would only cost another lap */
+            (void)osal_event_timedwait(&ring->ready, (deadline - now + 999999ull) / 1000000ull);
+        }
+        __atomic_store_n(&ring->sleeping, 0, __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+/* Whether element is already in one of the lanes, called with the mutex held */
+static bool queue_pending(const Queue* queue, const void* element)
+{
+    const QueueLane* lane = &queue->urgent;
+
+    for(uint32_t i = 0; i < queue->size; ++i)
+    {
+        if(queue->buffer[(queue->head + i) % queue->capacity] == element)
+        {
+            return true;
+        }
+    }
+
+    for(uint32_t i = 0; i < lane->size; ++i)
+    {
+        if(lane->buffer[(lane->head + i) % lane->capacity] == element)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static eStatus queue_insert(Queue* queue, void* element, bool coalesce)
+{
+    osal_mutex_lock(&queue->mutex);
+
+    /* A pending copy will be seen by the consumer, merge into it */
+    if(coalesce && queue_pending(queue, element))
+    {
+        __atomic_store_n(&queue->merged, queue->merged + 1, __ATOMIC_RELAXED);
+        osal_mutex_unlock(&queue->mutex);
+        return eSTATUS_SUCCESSFUL;
+    }
+
     /* Make sure the queue is not full */
-    osal_mutex_lock(queue->mutex);
     if(queue->size == queue->capacity)
     {
-        osal_mutex_unlock(queue->mutex);
+        osal_mutex_unlock(&queue->mutex);
         return eSTATUS_ACTION_FAILED;
     }
 
     /* Insert an element */
     queue->buffer[queue->tail] = element;
+    queue_stamp(queue, queue->tail);
     queue->tail = (queue->tail + 1) % queue->capacity;
     queue->size++;
+    queue_note_depth(queue, queue->size + queue->urgent.size);
+    osal_mutex_unlock(&queue->mutex);
+
+    /* Count the new element, waking the consumer only if it sleeps */
+    osal_sem_post(&queue->items);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus util_queue_push(Queue* queue, void* element)
+{
+    if(queue == NULL || queue->buffer == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(queue->type == eQUEUE_TYPE_SPSC)
+    {
+        return spsc_push(queue, element);
+    }
 
-    /* Signal the conditional variable (not empty) */
-    osal_cond_signal(queue->not_empty);
-    osal_mutex_unlock(queue->mutex);
+    if(queue->type == eQUEUE_TYPE_MPSC)
+    {
+        return mpsc_push(queue, element);
+    }
+
+    return queue_insert(queue, element, false);
+}
+
+eStatus util_queue_push_coalesced(Queue* queue, void* element)
+{
+    if(queue == NULL || queue->buffer == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    /* The lock-free rings can't be searched while producers write them */
+    if(queue->type != eQUEUE_TYPE_LOCKED)
+    {
+        return util_queue_push(queue, element);
+    }
+
+    return queue_insert(queue, element, true);
+}
+
+eStatus util_queue_push_urgent(Queue* queue, void* element)
+{
+    if(queue == NULL || queue->buffer == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    QueueLane* lane = &queue->urgent;
+    if(lane->capacity == 0)
+    {
+        return util_queue_push(queue, element);
+    }
+
+    osal_mutex_lock(&queue->mutex);
+    if(lane->size == lane->capacity)
+    {
+        osal_mutex_unlock(&queue->mutex);
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    lane->buffer[lane->tail] = element;
+    queue_stamp(queue, queue->capacity + lane->tail);
+    lane->tail = (lane->tail + 1) % lane->capacity;
+    __atomic_store_n(&lane->size, lane->size + 1, __ATOMIC_RELAXED);
+    queue_note_depth(queue, queue->size + lane->size);
+    osal_mutex_unlock(&queue->mutex);
+
+    osal_sem_post(&queue->items);
 
     return eSTATUS_SUCCESSFUL;
 }
 
+/* Extract count elements, urgent ones first, the caller already took them from the items count */
+static void queue_extract(Queue* queue, void** elements, uint64_t* stamps, uint32_t count)
+{
+    QueueLane* lane = &queue->urgent;
+
+    osal_mutex_lock(&queue->mutex);
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        uint64_t* stamp = (stamps != NULL) ? &stamps[i] : NULL;
+        if(lane->size != 0)
+        {
+            elements[i] = lane->buffer[lane->head];
+            queue_read_stamp(queue, queue->capacity + lane->head, stamp);
+            lane->head = (lane->head + 1) % lane->capacity;
+            __atomic_store_n(&lane->size, lane->size - 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            elements[i] = queue->buffer[queue->head];
+            queue_read_stamp(queue, queue->head, stamp);
+            queue->head = (queue->head + 1) % queue->capacity;
+            __atomic_store_n(&queue->size, queue->size - 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    osal_mutex_unlock(&queue->mutex);
+}
+
 eStatus util_queue_pop(Queue* queue, void** element)
 {
     if(queue == NULL || queue->buffer == NULL || element == NULL)
@@ -70,29 +513,153 @@ eStatus util_queue_pop(Queue* queue, void** element)
         return eSTATUS_NULL_PARAM;
     }
 
+    if(queue->type != eQUEUE_TYPE_LOCKED)
+    {
+        (void)ring_pop(queue, element, NULL, false, 0);
+        return eSTATUS_SUCCESSFUL;
+    }
+
     /* Block the calling thread if the queue is empty */
-    osal_mutex_lock(queue->mutex);
-    while(queue->size == 0)
+    osal_sem_wait(&queue->items);
+    queue_extract(queue, element, NULL, 1);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus util_queue_pop_timeout(Queue* queue, void** element, uint64_t timeout_ms)
+{
+    if(queue == NULL || queue->buffer == NULL || element == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+
+    if(queue->type != eQUEUE_TYPE_LOCKED)
+    {
+        return ring_pop(queue, element, NULL, true, timeout_ms) ? eSTATUS_SUCCESSFUL : eSTATUS_TIMEOUT;
+    }
+
+    /* Block the calling thread for up to timeout_ms if the queue is empty */
+    if(osal_sem_timedwait(&queue->items, timeout_ms) == eSTATUS_TIMEOUT)
+    {
+        return eSTATUS_TIMEOUT;
+    }
+    queue_extract(queue, element, NULL, 1);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+eStatus util_queue_pop_urgent(Queue* queue, void** element, uint64_t* stamp)
+{
+    if(queue == NULL || queue->buffer == NULL || element == NULL)
     {
-        osal_cond_wait(queue->not_empty, queue->mutex);
+        return eSTATUS_NULL_PARAM;
+    }
+
+    /* Only the consumer removes elements, so a non-empty lane stays non-empty. The
+     * items count may still lag a push in progress, then the next pop gets it */
+    if(__atomic_load_n(&queue->urgent.size, __ATOMIC_RELAXED) == 0 ||
+       osal_sem_trywait(&queue->items) != eSTATUS_SUCCESSFUL)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+    queue_extract(queue, element, stamp, 1);
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+/* A timed pop with a 0 ms timeout doesn't wait at all */
+static eStatus queue_pop_batch(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                               uint32_t* count, bool timed, uint64_t timeout_ms)
+{
+    if(queue == NULL || queue->buffer == NULL || elements == NULL || count == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
     }
 
-    /* Extract an element */
-    *element = queue->buffer[queue->head];
-    queue->head = (queue->head + 1) % queue->capacity;
-    queue->size--;
+    if(max_count == 0)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
 
-    osal_mutex_unlock(queue->mutex);
+    uint32_t taken = 1;
+    *count = 0;
 
+    bool polled = timed && timeout_ms == 0;
+    if(queue->type != eQUEUE_TYPE_LOCKED)
+    {
+        if(polled ? !ring_try_pop(queue, &elements[0], stamps) :
+                    !ring_pop(queue, &elements[0], stamps, timed, timeout_ms))
+        {
+            return eSTATUS_TIMEOUT;
+        }
+        while(taken < max_count && ring_try_pop(queue, &elements[taken], (stamps != NULL) ? &stamps[taken] : NULL))
+        {
+            taken++;
+        }
+    }
+    else
+    {
+        /* Block for the first element only, then claim whatever else is already counted */
+        if(!timed)
+        {
+            osal_sem_wait(&queue->items);
+        }
+        else if(polled)
+        {
+            if(osal_sem_trywait(&queue->items) != eSTATUS_SUCCESSFUL)
+            {
+                return eSTATUS_TIMEOUT;
+            }
+        }
+        else if(osal_sem_timedwait(&queue->items, timeout_ms) == eSTATUS_TIMEOUT)
+        {
+            return eSTATUS_TIMEOUT;
+        }
+        while(taken < max_count && osal_sem_trywait(&queue->items) == eSTATUS_SUCCESSFUL)
+        {
+            taken++;
+        }
+        queue_extract(queue, elements, stamps, taken);
+    }
+
+    *count = taken;
     return eSTATUS_SUCCESSFUL;
 }
 
+eStatus util_queue_pop_batch(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                             uint32_t* count)
+{
+    return queue_pop_batch(queue, elements, stamps, max_count, count, false, 0);
+}
+
+eStatus util_queue_pop_batch_timeout(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                                     uint32_t* count, uint64_t timeout_ms)
+{
+    return queue_pop_batch(queue, elements, stamps, max_count, count, true, timeout_ms);
+}
+
+eStatus util_queue_try_pop_batch(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                                 uint32_t* count)
+{
+    eStatus status = queue_pop_batch(queue, elements, stamps, max_count, count, true, 0);
+
+    return (status == eSTATUS_TIMEOUT) ? eSTATUS_ACTION_FAILED : status;
+}
+
 void util_queue_delete(Queue* queue)
 {
     if(queue != NULL)
     {
-        osal_mutex_destroy(queue->mutex);
-        osal_cond_destroy(queue->not_empty);
+        if(queue->type != eQUEUE_TYPE_LOCKED)
+        {
+            osal_event_destroy(&queue->ring.ready);
+        }
+        else
+        {
+            osal_mutex_destroy(&queue->mutex);
+            osal_sem_destroy(&queue->items);
+        }
+        osal_dealloc(queue->stamps);
         osal_dealloc(queue->buffer);
     }
-}
\ No newline at end of file
+}
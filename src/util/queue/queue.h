@@ -6,18 +6,59 @@
 
 /* User library includes */
 #include "osal/osal.h"
+#include "util/queue/queue_config.h"
 #include "status.h"
 
-typedef struct 
+typedef enum eQueueType
+{
+    eQUEUE_TYPE_LOCKED,     // mutex protected, any number of producers and consumers
+    eQUEUE_TYPE_SPSC,       // lock-free, a single producer and a single consumer thread
+    eQUEUE_TYPE_MPSC        // lock-free, any number of producers and a single consumer thread
+} eQueueType;
+
+/* State of the lock-free ring. The producer and the consumer each own a cache
+ * line, so they only share one when the consumer is about to sleep */
+typedef struct
+{
+    uint32_t  tail;         // next slot to write, claimed by the producers
+    uint32_t  head_cache;   // last head seen by the producer (SPSC)
+    uint8_t   producer_pad[eQUEUE_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+    uint32_t  head;         // next slot to read, consumer only
+    uint32_t  tail_cache;   // last tail seen by the consumer (SPSC)
+    uint8_t   consumer_pad[eQUEUE_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+    uint32_t  sleeping;     // set while the consumer waits on ready
+    uint32_t  wakeups;      // times the producer had to wake the consumer
+    OsalEvent ready;
+} QueueRing;
+
+/* Second FIFO of a locked queue, popped ahead of the main one */
+typedef struct
 {
     void**   buffer;
-    uint32_t capacity;
+    uint32_t capacity;      // 0 if the queue has no urgent lane
     uint32_t head;
     uint32_t tail;
-    uint32_t size;
+    uint32_t size;          // written under the mutex, peeked without it by the consumer
+} QueueLane;
 
-    void* mutex;
-    void* not_empty;
+typedef struct 
+{
+    void**     buffer;
+    uint32_t*  sequence;    // per-slot publication counters, MPSC only
+    uint64_t*  stamps;      // per-slot enqueue times, NULL unless util_queue_enable_stamps was called
+    uint32_t   capacity;
+    uint32_t   head;
+    uint32_t   tail;
+    uint32_t   size;
+    eQueueType type;
+    uint32_t   mask;        // capacity - 1, lock-free types only
+    uint32_t   merged;      // pushes merged into a pending element, eQUEUE_TYPE_LOCKED only
+    uint32_t   peak;        // most elements queued at once, lock-free types only track it with stamps
+    QueueLane  urgent;      // eQUEUE_TYPE_LOCKED only
+
+    OsalMutex mutex;
+    OsalSem   items;
+    QueueRing ring;
 } Queue;
 
 /**
@@ -27,10 +68,62 @@ typedef struct
  * @returns A value from @ref eStatus.
  * @retval  eSTATUS_SUCCESSFUL      successful execution
  * @retval  eSTATUS_NULL_PARAM      queue is NULL or capacity is 0
- * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory or initiate the mutex / conditional variable
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory or initiate the mutex / semaphore
  */
 eStatus util_queue_init(Queue* queue, uint32_t capacity);
 
+/**
+ * @brief   Initialize a queue of a given type.
+ * @details The lock-free types round capacity up to a power of two.
+ * @param   queue A pointer to an uninitialized Queue struct.
+ * @param   capacity The number of slots the queue will contain.
+ * @param   type A value from @ref eQueueType.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      queue is NULL or capacity is 0
+ * @retval  eSTATUS_INVALID_VALUE   type is unknown or capacity is above 2^31
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory or initiate the synchronization objects
+ */
+eStatus util_queue_init_ex(Queue* queue, uint32_t capacity, eQueueType type);
+
+/**
+ * @brief   Initialize a locked queue with an urgent lane.
+ * @details Elements pushed with @ref util_queue_push_urgent are popped before
+ *          any element already in the main FIFO, in the order they were pushed.
+ *          Both lanes share the mutex and the items count, so the consumer
+ *          waits on both at once.
+ * @param   queue A pointer to an uninitialized Queue struct.
+ * @param   capacity The number of slots in the main FIFO.
+ * @param   urgent_capacity The number of slots in the urgent lane.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      queue is NULL or capacity or urgent_capacity are 0
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory or initiate the mutex / semaphore
+ */
+eStatus util_queue_init_urgent(Queue* queue, uint32_t capacity, uint32_t urgent_capacity);
+
+/**
+ * @brief   Record the enqueue time of every element.
+ * @details Must be called before the first push. The times are returned by
+ *          the batch and urgent pops. Lock-free types also track their peak
+ *          depth once stamped, at the cost of reading the consumer's index
+ *          on every push.
+ * @param   queue A pointer to an initialized Queue.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      queue is NULL or uninitialized
+ * @retval  eSTATUS_SYSTEM_ERROR    system couldn't allocate memory
+ */
+eStatus util_queue_enable_stamps(Queue* queue);
+
+/**
+ * @brief   Number of elements in a queue, in both lanes.
+ * @details Only a snapshot if other threads push or pop meanwhile.
+ * @param   queue A pointer to an initialized Queue.
+ * @returns The number of queued elements, 0 if queue is NULL or uninitialized.
+ */
+uint32_t util_queue_depth(const Queue* queue);
+
 /**
  * @brief   Add an element to a queue.
  * @param   queue A pointer to an initialized Queue.
@@ -42,6 +135,48 @@ eStatus util_queue_init(Queue* queue, uint32_t capacity);
  */
 eStatus util_queue_push(Queue* queue, void* element);
 
+/**
+ * @brief   Add an element to a queue unless it is already pending.
+ * @details Meant for idempotent elements such as static events: if the same
+ *          element is still waiting in either lane, the push is merged into
+ *          it and counted in the queue's merged counter instead of taking a
+ *          slot. The search is linear in the pending elements. The lock-free
+ *          types can't be searched and push normally.
+ * @param   queue A pointer to an initialized Queue.
+ * @param   element An element to be added to the queue.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      the element was added or merged
+ * @retval  eSTATUS_NULL_PARAM      queue is NULL or uninitialized
+ * @retval  eSTATUS_ACTION_FAILED   queue is full and the element isn't pending
+ */
+eStatus util_queue_push_coalesced(Queue* queue, void* element);
+
+/**
+ * @brief   Add an element to the urgent lane of a queue.
+ * @details Falls back to @ref util_queue_push if the queue has no urgent lane.
+ * @param   queue A pointer to an initialized Queue.
+ * @param   element An element to be added to the queue.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      queue is NULL or uninitialized
+ * @retval  eSTATUS_ACTION_FAILED   the lane is full
+ */
+eStatus util_queue_push_urgent(Queue* queue, void* element);
+
+/**
+ * @brief   Remove an element from the urgent lane of a queue without blocking.
+ * @details Lets the consumer check for urgent elements between the elements of
+ *          a batch. Costs a single load while the lane is empty.
+ * @param   queue A pointer to an initialized Queue.
+ * @param   element A pointer to an element to be removed from the queue.
+ * @param   stamp Set to the element's enqueue time (0 without stamps), may be NULL.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      element is NULL or queue is NULL or uninitialized
+ * @retval  eSTATUS_ACTION_FAILED   the lane is empty or the queue has none
+ */
+eStatus util_queue_pop_urgent(Queue* queue, void** element, uint64_t* stamp);
+
 /**
  * @brief   Remove an element from a queue.
  * @param   queue A pointer to an initialized Queue.
@@ -52,9 +187,76 @@ eStatus util_queue_push(Queue* queue, void* element);
  */
 eStatus util_queue_pop(Queue* queue, void** element);
 
+/**
+ * @brief   Remove an element from a queue, waiting for one up to a timeout.
+ * @param   queue A pointer to an initialized Queue.
+ * @param   element A pointer to an element to be removed from the queue.
+ * @param   timeout_ms Maximal wait in miliseconds on the monotonic clock.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      element is NULL or queue is NULL or uninitialized
+ * @retval  eSTATUS_TIMEOUT         the queue stayed empty for timeout_ms
+ */
+eStatus util_queue_pop_timeout(Queue* queue, void** element, uint64_t timeout_ms);
+
+/**
+ * @brief   Remove up to max_count elements from a queue at once.
+ * @details Blocks until the queue holds at least one element, then takes
+ *          every element already there, up to max_count, in a single pass
+ *          (one lock acquisition for eQUEUE_TYPE_LOCKED).
+ * @param   queue A pointer to an initialized Queue.
+ * @param   elements An array of at least max_count elements to be filled.
+ * @param   stamps An array of at least max_count enqueue times (0 without stamps), may be NULL.
+ * @param   max_count The most elements to remove.
+ * @param   count Set to the number of elements removed.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution, count is at least 1
+ * @retval  eSTATUS_NULL_PARAM      elements or count are NULL or queue is NULL or uninitialized
+ * @retval  eSTATUS_INVALID_VALUE   max_count is 0
+ */
+eStatus util_queue_pop_batch(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                             uint32_t* count);
+
+/**
+ * @brief   Remove up to max_count elements from a queue at once, waiting for
+ *          the first one up to a timeout.
+ * @param   queue A pointer to an initialized Queue.
+ * @param   elements An array of at least max_count elements to be filled.
+ * @param   stamps An array of at least max_count enqueue times (0 without stamps), may be NULL.
+ * @param   max_count The most elements to remove.
+ * @param   count Set to the number of elements removed, 0 on timeout.
+ * @param   timeout_ms Maximal wait in miliseconds on the monotonic clock.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution, count is at least 1
+ * @retval  eSTATUS_NULL_PARAM      elements or count are NULL or queue is NULL or uninitialized
+ * @retval  eSTATUS_INVALID_VALUE   max_count is 0
+ * @retval  eSTATUS_TIMEOUT         the queue stayed empty for timeout_ms
+ */
+eStatus util_queue_pop_batch_timeout(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                                     uint32_t* count, uint64_t timeout_ms);
+
+/**
+ * @brief   Remove up to max_count elements from a queue at once, without
+ *          waiting.
+ * @details For consumers that are told about new elements another way and
+ *          must not block, such as Active Objects run by the executor.
+ * @param   queue A pointer to an initialized Queue.
+ * @param   elements An array of at least max_count elements to be filled.
+ * @param   stamps An array of at least max_count enqueue times (0 without stamps), may be NULL.
+ * @param   max_count The most elements to remove.
+ * @param   count Set to the number of elements removed, 0 if the queue is empty.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution, count is at least 1
+ * @retval  eSTATUS_NULL_PARAM      elements or count are NULL or queue is NULL or uninitialized
+ * @retval  eSTATUS_INVALID_VALUE   max_count is 0
+ * @retval  eSTATUS_ACTION_FAILED   the queue is empty
+ */
+eStatus util_queue_try_pop_batch(Queue* queue, void** elements, uint64_t* stamps, uint32_t max_count,
+                                 uint32_t* count);
+
 /**
  * @brief   Delete a queue.
- * @details Frees the memory and destroys the mutex and variable condition.
+ * @details Frees the memory and destroys the mutex and semaphore.
  * @param   queue A pointer to an initialized Queue.
  */
 void util_queue_delete(Queue* queue);
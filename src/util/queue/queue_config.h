@@ -0,0 +1,9 @@
+#ifndef UTIL_QUEUE_CONFIG_H
+#define UTIL_QUEUE_CONFIG_H
+
+typedef enum eQueueConfig
+{
+    eQUEUE_CACHE_LINE_SIZE = 64
+} eQueueConfig;
+
+#endif
@@ -0,0 +1,192 @@
+#include "supervisor.h"
+
+/* Standard library includes */
+#include <stddef.h>
+#include <string.h>
+
+typedef struct
+{
+    SupervisorProbeFP  probe;
+    SupervisorNotifyFP notify;
+    uint64_t           deadline_ns;
+    uint64_t           events;          // AO events counter at the last check
+    uint64_t           progress_ns;     // last check that saw the AO take events, or nothing queued
+    uint32_t           id;
+    bool               stalled;
+    uint8_t            reserved[3];
+} SupervisorWatch;
+
+static SupervisorWatch watches[eSUPERVISOR_WATCH_MAX_COUNT];
+static uint32_t        watch_count;
+static SupervisorStats supervisor_stats;
+#ifdef OSAL_EVENT_LOOP
+static OsalTimer       supervisor_timer;
+static TimerArg        supervisor_timer_arg;
+#else
+static OsalThread      supervisor_thread;
+static OsalEvent       stop_event;
+static uint64_t        supervisor_period_ms;
+#endif
+static bool            running;
+
+#ifdef OSAL_EVENT_LOOP
+/* The loop thread runs the checks between two task runs, like any other timer */
+static void supervisor_tick(void* arg)
+{
+    (void)arg;
+    util_supervisor_check();
+}
+#else
+static void* supervisor_entry(void* arg)
+{
+    (void)arg;
+
+    /* The event is only set to stop */
+    while(osal_event_timedwait(&stop_event, supervisor_period_ms) == eSTATUS_TIMEOUT)
+    {
+        util_supervisor_check();
+    }
+
+    return NULL;
+}
+#endif
+
+eStatus util_supervisor_watch(uint32_t id, uint64_t deadline_ms, SupervisorProbeFP probe,
+                              SupervisorNotifyFP notify)
+{
+    if(probe == NULL || notify == NULL)
+    {
+        return eSTATUS_NULL_PARAM;
+    }
+    if(deadline_ms == 0)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+    if(watch_count == eSUPERVISOR_WATCH_MAX_COUNT)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+
+    SupervisorWatch* watch = &watches[watch_count++];
+    memset(watch, 0, sizeof(*watch));
+    watch->probe = probe;
+    watch->notify = notify;
+    watch->deadline_ns = deadline_ms * 1000000u;
+    watch->id = id;
+    watch->progress_ns = osal_time_now_ns();
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void util_supervisor_check(void)
+{
+    for(uint32_t i = 0; i < watch_count; ++i)
+    {
+        SupervisorWatch* watch = &watches[i];
+        ActiveObjectStats stats;
+        if(watch->probe(watch->id, &stats) != eSTATUS_SUCCESSFUL)
+        {
+            continue;
+        }
+
+        /* A restarted AO counts from 0 again, any change is progress */
+        uint64_t now = osal_time_now_ns();
+        if(stats.events != watch->events || stats.depth == 0)
+        {
+            watch->events = stats.events;
+            watch->progress_ns = now;
+        }
+
+        bool stalled = stats.busy_ns > watch->deadline_ns || now - watch->progress_ns > watch->deadline_ns;
+        if(stalled && !watch->stalled)
+        {
+            watch->stalled = true;
+            __atomic_store_n(&supervisor_stats.stalls, supervisor_stats.stalls + 1, __ATOMIC_RELAXED);
+            watch->notify(watch->id, true);
+        }
+        else if(!stalled && watch->stalled)
+        {
+            watch->stalled = false;
+            __atomic_store_n(&supervisor_stats.recoveries, supervisor_stats.recoveries + 1, __ATOMIC_RELAXED);
+            watch->notify(watch->id, false);
+        }
+    }
+
+    __atomic_store_n(&supervisor_stats.checks, supervisor_stats.checks + 1, __ATOMIC_RELAXED);
+}
+
+eStatus util_supervisor_start(uint64_t period_ms)
+{
+#ifndef OSAL_EVENT_LOOP
+    static const OsalThreadAttr attr = {
+        .affinity_mask  = eSUPERVISOR_THREAD_AFFINITY_MASK,
+        .name           = SUPERVISOR_THREAD_NAME,
+        .stack_size     = eSUPERVISOR_THREAD_STACK_SIZE,
+        .policy         = (eThreadPolicy)eSUPERVISOR_THREAD_POLICY,
+        .priority       = eSUPERVISOR_THREAD_PRIORITY
+    };
+#endif
+
+    if(period_ms == 0)
+    {
+        return eSTATUS_INVALID_VALUE;
+    }
+
+#ifdef OSAL_EVENT_LOOP
+    supervisor_timer_arg.handler = supervisor_tick;
+    supervisor_timer_arg.arg = NULL;
+    if(osal_timer_init(&supervisor_timer, &supervisor_timer_arg))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    if(osal_timer_arm(&supervisor_timer, period_ms, eTIMER_TYPE_REPEAT))
+    {
+        osal_timer_destroy(&supervisor_timer);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+#else
+    if(osal_event_init(&stop_event))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    supervisor_period_ms = period_ms;
+    if(osal_thread_create_ex(&supervisor_thread, supervisor_entry, NULL, &attr))
+    {
+        osal_event_destroy(&stop_event);
+        return eSTATUS_SYSTEM_ERROR;
+    }
+#endif
+    running = true;
+
+    return eSTATUS_SUCCESSFUL;
+}
+
+void util_supervisor_get_stats(SupervisorStats* stats)
+{
+    if(stats != NULL)
+    {
+        stats->checks = __atomic_load_n(&supervisor_stats.checks, __ATOMIC_RELAXED);
+        stats->stalls = __atomic_load_n(&supervisor_stats.stalls, __ATOMIC_RELAXED);
+        stats->recoveries = __atomic_load_n(&supervisor_stats.recoveries, __ATOMIC_RELAXED);
+    }
+}
+
+void util_supervisor_stop(void)
+{
+    if(running)
+    {
+#ifdef OSAL_EVENT_LOOP
+        osal_timer_destroy(&supervisor_timer);
+#else
+        osal_event_set(&stop_event);
+        osal_thread_join(&supervisor_thread);
+        osal_event_destroy(&stop_event);
+#endif
+        running = false;
+    }
+
+    watch_count = 0;
+    memset(&supervisor_stats, 0, sizeof(supervisor_stats));
+}
@@ -0,0 +1,96 @@
+#ifndef UTIL_SUPERVISOR_H
+#define UTIL_SUPERVISOR_H
+
+/* Standard library includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* User library includes */
+#include "util/supervisor/supervisor_config.h"
+#include "util/active_object/active_object.h"
+#include "status.h"
+
+/*
+    Watches Active Objects for stalls from a thread of its own. A watched AO
+    is stalled when its handler has been running for longer than the watch's
+    deadline, or when events have been waiting in its queue for that long
+    without the AO taking any. The owner is told once when a stall starts and
+    once when the AO takes events again.
+
+    The callbacks run on the supervisor thread, which checks nothing else
+    while they run. With OSAL_EVENT_LOOP there is no such thread, the checks
+    are a repeating timer of the loop and run between two AO runs. They see
+    the queues that wait too long, but a handler that never returns holds
+    the loop, and the checks, with it.
+*/
+
+/**
+ * @brief   Reads the stats of a watched AO.
+ * @param   id The id given to @ref util_supervisor_watch.
+ * @param   stats A pointer to the struct to be filled.
+ * @returns eSTATUS_SUCCESSFUL when stats was filled, the check is skipped otherwise.
+ */
+typedef eStatus (*SupervisorProbeFP)(uint32_t id, ActiveObjectStats* stats);
+
+/**
+ * @brief   Called when a watched AO stalls, and when it recovers.
+ * @param   id The id given to @ref util_supervisor_watch.
+ * @param   stalled true when the stall starts, false once the AO takes events again.
+ */
+typedef void (*SupervisorNotifyFP)(uint32_t id, bool stalled);
+
+typedef struct
+{
+    uint64_t checks;        // passes over the watched AOs
+    uint64_t stalls;        // stalls detected
+    uint64_t recoveries;    // stalled AOs that took events again
+} SupervisorStats;
+
+/**
+ * @brief   Watch an Active Object.
+ * @details Not to be called while the supervisor runs.
+ * @param   id Passed to the callbacks, for the owner to tell its AOs apart.
+ * @param   deadline_ms How long a handler may run, or an event wait in the queue.
+ * @param   probe Reads the AO's stats, see @ref util_active_object_get_stats.
+ * @param   notify Told when a stall starts and ends.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_NULL_PARAM      probe or notify are NULL
+ * @retval  eSTATUS_INVALID_VALUE   deadline_ms is 0
+ * @retval  eSTATUS_ACTION_FAILED   eSUPERVISOR_WATCH_MAX_COUNT AOs are already watched
+ */
+eStatus util_supervisor_watch(uint32_t id, uint64_t deadline_ms, SupervisorProbeFP probe,
+                              SupervisorNotifyFP notify);
+
+/**
+ * @brief   Check the watched AOs once.
+ * @details Done every period_ms by the supervisor thread. Queue waits are
+ *          measured from the first check that saw them, so they are known
+ *          to the check period.
+ */
+void util_supervisor_check(void);
+
+/**
+ * @brief   Start the supervisor thread.
+ * @details With OSAL_EVENT_LOOP a timer of the loop is armed instead.
+ * @param   period_ms The time between two checks.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_INVALID_VALUE   period_ms is 0
+ * @retval  eSTATUS_SYSTEM_ERROR    event, thread or timer creation failed
+ */
+eStatus util_supervisor_start(uint64_t period_ms);
+
+/**
+ * @brief   Read the supervisor's counters.
+ * @param   stats A pointer to the struct to be filled.
+ */
+void util_supervisor_get_stats(SupervisorStats* stats);
+
+/**
+ * @brief   Stop the supervisor thread and forget the watched AOs.
+ * @details Waits for the callbacks in progress. Not to be called from one.
+ */
+void util_supervisor_stop(void);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef UTIL_SUPERVISOR_CONFIG_H
+#define UTIL_SUPERVISOR_CONFIG_H
+
+/* User library includes */
+#include "osal/osal.h"
+
+#define SUPERVISOR_THREAD_NAME "supervisor"
+
+/* Above the real-time AOs, a spinning handler mustn't keep the checks from running */
+typedef enum eSupervisorConfig
+{
+    eSUPERVISOR_WATCH_MAX_COUNT = 8,
+    eSUPERVISOR_PERIOD_MS = 100,            // time between two checks, started by main
+    eSUPERVISOR_THREAD_POLICY = eTHREAD_POLICY_FIFO,
+    eSUPERVISOR_THREAD_PRIORITY = 80,
+    eSUPERVISOR_THREAD_AFFINITY_MASK = 0,
+    eSUPERVISOR_THREAD_STACK_SIZE = 0
+} eSupervisorConfig;
+
+#endif
@@ -0,0 +1,440 @@
+#include "trace.h"
+
+/* Standard library includes */
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+/* Linux Specific includes */
+#include <sys/syscall.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+/* User library includes */
+#include "osal/osal.h"
+
+typedef struct
+{
+    uint64_t timestamp;
+    uint64_t object;
+    uint64_t detail;
+    uint32_t kind;
+    uint32_t value;
+} TraceRecord;
+
+/* Written by its thread only. head counts the records ever written, record n
+ * lives in records[n % eTRACE_RING_SIZE]. A ring given up by an exited thread
+ * keeps its records until another thread takes it over, from first on */
+typedef struct
+{
+    TraceRecord records[eTRACE_RING_SIZE];
+    uint64_t    head;
+    uint64_t    first;  // the owner's first record
+    uint32_t    tid;    // the thread the records from first on belong to
+    uint32_t    owner;  // tid of the thread recording into the ring, 0 once it exited
+} TraceRing;
+
+/* How each kind is exported, NULL argument names are left out */
+typedef struct
+{
+    const char* name;
+    const char* phase;
+    const char* object_arg;
+    const char* value_arg;
+    const char* detail_arg;
+    bool        detail_hex;
+    uint8_t     reserved[7];
+} TraceKindFormat;
+
+typedef struct
+{
+    int      fd;
+    uint32_t length;
+    bool     failed;
+    uint8_t  reserved[3];
+    char     buffer[eTRACE_WRITER_BUFFER_SIZE];
+} TraceWriter;
+
+static const TraceKindFormat kind_formats[eTRACE_KIND_COUNT] = {
+    [eTRACE_KIND_PUBLISH]        = { "publish",     "i", NULL,  "type",   "ao",      false, { 0 } },
+    [eTRACE_KIND_POST]           = { "post",        "i", "ao",  "type",   "status",  false, { 0 } },
+    [eTRACE_KIND_DISPATCH_BEGIN] = { "dispatch",    "B", "ao",  "type",   "wait_ns", false, { 0 } },
+    [eTRACE_KIND_DISPATCH_END]   = { "dispatch",    "E", NULL,  NULL,     NULL,      false, { 0 } },
+    [eTRACE_KIND_TRANSITION]     = { "transition",  "i", "fsm", NULL,     "to",      true,  { 0 } },
+    [eTRACE_KIND_IO_COMPLETE]    = { "io_complete", "i", "arg", "result", NULL,      false, { 0 } }
+};
+
+static TraceRing rings[eTRACE_THREAD_MAX_COUNT];
+static uint32_t  ring_count;    // rings taken, may run past eTRACE_THREAD_MAX_COUNT
+static uint32_t  generation;    // bumped by util_trace_init so that threads take a new ring
+static bool      enabled;
+
+/* Its destructor gives a thread's ring up when the thread exits */
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  ring_key;
+static bool           ring_key_ready;
+
+static __thread TraceRing* thread_ring;
+static __thread uint32_t   thread_generation;
+
+static void trace_ring_release(void* ring)
+{
+    /* A ring handed out again by a later util_trace_init belongs to another thread */
+    uint32_t owner = (uint32_t)syscall(SYS_gettid);
+    (void)__atomic_compare_exchange_n(&((TraceRing*)ring)->owner, &owner, 0, false, __ATOMIC_RELEASE,
+                                      __ATOMIC_RELAXED);
+}
+
+static void trace_ring_key_create(void)
+{
+    ring_key_ready = (pthread_key_create(&ring_key, trace_ring_release) == 0);
+}
+
+static bool trace_ring_claim(TraceRing* ring, uint32_t tid)
+{
+    uint32_t free_owner = 0;
+    if(!__atomic_compare_exchange_n(&ring->owner, &free_owner, tid, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        return false;
+    }
+
+    __atomic_store_n(&ring->first, __atomic_load_n(&ring->head, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tid, tid, __ATOMIC_RELEASE);
+    if(ring_key_ready)
+    {
+        (void)pthread_setspecific(ring_key, ring);
+    }
+
+    return true;
+}
+
+static TraceRing* trace_thread_ring(void)
+{
+    uint32_t current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+    if(thread_generation != current)
+    {
+        thread_generation = current;
+        thread_ring = NULL;
+
+        /* An unused ring first, so the records of exited threads last longer */
+        uint32_t tid = (uint32_t)syscall(SYS_gettid);
+        uint32_t index = __atomic_fetch_add(&ring_count, 1, __ATOMIC_RELAXED);
+        if(index < eTRACE_THREAD_MAX_COUNT && trace_ring_claim(&rings[index], tid))
+        {
+            thread_ring = &rings[index];
+        }
+        for(uint32_t i = 0; thread_ring == NULL && i < eTRACE_THREAD_MAX_COUNT; ++i)
+        {
+            if(trace_ring_claim(&rings[i], tid))
+            {
+                thread_ring = &rings[i];
+            }
+        }
+    }
+
+    return thread_ring;
+}
+
+void util_trace_init(void)
+{
+    (void)pthread_once(&ring_key_once, trace_ring_key_create);
+
+    __atomic_store_n(&enabled, false, __ATOMIC_RELAXED);
+    for(uint32_t i = 0; i < eTRACE_THREAD_MAX_COUNT; ++i)
+    {
+        __atomic_store_n(&rings[i].head, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&rings[i].first, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&rings[i].owner, 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&ring_count, 0, __ATOMIC_RELAXED);
+    (void)__atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&enabled, true, __ATOMIC_RELEASE);
+}
+
+void util_trace_enable(bool enable)
+{
+    __atomic_store_n(&enabled, enable, __ATOMIC_RELEASE);
+}
+
+void util_trace_record_at(eTraceKind kind, const void* object, uint32_t value, uint64_t detail,
+                          uint64_t timestamp_ns)
+{
+    if(!__atomic_load_n(&enabled, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    TraceRing* ring = trace_thread_ring();
+    if(ring == NULL)
+    {
+        return;
+    }
+
+    uint64_t head = ring->head;
+    TraceRecord* record = &ring->records[head & (eTRACE_RING_SIZE - 1)];
+
+    /* Keeps the slot's new fields from being seen before the previous head,
+     * so an exporter that reads them also sees the record as overwritten */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&record->timestamp, timestamp_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->object, (uint64_t)(uintptr_t)object, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->detail, detail, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->kind, (uint32_t)kind, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->value, value, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void util_trace_record(eTraceKind kind, const void* object, uint32_t value, uint64_t detail)
+{
+    if(__atomic_load_n(&enabled, __ATOMIC_RELAXED))
+    {
+        util_trace_record_at(kind, object, value, detail, osal_time_now_ns());
+    }
+}
+
+/* ------------------ Export, async-signal-safe from here on ----------------- */
+
+static void writer_flush(TraceWriter* writer)
+{
+    uint32_t offset = 0;
+    while(offset < writer->length && !writer->failed)
+    {
+        ssize_t written = write(writer->fd, writer->buffer + offset, writer->length - offset);
+        if(written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(written <= 0)
+        {
+            writer->failed = true;
+            break;
+        }
+        offset += (uint32_t)written;
+    }
+    writer->length = 0;
+}
+
+static void writer_put(TraceWriter* writer, const char* text)
+{
+    for(; *text != '\0'; ++text)
+    {
+        if(writer->length == eTRACE_WRITER_BUFFER_SIZE)
+        {
+            writer_flush(writer);
+        }
+        writer->buffer[writer->length++] = *text;
+    }
+}
+
+static void writer_put_u64(TraceWriter* writer, uint64_t number, uint32_t base, uint32_t min_digits)
+{
+    static const char digits[] = "0123456789abcdef";
+    char text[24];
+    uint32_t position = sizeof(text) - 1;
+
+    text[position] = '\0';
+    do
+    {
+        text[--position] = digits[number % base];
+        number /= base;
+    } while((number != 0 || sizeof(text) - 1 - position < min_digits) && position > 0);
+
+    writer_put(writer, &text[position]);
+}
+
+/* Chrome traces count in microseconds, the fraction keeps the nanoseconds */
+static void writer_put_us(TraceWriter* writer, uint64_t ns)
+{
+    writer_put_u64(writer, ns / 1000, 10, 1);
+    writer_put(writer, ".");
+    writer_put_u64(writer, ns % 1000, 10, 3);
+}
+
+static void writer_put_arg(TraceWriter* writer, const char* name, uint64_t number, bool hex, bool* first)
+{
+    if(name == NULL)
+    {
+        return;
+    }
+
+    writer_put(writer, *first ? "\"" : ",\"");
+    writer_put(writer, name);
+    if(hex)
+    {
+        writer_put(writer, "\":\"0x");
+        writer_put_u64(writer, number, 16, 1);
+        writer_put(writer, "\"");
+    }
+    else
+    {
+        writer_put(writer, "\":");
+        writer_put_u64(writer, number, 10, 1);
+    }
+    *first = false;
+}
+
+static void writer_put_ids(TraceWriter* writer, uint32_t pid, uint32_t tid)
+{
+    writer_put(writer, ",\"pid\":");
+    writer_put_u64(writer, pid, 10, 1);
+    writer_put(writer, ",\"tid\":");
+    writer_put_u64(writer, tid, 10, 1);
+}
+
+/* Names the thread after its /proc comm, as set with pthread_setname_np */
+static void trace_export_thread_name(TraceWriter* writer, uint32_t pid, uint32_t tid)
+{
+    char path[48] = "/proc/self/task/";
+    char name[17] = "";
+    size_t length = strlen(path);
+
+    char digits[12];
+    uint32_t position = sizeof(digits);
+    uint32_t number = tid;
+    do
+    {
+        digits[--position] = (char)('0' + number % 10);
+        number /= 10;
+    } while(number != 0);
+    memcpy(&path[length], &digits[position], sizeof(digits) - position);
+    memcpy(&path[length + sizeof(digits) - position], "/comm", sizeof("/comm"));
+
+    int fd = open(path, O_RDONLY);
+    if(fd >= 0)
+    {
+        ssize_t count = read(fd, name, sizeof(name) - 1);
+        name[(count > 0) ? count : 0] = '\0';
+        (void)close(fd);
+    }
+    for(char* c = name; *c != '\0'; ++c)
+    {
+        if(*c == '\n')
+        {
+            *c = '\0';
+            break;
+        }
+        if(*c == '"' || *c == '\\' || (unsigned char)*c < 0x20)
+        {
+            *c = '_';
+        }
+    }
+
+    writer_put(writer, "{\"name\":\"thread_name\",\"ph\":\"M\"");
+    writer_put_ids(writer, pid, tid);
+    writer_put(writer, ",\"args\":{\"name\":\"");
+    writer_put(writer, (name[0] != '\0') ? name : "thread");
+    writer_put(writer, "\"}}");
+}
+
+static void trace_export_record(TraceWriter* writer, const TraceRecord* record, uint32_t pid, uint32_t tid)
+{
+    const TraceKindFormat* format = &kind_formats[record->kind];
+    bool first = true;
+
+    writer_put(writer, ",\n{\"name\":\"");
+    writer_put(writer, format->name);
+    writer_put(writer, "\",\"ph\":\"");
+    writer_put(writer, format->phase);
+    writer_put(writer, (format->phase[0] == 'i') ? "\",\"s\":\"t\",\"ts\":" : "\",\"ts\":");
+    writer_put_us(writer, record->timestamp);
+    writer_put_ids(writer, pid, tid);
+    writer_put(writer, ",\"args\":{");
+    writer_put_arg(writer, format->object_arg, record->object, true, &first);
+    writer_put_arg(writer, format->value_arg, record->value, false, &first);
+    writer_put_arg(writer, format->detail_arg, record->detail, format->detail_hex, &first);
+    writer_put(writer, "}}");
+}
+
+static void trace_export_ring(TraceWriter* writer, const TraceRing* ring, uint32_t pid)
+{
+    uint32_t tid = __atomic_load_n(&ring->tid, __ATOMIC_ACQUIRE);
+    uint64_t first = __atomic_load_n(&ring->first, __ATOMIC_RELAXED);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if(head == first)
+    {
+        return;
+    }
+
+    writer_put(writer, ",\n");
+    trace_export_thread_name(writer, pid, tid);
+
+    /* The oldest slot is the one the thread overwrites next, it is never exported */
+    uint64_t oldest = (head >= eTRACE_RING_SIZE) ? head - eTRACE_RING_SIZE + 1 : 0;
+    for(uint64_t n = (oldest > first) ? oldest : first; n < head; ++n)
+    {
+        const TraceRecord* slot = &ring->records[n & (eTRACE_RING_SIZE - 1)];
+        TraceRecord record = {
+            .timestamp = __atomic_load_n(&slot->timestamp, __ATOMIC_RELAXED),
+            .object    = __atomic_load_n(&slot->object, __ATOMIC_RELAXED),
+            .detail    = __atomic_load_n(&slot->detail, __ATOMIC_RELAXED),
+            .kind      = __atomic_load_n(&slot->kind, __ATOMIC_RELAXED),
+            .value     = __atomic_load_n(&slot->value, __ATOMIC_RELAXED)
+        };
+
+        /* The thread kept recording, skip the record if its slot was reused meanwhile */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&ring->head, __ATOMIC_RELAXED) >= n + eTRACE_RING_SIZE ||
+           record.kind >= eTRACE_KIND_COUNT)
+        {
+            continue;
+        }
+
+        trace_export_record(writer, &record, pid, tid);
+    }
+}
+
+eStatus util_trace_export(int fd)
+{
+    TraceWriter writer = { .fd = fd };
+    uint32_t pid = (uint32_t)getpid();
+    uint32_t count = __atomic_load_n(&ring_count, __ATOMIC_ACQUIRE);
+
+    /* Starts with a metadata event so that every later one can lead with a comma */
+    writer_put(&writer, "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\"");
+    writer_put_ids(&writer, pid, pid);
+    writer_put(&writer, ",\"args\":{\"name\":\"SnipeIt\"}}");
+
+    for(uint32_t i = 0; i < count && i < eTRACE_THREAD_MAX_COUNT; ++i)
+    {
+        trace_export_ring(&writer, &rings[i], pid);
+    }
+
+    writer_put(&writer, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    writer_flush(&writer);
+
+    return writer.failed ? eSTATUS_SYSTEM_ERROR : eSTATUS_SUCCESSFUL;
+}
+
+static void trace_dump_handler(int signo)
+{
+    (void)signo;
+    int saved_errno = errno;
+
+    int fd = open(TRACE_FILE_PATH, O_WRONLY | O_CREAT | O_TRUNC, eTRACE_FILE_PERMISSIONS);
+    if(fd >= 0)
+    {
+        (void)util_trace_export(fd);
+        (void)close(fd);
+    }
+
+    errno = saved_errno;
+}
+
+eStatus util_trace_dump_on_signal(int signo)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = trace_dump_handler;
+    action.sa_flags = SA_RESTART;
+    (void)sigemptyset(&action.sa_mask);
+
+    if(sigaction(signo, &action, NULL))
+    {
+        return eSTATUS_SYSTEM_ERROR;
+    }
+
+    return eSTATUS_SUCCESSFUL;
+}
@@ -0,0 +1,90 @@
+#ifndef UTIL_TRACE_H
+#define UTIL_TRACE_H
+
+/* Standard library includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* User library includes */
+#include "util/trace/trace_config.h"
+#include "status.h"
+
+/*
+    Binary event trace. Every thread records into a ring of its own, taken on
+    its first record, with no lock and a clock read per record. Only the
+    latest eTRACE_RING_SIZE - 1 records of each thread are kept. A thread
+    gives its ring up when it exits, the records stay until a new thread
+    finds every other ring taken and records over them. The rings
+    can be exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+    at any time, including from a signal handler.
+*/
+
+typedef enum eTraceKind
+{
+    eTRACE_KIND_PUBLISH,            // value: event type, detail: AO ID
+    eTRACE_KIND_POST,               // object: AO, value: event type, detail: eStatus of the post
+    eTRACE_KIND_DISPATCH_BEGIN,     // object: AO, value: event type, detail: ns the event waited
+    eTRACE_KIND_DISPATCH_END,       // object: AO, value: event type
+    eTRACE_KIND_TRANSITION,         // object: FSM, detail: address of the next state
+    eTRACE_KIND_IO_COMPLETE,        // object: callback argument, value: result of the operation
+    eTRACE_KIND_COUNT
+} eTraceKind;
+
+/**
+ * @brief   Initialize the trace.
+ * @details Empties every ring and enables recording. Threads take a new ring
+ *          on their next record.
+ */
+void util_trace_init(void);
+
+/**
+ * @brief   Turn recording on or off.
+ * @param   enabled false makes the record functions return at once.
+ */
+void util_trace_enable(bool enabled);
+
+/**
+ * @brief   Record an event in the calling thread's ring, stamped now.
+ * @param   kind A value from @ref eTraceKind.
+ * @param   object The object the record is about, see @ref eTraceKind.
+ * @param   value A value from @ref eTraceKind.
+ * @param   detail A value from @ref eTraceKind.
+ */
+void util_trace_record(eTraceKind kind, const void* object, uint32_t value, uint64_t detail);
+
+/**
+ * @brief   Record an event in the calling thread's ring with a given time.
+ * @details For callers that already read the clock.
+ * @param   kind A value from @ref eTraceKind.
+ * @param   object The object the record is about, see @ref eTraceKind.
+ * @param   value A value from @ref eTraceKind.
+ * @param   detail A value from @ref eTraceKind.
+ * @param   timestamp_ns The time of the event from osal_time_now_ns().
+ */
+void util_trace_record_at(eTraceKind kind, const void* object, uint32_t value, uint64_t detail,
+                          uint64_t timestamp_ns);
+
+/**
+ * @brief   Write the rings as Chrome trace JSON.
+ * @details Dispatches become slices on their AO's thread, the other records
+ *          instant events. Threads keep recording meanwhile, records
+ *          overwritten during the export are left out. Async-signal-safe.
+ * @param   fd An open file descriptor to write to.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_SYSTEM_ERROR    writing to fd failed
+ */
+eStatus util_trace_export(int fd);
+
+/**
+ * @brief   Export the trace to TRACE_FILE_PATH whenever a signal arrives.
+ * @details Lets the trace of a running process be dumped on demand, for
+ *          example with `kill -USR1 <pid>` (see `make trace`).
+ * @param   signo The signal to handle, usually SIGUSR1.
+ * @returns A value from @ref eStatus.
+ * @retval  eSTATUS_SUCCESSFUL      successful execution
+ * @retval  eSTATUS_SYSTEM_ERROR    the handler couldn't be installed
+ */
+eStatus util_trace_dump_on_signal(int signo);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef UTIL_TRACE_CONFIG_H
+#define UTIL_TRACE_CONFIG_H
+
+typedef enum eTraceConfig
+{
+    eTRACE_RING_SIZE = 1024,            // records per thread, a power of two
+    eTRACE_THREAD_MAX_COUNT = 16,       // threads with a ring at a time, more aren't traced until one exits
+    eTRACE_WRITER_BUFFER_SIZE = 512,    // bytes, export output is written in chunks of this size
+    eTRACE_FILE_PERMISSIONS = 0644
+} eTraceConfig;
+
+/* File written by the dump signal handler, see util_trace_dump_on_signal */
+#define TRACE_FILE_PATH "trace.json"
+
+#endif
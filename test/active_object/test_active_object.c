@@ -9,31 +9,179 @@
 
 /* Tell Ceedling to inject the following sources */
 TEST_SOURCE_FILE("util/active_object/active_object.c")
+TEST_SOURCE_FILE("util/histogram/histogram.c")
+TEST_SOURCE_FILE("util/event_pool/event_pool.c")
 
 /* Mock library includes */
 #include "mock_queue.h"
 #include "mock_osal.h"
 #include "mock_fsm.h"
+#include "mock_trace.h"
+#include "mock_executor.h"
 
 /* Test helpers */
 static ActiveObject aobj;
 static EntryFP entry;
 static Event queue_ev[2];
 static void* arg;
+static const OsalThreadAttr* thread_attr;
+static ExecutorRunFP task_run;
+static void* task_arg;
 
-static int osal_thread_create_callback(void** thread, EntryFP entry_func, void* arg_p, int cmock_num_calls)
+static eStatus osal_thread_create_ex_callback(OsalThread* thread, EntryFP entry_func, void* arg_p,
+                                              const OsalThreadAttr* attr_p, int cmock_num_calls)
 {
     entry = entry_func;
     arg = arg_p;
+    thread_attr = attr_p;
     return 0;
 }
 
-static eStatus util_queue_pop_callback(Queue* queue, void** element, int cmock_num_calls)
+static eStatus util_queue_pop_batch_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                             uint32_t max_count, uint32_t* count, int cmock_num_calls)
 {
-    static int i = 0;
-    *((Event**)element) = &queue_ev[i];
-    i = (i + 1) % 2;
-    return 0;
+    /* A burst of one event, then a batch of two ending the AO */
+    if(cmock_num_calls == 0)
+    {
+        elements[0] = &queue_ev[0];
+        stamps[0] = 100;
+        *count = 1;
+    }
+    else
+    {
+        elements[0] = &queue_ev[0];
+        elements[1] = &queue_ev[1];
+        stamps[0] = 1000;
+        stamps[1] = 1000;
+        *count = 2;
+    }
+    return eSTATUS_SUCCESSFUL;
+}
+
+static Event* pooled_ev[3];
+
+static eStatus util_queue_pop_batch_pooled_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                                    uint32_t max_count, uint32_t* count, int cmock_num_calls)
+{
+    /* A pooled event, a pooled END and one more that is never dispatched */
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        elements[i] = pooled_ev[i];
+        stamps[i] = 0;
+    }
+    *count = 3;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_pop_batch_first_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                                   uint32_t max_count, uint32_t* count, int cmock_num_calls)
+{
+    elements[0] = pooled_ev[0];
+    stamps[0] = 0;
+    *count = 1;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_pop_urgent_end_callback(Queue* queue, void** element, uint64_t* stamp,
+                                                  int cmock_num_calls)
+{
+    TEST_ASSERT_EQUAL(0, cmock_num_calls);
+    *element = pooled_ev[2];
+    *stamp = 0;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_try_pop_batch_leftover_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                                          uint32_t max_count, uint32_t* count,
+                                                          int cmock_num_calls)
+{
+    /* What is left of the queue, then an empty one */
+    if(cmock_num_calls > 0)
+    {
+        *count = 0;
+        return eSTATUS_ACTION_FAILED;
+    }
+    elements[0] = pooled_ev[1];
+    *count = 1;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_pop_batch_timeout_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                                     uint32_t max_count, uint32_t* count, uint64_t timeout_ms,
+                                                     int cmock_num_calls)
+{
+    if(cmock_num_calls == 0)
+    {
+        *count = 0;
+        return eSTATUS_TIMEOUT;
+    }
+    elements[0] = &queue_ev[1];
+    stamps[0] = 0;
+    *count = 1;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_executor_task_init_callback(ExecutorTask* task, ExecutorRunFP run, void* arg_p,
+                                                int cmock_num_calls)
+{
+    task_run = run;
+    task_arg = arg_p;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_try_pop_batch_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                                 uint32_t max_count, uint32_t* count, int cmock_num_calls)
+{
+    /* Two runs of one event, an empty queue, then END */
+    TEST_ASSERT_LESS_THAN(4, cmock_num_calls);
+    if(cmock_num_calls == 2)
+    {
+        *count = 0;
+        return eSTATUS_ACTION_FAILED;
+    }
+    elements[0] = (cmock_num_calls < 2) ? &queue_ev[0] : &queue_ev[1];
+    stamps[0] = 0;
+    *count = 1;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static TimerArg* tick;
+static Event* posted_ev;
+
+static eStatus osal_timer_init_callback(OsalTimer* timer, TimerArg* arg_p, int cmock_num_calls)
+{
+    tick = arg_p;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_push_callback(Queue* queue, void* element, int cmock_num_calls)
+{
+    posted_ev = element;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_queue_pop_batch_timed_callback(Queue* queue, void** elements, uint64_t* stamps,
+                                                   uint32_t max_count, uint32_t* count, int cmock_num_calls)
+{
+    /* The timeout posted before the disarm, the one armed again, then END */
+    elements[0] = posted_ev;
+    elements[1] = posted_ev;
+    elements[2] = &queue_ev[1];
+    stamps[0] = 0;
+    stamps[1] = 0;
+    stamps[2] = 0;
+    *count = 3;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static uint64_t osal_time_now_ns_callback(int cmock_num_calls)
+{
+    return 2000 + 100 * (uint64_t)cmock_num_calls;
+}
+
+static void idle_hook(void* arg_p)
+{
+    (*(int*)arg_p)++;
 }
 
 static void dummy_init(FSM* fsm, Event* event)
@@ -44,9 +192,12 @@ static void dummy_init(FSM* fsm, Event* event)
 
 void setUp(void)
 {
-    util_queue_init_IgnoreAndReturn(0);
-    osal_thread_create_IgnoreAndReturn(0);
-    (void)util_active_object_init(&aobj, 2, dummy_init);
+    util_trace_record_Ignore();
+    util_trace_record_at_Ignore();
+    util_queue_init_ex_IgnoreAndReturn(0);
+    util_queue_enable_stamps_IgnoreAndReturn(0);
+    osal_thread_create_ex_IgnoreAndReturn(0);
+    (void)util_active_object_init(&aobj, 2, dummy_init, NULL);
 }
 
 void tearDown(void) 
@@ -54,6 +205,11 @@ void tearDown(void)
     util_queue_push_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
     osal_thread_join_Ignore();
     util_queue_delete_Ignore();
+    util_queue_try_pop_batch_IgnoreAndReturn(eSTATUS_ACTION_FAILED);
+    util_executor_schedule_Ignore();
+    util_executor_task_deinit_Ignore();
+    osal_event_wait_Ignore();
+    osal_event_destroy_Ignore();
     util_active_object_end(&aobj);
     util_active_object_join(&aobj);
     util_active_object_delete(&aobj);
@@ -61,38 +217,147 @@ void tearDown(void)
 
 void test_active_object_entry(void)
 {
-    util_queue_init_IgnoreAndReturn(0);
-    osal_thread_create_Stub(osal_thread_create_callback);
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
     util_fsm_init_IgnoreAndReturn(0);
-    util_queue_pop_Stub(util_queue_pop_callback);
+    util_queue_pop_batch_Stub(util_queue_pop_batch_callback);
+    osal_time_now_ns_Stub(osal_time_now_ns_callback);
     queue_ev[0].type = eFSM_EVENT_USER;
-    util_fsm_send_event_IgnoreAndReturn(0);
+    util_fsm_send_event_ExpectAndReturn(&aobj.active_fsm, &queue_ev[0], 0);
+    util_fsm_send_event_ExpectAndReturn(&aobj.active_fsm, &queue_ev[0], 0);
     queue_ev[1].type = eFSM_EVENT_END;
-    eStatus status = util_active_object_init(&aobj, 2, dummy_init);
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
     void* ret = entry(arg);
     TEST_ASSERT_EQUAL(NULL, ret);
+
+    ActiveObjectStats stats;
+    util_queue_depth_IgnoreAndReturn(0);
+    status = util_active_object_get_stats(&aobj, &stats);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(3, stats.events);
+    TEST_ASSERT_EQUAL(2, stats.batches);
+    TEST_ASSERT_EQUAL(2, stats.batch_max);
+
+    /* Handled at 2000 and 2200, posted at 100 and 1000, 100 ns each */
+    TEST_ASSERT_EQUAL(2, stats.wait.count);
+    TEST_ASSERT_EQUAL(1900, stats.wait.max);
+    TEST_ASSERT_EQUAL(1900 + 1200, stats.wait.sum);
+    TEST_ASSERT_EQUAL(2, stats.run.count);
+    TEST_ASSERT_EQUAL(200, stats.run.sum);
+
+    status = util_active_object_get_stats(&aobj, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+}
+
+void test_active_object_pooled_events(void)
+{
+    util_event_pool_init();
+    pooled_ev[0] = util_event_pool_alloc(eFSM_EVENT_USER);
+    pooled_ev[1] = util_event_pool_alloc(eFSM_EVENT_END);
+    pooled_ev[2] = util_event_pool_alloc(eFSM_EVENT_USER);
+
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    util_fsm_init_IgnoreAndReturn(0);
+    util_queue_pop_batch_Stub(util_queue_pop_batch_pooled_callback);
+    osal_time_now_ns_IgnoreAndReturn(0);
+    util_fsm_send_event_ExpectAndReturn(&aobj.active_fsm, pooled_ev[0], 0);
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    (void)entry(arg);
+
+    /* The queue's references are dropped whether or not the event was dispatched */
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+}
+
+void test_active_object_delete_pooled_events(void)
+{
+    static const uint8_t priorities[] = { [eFSM_EVENT_END] = eEVENT_PRIORITY_URGENT };
+    static const ActiveObjectAttr attr = {
+        .queue_type           = eQUEUE_TYPE_LOCKED,
+        .urgent_capacity      = 1,
+        .event_priorities     = priorities,
+        .event_priority_count = sizeof(priorities)
+    };
+
+    util_event_pool_init();
+    pooled_ev[0] = util_event_pool_alloc(eFSM_EVENT_USER);
+    pooled_ev[1] = util_event_pool_alloc(eFSM_EVENT_USER);
+    pooled_ev[2] = util_event_pool_alloc(eFSM_EVENT_END);
+
+    util_queue_init_urgent_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_push_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    util_queue_push_urgent_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, util_active_object_post(&aobj, pooled_ev[i]));
+    }
+
+    /* END overtakes the first event of the batch, the second is never popped */
+    util_fsm_init_IgnoreAndReturn(0);
+    util_queue_pop_batch_Stub(util_queue_pop_batch_first_callback);
+    util_queue_pop_urgent_Stub(util_queue_pop_urgent_end_callback);
+    (void)entry(arg);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT - 1, util_event_pool_available());
+
+    util_queue_try_pop_batch_Stub(util_queue_try_pop_batch_leftover_callback);
+    util_queue_delete_Expect(&aobj.event_queue);
+    util_active_object_delete(&aobj);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+
+    util_queue_try_pop_batch_IgnoreAndReturn(eSTATUS_ACTION_FAILED);
 }
 
 void test_active_object_init(void)
 {
-    eStatus status = util_active_object_init(NULL, 2, dummy_init);
+    eStatus status = util_active_object_init(NULL, 2, dummy_init, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
 
-    status = util_active_object_init(&aobj, 2, NULL);
+    status = util_active_object_init(&aobj, 2, NULL, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
 
-    util_queue_init_IgnoreAndReturn(1);
-    status = util_active_object_init(&aobj, 2, dummy_init);
+    util_queue_init_ex_IgnoreAndReturn(1);
+    status = util_active_object_init(&aobj, 2, dummy_init, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
 
-    util_queue_init_IgnoreAndReturn(0);
-    osal_thread_create_IgnoreAndReturn(1);
+    util_queue_init_ex_IgnoreAndReturn(0);
+    util_queue_enable_stamps_IgnoreAndReturn(1);
     util_queue_delete_Ignore();
-    status = util_active_object_init(&aobj, 2, dummy_init);
+    status = util_active_object_init(&aobj, 2, dummy_init, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+
+    util_queue_enable_stamps_IgnoreAndReturn(0);
+    osal_thread_create_ex_IgnoreAndReturn(1);
+    status = util_active_object_init(&aobj, 2, dummy_init, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
 }
 
+void test_active_object_init_attr(void)
+{
+    static const ActiveObjectAttr attr = {
+        .thread = {
+            .name     = "test",
+            .policy   = eTHREAD_POLICY_FIFO,
+            .priority = 10
+        }
+    };
+
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&attr.thread, thread_attr);
+
+    status = util_active_object_init(&aobj, 2, dummy_init, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_NULL(thread_attr);
+}
+
 void test_active_object_post(void)
 {
     Event user_event = { .type = eFSM_EVENT_USER };
@@ -113,4 +378,288 @@ void test_active_object_post(void)
     util_queue_push_IgnoreAndReturn(eSTATUS_ACTION_FAILED);
     status = util_active_object_post(&aobj, &user_event);
     TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
-}
\ No newline at end of file
+
+    /* Both failures are counted under the event's type, later types share the last entry */
+    Event late_event = { .type = eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT + 4 };
+    status = util_active_object_post(&aobj, &late_event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    ActiveObjectStats stats;
+    util_queue_depth_IgnoreAndReturn(2);
+    aobj.event_queue.peak = 2;
+    status = util_active_object_get_stats(&aobj, &stats);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, stats.drops[eFSM_EVENT_USER]);
+    TEST_ASSERT_EQUAL(1, stats.drops[eACTIVE_OBJECT_STATS_EVENT_TYPE_COUNT - 1]);
+    TEST_ASSERT_EQUAL(2, stats.depth);
+    TEST_ASSERT_EQUAL(2, stats.depth_peak);
+}
+void test_active_object_idle_hook(void)
+{
+    static int idle_calls;
+    static const ActiveObjectAttr attr = {
+        .idle_hook       = idle_hook,
+        .idle_arg        = &idle_calls,
+        .idle_timeout_ms = 100
+    };
+
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_fsm_init_IgnoreAndReturn(0);
+    util_queue_pop_batch_timeout_Stub(util_queue_pop_batch_timeout_callback);
+    queue_ev[1].type = eFSM_EVENT_END;
+    void* ret = entry(arg);
+    TEST_ASSERT_EQUAL(NULL, ret);
+    TEST_ASSERT_EQUAL(1, idle_calls);
+}
+
+void test_active_object_end_full_queue(void)
+{
+    util_queue_push_IgnoreAndReturn(eSTATUS_ACTION_FAILED);
+    eStatus status = util_active_object_end(&aobj);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_TRUE(aobj.end_requested);
+
+    status = util_active_object_end(NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+}
+
+void test_active_object_priorities(void)
+{
+    static const uint8_t priorities[] = { [eFSM_EVENT_USER + 1] = eEVENT_PRIORITY_URGENT };
+    static ActiveObjectAttr attr = {
+        .urgent_capacity      = 1,
+        .event_priorities     = priorities,
+        .event_priority_count = sizeof(priorities)
+    };
+    Event normal_event = { .type = eFSM_EVENT_USER };
+    Event urgent_event = { .type = eFSM_EVENT_USER + 1 };
+    Event unlisted_event = { .type = eFSM_EVENT_USER + 2 };
+
+    attr.queue_type = eQUEUE_TYPE_SPSC;
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    attr.queue_type = eQUEUE_TYPE_LOCKED;
+    util_queue_init_urgent_ExpectAndReturn(&aobj.event_queue, 2, 1, eSTATUS_SUCCESSFUL);
+    status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_push_urgent_ExpectAndReturn(&aobj.event_queue, &urgent_event, eSTATUS_SUCCESSFUL);
+    status = util_active_object_post(&aobj, &urgent_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_push_ExpectAndReturn(&aobj.event_queue, &normal_event, eSTATUS_SUCCESSFUL);
+    status = util_active_object_post(&aobj, &normal_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_push_ExpectAndReturn(&aobj.event_queue, &unlisted_event, eSTATUS_SUCCESSFUL);
+    status = util_active_object_post(&aobj, &unlisted_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+}
+
+void test_active_object_coalesced(void)
+{
+    static const bool coalesced[] = { [eFSM_EVENT_USER] = true };
+    static const ActiveObjectAttr attr = {
+        .event_coalesced       = coalesced,
+        .event_coalesced_count = sizeof(coalesced) / sizeof(coalesced[0])
+    };
+    Event idempotent_event = { .type = eFSM_EVENT_USER };
+    Event other_event = { .type = eFSM_EVENT_USER + 1 };
+    ActiveObjectStats stats;
+
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_IgnoreAndReturn(0);
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_push_coalesced_ExpectAndReturn(&aobj.event_queue, &idempotent_event, eSTATUS_SUCCESSFUL);
+    status = util_active_object_post(&aobj, &idempotent_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_push_ExpectAndReturn(&aobj.event_queue, &other_event, eSTATUS_SUCCESSFUL);
+    status = util_active_object_post(&aobj, &other_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    aobj.event_queue.merged = 3;
+    util_queue_depth_IgnoreAndReturn(0);
+    status = util_active_object_get_stats(&aobj, &stats);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(3, stats.merged);
+}
+
+void test_active_object_executor(void)
+{
+    static const ActiveObjectAttr attr = { .executor = true };
+    static const ActiveObjectAttr idle_attr = {
+        .idle_hook = idle_hook,
+        .executor  = true
+    };
+    Event user_event = { .type = eFSM_EVENT_USER };
+
+    eStatus status = util_active_object_init(&aobj, 2, dummy_init, &idle_attr);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    /* No thread, the task is scheduled once to initialize the FSM */
+    entry = NULL;
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    osal_event_init_IgnoreAndReturn(0);
+    util_executor_task_init_Stub(util_executor_task_init_callback);
+    util_executor_schedule_Expect(&aobj.task);
+    status = util_active_object_init(&aobj, 2, dummy_init, &attr);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_NULL(entry);
+    TEST_ASSERT_EQUAL_PTR(&aobj, task_arg);
+
+    /* One batch per run, asking for another while events are left */
+    util_fsm_init_ExpectAndReturn(&aobj.active_fsm, dummy_init, &aobj, 0);
+    util_queue_try_pop_batch_Stub(util_queue_try_pop_batch_callback);
+    osal_time_now_ns_IgnoreAndReturn(0);
+    queue_ev[0].type = eFSM_EVENT_USER;
+    queue_ev[1].type = eFSM_EVENT_END;
+    util_fsm_send_event_ExpectAndReturn(&aobj.active_fsm, &queue_ev[0], 0);
+    util_queue_depth_ExpectAndReturn(&aobj.event_queue, 1);
+    TEST_ASSERT_TRUE(task_run(task_arg));
+    util_fsm_send_event_ExpectAndReturn(&aobj.active_fsm, &queue_ev[0], 0);
+    util_queue_depth_ExpectAndReturn(&aobj.event_queue, 0);
+    TEST_ASSERT_FALSE(task_run(task_arg));
+    TEST_ASSERT_FALSE(task_run(task_arg));
+
+    /* Posts schedule the task */
+    util_queue_push_ExpectAndReturn(&aobj.event_queue, &user_event, eSTATUS_SUCCESSFUL);
+    util_executor_schedule_Expect(&aobj.task);
+    status = util_active_object_post(&aobj, &user_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* END stops the AO and releases join, later runs do nothing */
+    osal_event_set_Expect(&aobj.stopped_event);
+    TEST_ASSERT_FALSE(task_run(task_arg));
+    TEST_ASSERT_FALSE(task_run(task_arg));
+    osal_event_wait_Expect(&aobj.stopped_event);
+    util_active_object_join(&aobj);
+}
+
+void test_active_object_time_events(void)
+{
+    Event timeout_event = { .type = eFSM_EVENT_USER };
+    Event other_event = { .type = eFSM_EVENT_USER + 1 };
+    Event third_event = { .type = eFSM_EVENT_USER + 2 };
+
+    eStatus status = util_active_object_arm(&aobj, &timeout_event, 5, false);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    osal_mutex_init_IgnoreAndReturn(0);
+    osal_timer_init_Stub(osal_timer_init_callback);
+    status = util_active_object_time_init();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    status = util_active_object_init(&aobj, 4, dummy_init, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_mutex_lock_Ignore();
+    osal_mutex_unlock_Ignore();
+    status = util_active_object_arm(&aobj, &timeout_event, 0, false);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+    status = util_active_object_disarm(&aobj, &timeout_event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* The shared tick is armed by the first time event only, and runs while one is armed */
+    osal_time_now_ns_IgnoreAndReturn(1000);
+    osal_timer_arm_ExpectAnyArgsAndReturn(0);
+    status = util_active_object_arm(&aobj, &timeout_event, 5, false);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_active_object_arm(&aobj, &other_event, 5, true);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_active_object_arm(&aobj, &third_event, 5, false);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    status = util_active_object_disarm(&aobj, &other_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* Nothing is due before 5 ms, then the timeout is posted once */
+    tick->handler(tick->arg);
+    osal_time_now_ns_IgnoreAndReturn(1000 + 5000000);
+    util_queue_push_Stub(util_queue_push_callback);
+    tick->handler(tick->arg);
+    TEST_ASSERT_NOT_NULL(posted_ev);
+    TEST_ASSERT_EQUAL(eFSM_EVENT_USER, posted_ev->type);
+    util_queue_push_StubWithCallback(NULL);
+    tick->handler(tick->arg);
+
+    /* Arming again makes the queued timeout stale, only the new one is dispatched */
+    status = util_active_object_arm(&aobj, &timeout_event, 5, false);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    osal_time_now_ns_IgnoreAndReturn(1000 + 10000000);
+    util_queue_push_Stub(util_queue_push_callback);
+    tick->handler(tick->arg);
+
+    util_fsm_init_IgnoreAndReturn(0);
+    util_queue_pop_batch_Stub(util_queue_pop_batch_timed_callback);
+    queue_ev[1].type = eFSM_EVENT_END;
+    osal_timer_disarm_ExpectAnyArgsAndReturn(0);
+    util_fsm_send_event_ExpectAndReturn(&aobj.active_fsm, posted_ev, 0);
+    (void)entry(arg);
+
+    /* The dispatched one-shot was the last armed, the next arm restarts the tick */
+    osal_timer_arm_ExpectAnyArgsAndReturn(0);
+    status = util_active_object_arm(&aobj, &other_event, 5, true);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    osal_timer_disarm_ExpectAnyArgsAndReturn(0);
+    status = util_active_object_disarm(&aobj, &other_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_timer_destroy_Ignore();
+    osal_mutex_destroy_Ignore();
+    util_active_object_time_delete();
+}
+
+void test_active_object_time_event_queue_full(void)
+{
+    Event timeout_event = { .type = eFSM_EVENT_USER };
+    ActiveObjectStats stats;
+
+    osal_mutex_init_IgnoreAndReturn(0);
+    osal_timer_init_Stub(osal_timer_init_callback);
+    eStatus status = util_active_object_time_init();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    util_queue_init_ex_IgnoreAndReturn(0);
+    osal_thread_create_ex_IgnoreAndReturn(0);
+    status = util_active_object_init(&aobj, 2, dummy_init, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_mutex_lock_Ignore();
+    osal_mutex_unlock_Ignore();
+    osal_time_now_ns_IgnoreAndReturn(1000);
+    osal_timer_arm_ExpectAnyArgsAndReturn(0);
+    status = util_active_object_arm(&aobj, &timeout_event, 5, false);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* The full queue refuses the timeout, the drop is counted and it stays armed */
+    osal_time_now_ns_IgnoreAndReturn(1000 + 5000000);
+    util_queue_push_ExpectAnyArgsAndReturn(eSTATUS_ACTION_FAILED);
+    tick->handler(tick->arg);
+    util_queue_depth_IgnoreAndReturn(0);
+    status = util_active_object_get_stats(&aobj, &stats);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, stats.drops[eFSM_EVENT_USER]);
+
+    /* Posted on the next tick once there is room, then no more */
+    posted_ev = NULL;
+    util_queue_push_Stub(util_queue_push_callback);
+    tick->handler(tick->arg);
+    TEST_ASSERT_NOT_NULL(posted_ev);
+    TEST_ASSERT_EQUAL(eFSM_EVENT_USER, posted_ev->type);
+    util_queue_push_StubWithCallback(NULL);
+    tick->handler(tick->arg);
+
+    osal_timer_destroy_Ignore();
+    osal_mutex_destroy_Ignore();
+    util_active_object_time_delete();
+}
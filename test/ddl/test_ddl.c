@@ -0,0 +1,128 @@
+/* Standard library includes */
+#include <stddef.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "ddl/ddl.h"
+#include "ddl/servo/servo_config.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("ddl/ddl.c")
+
+/* Mock library includes */
+#include "mock_temperature_humidity.h"
+#include "mock_distance.h"
+#include "mock_servo.h"
+#include "mock_gps.h"
+#include "mock_event_bus.h"
+#include "mock_supervisor.h"
+#include "mock_log.h"
+#include "mock_osal.h"
+
+/* Test helpers, the servo module subscribes to four events */
+#define SERVO_EVENT_COUNT 4
+
+static Event* subscribed[SERVO_EVENT_COUNT];
+static Event* unsubscribed[SERVO_EVENT_COUNT];
+static uint32_t subscribe_count;
+static uint32_t unsubscribe_count;
+static uint32_t failing_subscribe;
+
+static eStatus util_event_bus_subscribe_callback(eActiveObjectID ao_id, EventBusPostFP post_fn, uint32_t module,
+                                                 Event* event, int cmock_num_calls)
+{
+    TEST_ASSERT_EQUAL(eAO_SERVO, ao_id);
+    TEST_ASSERT_EQUAL_PTR(ddl_post, post_fn);
+    TEST_ASSERT_EQUAL(eDDL_MODULE_SERVO, module);
+    if(subscribe_count == failing_subscribe)
+    {
+        return eSTATUS_ACTION_FAILED;
+    }
+    subscribed[subscribe_count++] = event;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus util_event_bus_unsubscribe_callback(eActiveObjectID ao_id, EventBusPostFP post_fn, uint32_t module,
+                                                   Event* event, int cmock_num_calls)
+{
+    TEST_ASSERT_EQUAL(eAO_SERVO, ao_id);
+    TEST_ASSERT_EQUAL_PTR(ddl_post, post_fn);
+    TEST_ASSERT_EQUAL(eDDL_MODULE_SERVO, module);
+    TEST_ASSERT_LESS_THAN(SERVO_EVENT_COUNT, unsubscribe_count);
+    unsubscribed[unsubscribe_count++] = event;
+    return eSTATUS_SUCCESSFUL;
+}
+
+void setUp(void)
+{
+    log_private_Ignore();
+    subscribe_count = 0;
+    unsubscribe_count = 0;
+    failing_subscribe = SERVO_EVENT_COUNT;
+    util_event_bus_subscribe_Stub(util_event_bus_subscribe_callback);
+    util_event_bus_unsubscribe_Stub(util_event_bus_unsubscribe_callback);
+}
+
+void tearDown(void)
+{
+    unsubscribe_count = 0;
+    (void)ddl_detach(eDDL_MODULE_SERVO);
+}
+
+void test_ddl_attach(void)
+{
+    eStatus status = ddl_attach(eDLL_MODULE_COUNT);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = ddl_attach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(SERVO_EVENT_COUNT, subscribe_count);
+
+    /* Attached already, nothing is subscribed twice */
+    status = ddl_attach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    TEST_ASSERT_EQUAL(SERVO_EVENT_COUNT, subscribe_count);
+    TEST_ASSERT_EQUAL(0, unsubscribe_count);
+}
+
+void test_ddl_attach_rollback(void)
+{
+    /* The third subscription fails, the first two are dropped again */
+    failing_subscribe = 2;
+    eStatus status = ddl_attach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    TEST_ASSERT_EQUAL(2, unsubscribe_count);
+    TEST_ASSERT_EQUAL_PTR_ARRAY(subscribed, unsubscribed, 2);
+
+    /* Not left attached, the next attach subscribes everything */
+    status = ddl_detach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    subscribe_count = 0;
+    failing_subscribe = SERVO_EVENT_COUNT;
+    status = ddl_attach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(SERVO_EVENT_COUNT, subscribe_count);
+}
+
+void test_ddl_detach(void)
+{
+    eStatus status = ddl_detach(eDLL_MODULE_COUNT);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = ddl_detach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    status = ddl_attach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = ddl_detach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(SERVO_EVENT_COUNT, unsubscribe_count);
+    TEST_ASSERT_EQUAL_PTR_ARRAY(subscribed, unsubscribed, SERVO_EVENT_COUNT);
+
+    status = ddl_detach(eDDL_MODULE_SERVO);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    TEST_ASSERT_EQUAL(SERVO_EVENT_COUNT, unsubscribe_count);
+}
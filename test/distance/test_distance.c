@@ -8,16 +8,21 @@
 /* User code includes */
 #include "ddl/distance/distance_fsm.h"
 #include "ddl/distance/distance_types.h"
+#include "ddl/distance/distance_config.h"
 #include "ddl/ddl_config.h"
+#include "util/fsm/fsm_table.h"
 
 /* Tell Ceedling to inject the following sources */
 TEST_SOURCE_FILE("ddl/distance/distance_fsm.c")
+TEST_SOURCE_FILE("util/fsm/fsm.c")
+TEST_SOURCE_FILE("util/fsm/fsm_table.c")
+TEST_SOURCE_FILE("util/histogram/histogram.c")
 
 /* Mock library includes */
-#include "mock_fsm.h"
 #include "mock_hal_uart.h"
 #include "mock_osal.h"
 #include "mock_active_object.h"
+#include "mock_trace.h"
 #include "mock_log.h"
 
 /* Test helpers */
@@ -25,25 +30,25 @@ DistanceObject dist_obj;
 FSM            dist_fsm;
 DistanceFrame  dist_frame;
 
-TimerHandlerFP timer_callback;
-void*          timer_arg;
+const Event* armed_event;
+bool         armed_repeat;
+uint32_t     arm_count;
 
 uint8_t* read_buf;
 async_cb read_callback;
 void*    read_arg;
 
-static eStatus osal_timer_init_callback(void** timer, TimerArg* arg_p, int cmock_num_calls)
-{
-    (void)timer;
-    timer_callback = arg_p->handler;
-    timer_arg = arg_p->arg;
-    (void)cmock_num_calls;
-    if(cmock_num_calls == 0)
-    {
-        return eSTATUS_SUCCESSFUL;
-    }
+static const uint8_t rest_frame[] = { 0x57, 0x00, 0xff, 0x00, 0x9e, 0x8f, 0x00, 0x00,
+                                      0xad, 0x08, 0x00, 0x00, 0x03, 0x00, 0x06, 0x41 };
 
-    return eSTATUS_SYSTEM_ERROR;
+static eStatus util_active_object_arm_callback(ActiveObject* aobj, const Event* event, uint64_t ms, bool repeat, int cmock_num_calls)
+{
+    (void)aobj;
+    armed_event = event;
+    (void)ms;
+    armed_repeat = repeat;
+    arm_count = (uint32_t)cmock_num_calls + 1;
+    return eSTATUS_SUCCESSFUL;
 }
 
 static eStatus hal_uart_read_callback(uint32_t device, void* buf_p, size_t len, async_cb callback_fp, void* arg_p, int cmock_num_calls)
@@ -57,10 +62,29 @@ static eStatus hal_uart_read_callback(uint32_t device, void* buf_p, size_t len,
     return eSTATUS_SUCCESSFUL;
 }
 
+/* Runs the FSM into the table's READ state */
+static void start_read(void)
+{
+    Event ev_read = { .type = eDISTANCE_EVENT_READ };
+    (void)util_fsm_init(&dist_fsm, distance_init_state, &dist_obj);
+    (void)util_fsm_send_event(&dist_fsm, &ev_read);
+    TEST_ASSERT_EQUAL_PTR(distance_read_state, dist_fsm.current_state);
+}
+
 void setUp(void)
 {
+    memset(&dist_obj, 0, sizeof(dist_obj));
+    memset(&dist_fsm, 0, sizeof(dist_fsm));
     dist_obj.frame = &dist_frame;
     dist_fsm.arg = &dist_obj;
+    arm_count = 0;
+    log_private_Ignore();
+    util_trace_record_Ignore();
+    osal_time_now_ns_IgnoreAndReturn(0);
+    hal_uart_write_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    hal_uart_read_Stub(hal_uart_read_callback);
+    util_active_object_arm_Stub(util_active_object_arm_callback);
+    util_active_object_disarm_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
 }
 
 void tearDown(void) 
@@ -70,164 +94,114 @@ void tearDown(void)
 
 void test_distance_init_state(void)
 {
-    Event ev_init = { .type = eFSM_EVENT_INIT };
-    log_private_Ignore();
-    osal_timer_init_Stub(osal_timer_init_callback);
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_init_state(&dist_fsm, &ev_init);
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_init_state(&dist_fsm, &ev_init);
-    util_active_object_post_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    timer_callback(timer_arg);
+    dist_frame.valid = true;
+    dist_obj.retry = 2;
+    eStatus status = util_fsm_init(&dist_fsm, distance_init_state, &dist_obj);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_FALSE(dist_obj.frame->valid);
+    TEST_ASSERT_EQUAL_PTR(distance_idle_state, dist_fsm.current_state);
+    TEST_ASSERT_EQUAL(0, dist_obj.retry);
 
-    Event ev_exit = { .type = eFSM_EVENT_EXIT };
-    log_private_Ignore();
-    distance_init_state(&dist_fsm, &ev_exit);
+    /* The table passes the checks the build can't make */
+    TEST_ASSERT_NOT_NULL(dist_fsm.table);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, util_fsm_table_validate(dist_fsm.table));
 
     Event ev_user = { .type = eFSM_EVENT_USER };
-    log_private_Ignore();
     distance_init_state(&dist_fsm, &ev_user);
 }
 
-void test_distance_error_state(void)
-{
-    Event ev_entry = { .type = eFSM_EVENT_ENTRY };
-    log_private_Ignore();
-    distance_error_state(&dist_fsm, &ev_entry);
-    TEST_ASSERT_FALSE(dist_obj.frame->valid);
-
-    Event ev_user = { .type = eFSM_EVENT_USER };
-    log_private_Ignore();
-    distance_error_state(&dist_fsm, &ev_user);
-}
-
 void test_distance_idle_state(void)
 {
-    Event ev_entry = { .type = eFSM_EVENT_ENTRY };
-    log_private_Ignore();
-    dist_obj.retry = 3;
-    distance_idle_state(&dist_fsm, &ev_entry);
-    TEST_ASSERT_EQUAL(0, dist_obj.retry);
-
-    Event ev_read = { .type = eDISTANCE_EVENT_READ };
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_idle_state(&dist_fsm, &ev_read);
+    FSMStats stats;
+    Event ev_timeout = { .type = eDISTANCE_EVENT_TIMEOUT };
+    Event ev_frame_received = { .type = eDISTANCE_EVENT_FRAME_RECEIVED };
+    (void)util_fsm_init(&dist_fsm, distance_init_state, &dist_obj);
 
-    Event ev_exit = { .type = eFSM_EVENT_EXIT };
-    log_private_Ignore();
-    distance_idle_state(&dist_fsm, &ev_exit);
+    /* A late timeout or frame has no row in IDLE */
+    (void)util_fsm_send_event(&dist_fsm, &ev_timeout);
+    (void)util_fsm_send_event(&dist_fsm, &ev_frame_received);
+    TEST_ASSERT_EQUAL_PTR(distance_idle_state, dist_fsm.current_state);
+    (void)util_fsm_get_stats(&dist_fsm, &stats);
+    TEST_ASSERT_EQUAL(2, stats.filtered);
 
     Event ev_user = { .type = 100 };
-    log_private_Ignore();
     distance_idle_state(&dist_fsm, &ev_user);
 }
 
 void test_distance_read_state(void)
 {
-    Event ev_entry = { .type = eFSM_EVENT_ENTRY };
-    log_private_Ignore();
-    hal_uart_write_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    hal_uart_read_Stub(hal_uart_read_callback);
-    osal_timer_arm_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_read_state(&dist_fsm, &ev_entry);
-    util_active_object_post_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    read_callback(read_arg);
+    start_read();
+    TEST_ASSERT_EQUAL(1, arm_count);
+    TEST_ASSERT_EQUAL(eDISTANCE_EVENT_TIMEOUT, armed_event->type);
+    TEST_ASSERT_FALSE(armed_repeat);
 
-    Event ev_frame_received = { .type = eDISTANCE_EVENT_FRAME_RECEIVED };
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_read_state(&dist_fsm, &ev_frame_received);
+    util_active_object_post_ExpectAnyArgsAndReturn(eSTATUS_SUCCESSFUL);
+    read_callback(read_arg);
 
+    /* Each timeout aborts and reads again, until the retries run out */
     Event ev_timeout = { .type = eDISTANCE_EVENT_TIMEOUT };
-    log_private_Ignore();
-    hal_uart_abort_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_read_state(&dist_fsm, &ev_timeout);
-    dist_obj.retry = eDISTANCE_READ_RETRY_MAX;
-    log_private_Ignore();
     hal_uart_abort_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    dist_obj.frame->valid = true;
-    distance_read_state(&dist_fsm, &ev_timeout);
-    TEST_ASSERT_FALSE(dist_obj.frame->valid);
+    dist_frame.valid = true;
+    for(uint32_t i = 1; i < eDISTANCE_READ_RETRY_MAX; ++i)
+    {
+        (void)util_fsm_send_event(&dist_fsm, &ev_timeout);
+        TEST_ASSERT_EQUAL_PTR(distance_read_state, dist_fsm.current_state);
+        TEST_ASSERT_EQUAL(i, dist_obj.retry);
+        TEST_ASSERT_EQUAL(i + 1, arm_count);
+    }
+    TEST_ASSERT_TRUE(dist_frame.valid);
 
-    Event ev_exit = { .type = eFSM_EVENT_EXIT };
-    log_private_Ignore();
-    osal_timer_disarm_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_read_state(&dist_fsm, &ev_exit);
+    util_active_object_disarm_ExpectAndReturn(&dist_obj.aobj, armed_event, eSTATUS_SUCCESSFUL);
+    (void)util_fsm_send_event(&dist_fsm, &ev_timeout);
+    TEST_ASSERT_EQUAL_PTR(distance_idle_state, dist_fsm.current_state);
+    TEST_ASSERT_FALSE(dist_frame.valid);
+    TEST_ASSERT_EQUAL(0, dist_obj.retry);
 
     Event ev_user = { .type = 100 };
-    log_private_Ignore();
     distance_read_state(&dist_fsm, &ev_user);
 }
 
-void test_distance_update_state(void)
+void test_distance_frame_received(void)
 {
-    Event ev_entry = { .type = eFSM_EVENT_ENTRY };
-    const uint8_t rest_frame[] = { 0x57, 0x00, 0xff, 0x00, 0x9e, 0x8f, 0x00, 0x00, 0xad, 0x08, 0x00, 0x00, 0x03, 0x00, 0x06, 0x41 };
-    (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
-    log_private_Ignore();
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_update_state(&dist_fsm, &ev_entry);
-    
-    dist_obj.retry = 0;
-    log_private_Ignore();
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    read_buf[0] = 0x80;
-    distance_update_state(&dist_fsm, &ev_entry);
-    (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
-
-    dist_obj.retry = 0;
-    log_private_Ignore();
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    read_buf[1] = 0x11;
-    distance_update_state(&dist_fsm, &ev_entry);
-    (void)memcpy(read_buf, rest_frame, sizeof(rest_frame)); 
+    Event ev_frame_received = { .type = eDISTANCE_EVENT_FRAME_RECEIVED };
+    const uint32_t corrupt[] = { 0, 1, 3, sizeof(rest_frame) - 1 };
 
-    dist_obj.retry = 0;
-    log_private_Ignore();
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    read_buf[3] = 0x10;
-    distance_update_state(&dist_fsm, &ev_entry);
-    (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
+    /* A corrupt frame is read again */
+    start_read();
+    for(uint32_t i = 0; i < sizeof(corrupt) / sizeof(corrupt[0]); ++i)
+    {
+        dist_obj.retry = 0;
+        (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
+        read_buf[corrupt[i]] ^= 0x10;
+        (void)util_fsm_send_event(&dist_fsm, &ev_frame_received);
+        TEST_ASSERT_EQUAL_PTR(distance_read_state, dist_fsm.current_state);
+        TEST_ASSERT_EQUAL(1, dist_obj.retry);
+    }
 
-    dist_obj.retry = 0;
-    log_private_Ignore();
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    distance_update_state(&dist_fsm, &ev_entry);
+    /* The same sensor time twice is a stale frame */
     (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
-
-    dist_obj.retry = 0;
-    log_private_Ignore();
-    log_private_Ignore();
-    util_fsm_transition_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
-    read_buf[sizeof(rest_frame) - 1] = 0x10;
-    uint32_t temp = dist_obj.system_time;
+    dist_obj.system_time = 36766;
+    (void)util_fsm_send_event(&dist_fsm, &ev_frame_received);
+    TEST_ASSERT_EQUAL_PTR(distance_read_state, dist_fsm.current_state);
     dist_obj.system_time = 0;
-    distance_update_state(&dist_fsm, &ev_entry);
-    dist_obj.system_time = temp;
-    (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
+
+    (void)util_fsm_send_event(&dist_fsm, &ev_frame_received);
+    TEST_ASSERT_EQUAL_PTR(distance_idle_state, dist_fsm.current_state);
 
     float expected_dis = 2.221f;
+    TEST_ASSERT_TRUE(dist_obj.frame->valid);
     TEST_ASSERT_EQUAL(36766, dist_obj.system_time);
     TEST_ASSERT_EQUAL(0, memcmp(&dist_obj.frame->distance, &expected_dis, sizeof(float)));
     TEST_ASSERT_EQUAL(0, dist_obj.frame->status);
     TEST_ASSERT_EQUAL(3, dist_obj.frame->strength);
     TEST_ASSERT_EQUAL(6, dist_obj.frame->precision);
 
-    Event ev_exit = { .type = eFSM_EVENT_EXIT };
-    log_private_Ignore();
-    distance_update_state(&dist_fsm, &ev_exit);
-
-    Event ev_user = { .type = 100 };
-    log_private_Ignore();
-    distance_update_state(&dist_fsm, &ev_user);
-}
\ No newline at end of file
+    /* Corrupt frames past the last retry give up */
+    start_read();
+    (void)memcpy(read_buf, rest_frame, sizeof(rest_frame));
+    read_buf[0] = 0x80;
+    dist_obj.retry = eDISTANCE_READ_RETRY_MAX - 1;
+    (void)util_fsm_send_event(&dist_fsm, &ev_frame_received);
+    TEST_ASSERT_EQUAL_PTR(distance_idle_state, dist_fsm.current_state);
+    TEST_ASSERT_FALSE(dist_obj.frame->valid);
+}
@@ -0,0 +1,232 @@
+/* Standard library includes */
+#include <stddef.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "util/event_bus/event_bus_config.h"
+#include "util/event_bus/event_bus.h"
+#include "util/event_pool/event_pool.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("util/event_bus/event_bus.c")
+TEST_SOURCE_FILE("util/event_pool/event_pool.c")
+
+/* Mock library includes */
+#include "mock_osal.h"
+#include "mock_log.h"
+#include "mock_trace.h"
+
+/* Test helpers */
+static Event read_event = { .type = eFSM_EVENT_USER };
+static Event stop_event = { .type = eFSM_EVENT_USER + 1 };
+static Event wide_event = { .type = 100 };
+static uint32_t posted_modules[4];
+static Event* posted_events[4];
+static uint32_t post_count;
+static eStatus post_status;
+
+static eStatus post(uint32_t module, Event* event)
+{
+    posted_modules[post_count] = module;
+    posted_events[post_count] = event;
+    post_count++;
+    return post_status;
+}
+
+void setUp(void)
+{
+    util_trace_record_Ignore();
+    log_private_Ignore();
+    osal_mutex_init_IgnoreAndReturn(0);
+    osal_event_init_IgnoreAndReturn(0);
+    osal_event_set_Ignore();
+    osal_mutex_lock_Ignore();
+    osal_mutex_unlock_Ignore();
+    post_count = 0;
+    post_status = eSTATUS_SUCCESSFUL;
+    util_event_pool_init();
+    util_event_bus_init();
+}
+
+void tearDown(void)
+{
+    osal_mutex_destroy_Ignore();
+    osal_event_destroy_Ignore();
+    util_event_bus_delete();
+}
+
+void test_event_bus_subscribe(void)
+{
+    eStatus status = util_event_bus_subscribe(eAO_COUNT, post, 0, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = util_event_bus_subscribe(eAO_DISTANCE, NULL, 0, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 0, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 0, &wide_event);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    for(uint32_t i = 0; i < eEVENT_BUS_MAX_SUBSCRIPTIONS; i++)
+    {
+        status = util_event_bus_subscribe(eAO_DISTANCE, post, i, &read_event);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 0, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+}
+
+void test_event_bus_publish(void)
+{
+    eStatus status = util_event_bus_subscribe(eAO_SERVO, post, 0, &stop_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 2, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    status = util_event_bus_publish(eAO_COUNT, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = util_event_bus_publish(eAO_DISTANCE, wide_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = util_event_bus_publish(eAO_DISTANCE, stop_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    status = util_event_bus_publish(eAO_DISTANCE, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, post_count);
+    TEST_ASSERT_EQUAL(1, posted_modules[0]);
+    TEST_ASSERT_EQUAL(2, posted_modules[1]);
+    TEST_ASSERT_EQUAL_PTR(&read_event, posted_events[0]);
+}
+
+void test_event_bus_publish_snapshot(void)
+{
+    eStatus status = util_event_bus_subscribe(eAO_DISTANCE, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_SERVO, post, 0, &stop_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* Routed without the bus mutex */
+    osal_mutex_lock_StopIgnore();
+    status = util_event_bus_publish(eAO_DISTANCE, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, post_count);
+
+    status = util_event_bus_publish(eAO_GPS, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    osal_mutex_lock_Ignore();
+
+    /* A later subscription swaps in a table that holds it as well, in subscription order */
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 2, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_GPS, post, 3, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_mutex_lock_StopIgnore();
+    status = util_event_bus_publish(eAO_DISTANCE, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(3, post_count);
+    TEST_ASSERT_EQUAL(1, posted_modules[1]);
+    TEST_ASSERT_EQUAL(2, posted_modules[2]);
+
+    status = util_event_bus_publish(eAO_GPS, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(4, post_count);
+    TEST_ASSERT_EQUAL(3, posted_modules[3]);
+    osal_mutex_lock_Ignore();
+}
+
+void test_event_bus_unsubscribe(void)
+{
+    eStatus status = util_event_bus_subscribe(eAO_DISTANCE, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 2, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    status = util_event_bus_unsubscribe(eAO_COUNT, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+    status = util_event_bus_unsubscribe(eAO_DISTANCE, NULL, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+    status = util_event_bus_unsubscribe(eAO_DISTANCE, post, 3, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* Only the remaining subscription is posted to */
+    status = util_event_bus_unsubscribe(eAO_DISTANCE, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_unsubscribe(eAO_DISTANCE, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    status = util_event_bus_publish(eAO_DISTANCE, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, post_count);
+    TEST_ASSERT_EQUAL(2, posted_modules[0]);
+
+    status = util_event_bus_unsubscribe(eAO_DISTANCE, post, 2, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_publish(eAO_DISTANCE, read_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    TEST_ASSERT_EQUAL(1, post_count);
+
+    /* Freed slots are taken again */
+    for(uint32_t i = 0; i < eEVENT_BUS_MAX_SUBSCRIPTIONS; i++)
+    {
+        status = util_event_bus_subscribe(eAO_GPS, post, i, &read_event);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_event_bus_unsubscribe(eAO_GPS, post, 7, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_SERVO, post, 0, &stop_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_publish(eAO_SERVO, stop_event.type);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+}
+
+void test_event_bus_publish_data(void)
+{
+    eStatus status = util_event_bus_subscribe(eAO_DISTANCE, post, 1, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_event_bus_subscribe(eAO_DISTANCE, post, 2, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    status = util_event_bus_publish_data(eAO_DISTANCE, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_event_bus_publish_data(eAO_DISTANCE, &read_event);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    /* The same buffer reaches every subscriber, each holding a reference */
+    Event* event = util_event_pool_alloc(read_event.type);
+    status = util_event_bus_publish_data(eAO_DISTANCE, event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, post_count);
+    TEST_ASSERT_EQUAL_PTR(event, posted_events[0]);
+    TEST_ASSERT_EQUAL_PTR(event, posted_events[1]);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT - 1, util_event_pool_available());
+    util_event_pool_release(event);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT - 1, util_event_pool_available());
+    util_event_pool_release(event);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+
+    /* Failed posts and unmatched publishes give the event back */
+    post_status = eSTATUS_ACTION_FAILED;
+    event = util_event_pool_alloc(read_event.type);
+    status = util_event_bus_publish_data(eAO_DISTANCE, event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+
+    event = util_event_pool_alloc(read_event.type);
+    status = util_event_bus_publish_data(eAO_GPS, event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+
+    event = util_event_pool_alloc(wide_event.type);
+    status = util_event_bus_publish_data(eAO_DISTANCE, event);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+}
@@ -0,0 +1,76 @@
+/* Standard library includes */
+#include <stddef.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "util/event_pool/event_pool.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("util/event_pool/event_pool.c")
+
+/* Test helpers */
+static Event static_event = { .type = eFSM_EVENT_USER };
+
+void setUp(void)
+{
+    util_event_pool_init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_event_pool_alloc(void)
+{
+    Event* events[eEVENT_POOL_BLOCK_COUNT];
+
+    for(uint32_t i = 0; i < eEVENT_POOL_BLOCK_COUNT; ++i)
+    {
+        events[i] = util_event_pool_alloc(eFSM_EVENT_USER + i);
+        TEST_ASSERT_NOT_NULL(events[i]);
+        TEST_ASSERT_EQUAL(eFSM_EVENT_USER + i, events[i]->type);
+        TEST_ASSERT_TRUE(util_event_pool_owns(events[i]));
+    }
+    TEST_ASSERT_EQUAL(0, util_event_pool_available());
+    TEST_ASSERT_NULL(util_event_pool_alloc(eFSM_EVENT_USER));
+
+    /* The last block released is the next one taken */
+    util_event_pool_release(events[3]);
+    TEST_ASSERT_EQUAL(1, util_event_pool_available());
+    TEST_ASSERT_EQUAL_PTR(events[3], util_event_pool_alloc(eFSM_EVENT_USER));
+}
+
+void test_event_pool_refs(void)
+{
+    Event* event = util_event_pool_alloc(eFSM_EVENT_USER);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT - 1, util_event_pool_available());
+
+    util_event_pool_retain(event);
+    util_event_pool_retain(event);
+    util_event_pool_release(event);
+    util_event_pool_release(event);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT - 1, util_event_pool_available());
+
+    util_event_pool_release(event);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT, util_event_pool_available());
+}
+
+void test_event_pool_payload(void)
+{
+    Event* event = util_event_pool_alloc(eFSM_EVENT_USER);
+    uint64_t* payload = util_event_pool_payload(event);
+    TEST_ASSERT_NOT_NULL(payload);
+    payload[eEVENT_POOL_PAYLOAD_SIZE / sizeof(uint64_t) - 1] = 42;
+    TEST_ASSERT_EQUAL(eFSM_EVENT_USER, event->type);
+
+    /* Events that are not from the pool are left alone */
+    TEST_ASSERT_FALSE(util_event_pool_owns(&static_event));
+    TEST_ASSERT_FALSE(util_event_pool_owns(NULL));
+    TEST_ASSERT_NULL(util_event_pool_payload(&static_event));
+    TEST_ASSERT_FALSE(util_event_pool_owns((Event*)((uint8_t*)event + sizeof(uint32_t))));
+    util_event_pool_retain(&static_event);
+    util_event_pool_release(&static_event);
+    TEST_ASSERT_EQUAL(eEVENT_POOL_BLOCK_COUNT - 1, util_event_pool_available());
+}
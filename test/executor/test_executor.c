@@ -0,0 +1,257 @@
+/* Standard library includes */
+#include <stddef.h>
+#include <string.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "util/executor/executor.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("util/executor/executor.c")
+
+/* Mock library includes */
+#include "mock_osal.h"
+
+/* Test helpers */
+static EntryFP entries[eEXECUTOR_THREAD_MAX_COUNT];
+static void* args[eEXECUTOR_THREAD_MAX_COUNT];
+static char ran[16];
+static uint32_t ran_count;
+static ExecutorStats parked_stats;
+static ExecutorTask tasks[3];
+
+static eStatus osal_thread_create_ex_callback(OsalThread* thread, EntryFP entry_func, void* arg,
+                                              const OsalThreadAttr* attr, int cmock_num_calls)
+{
+    entries[cmock_num_calls] = entry_func;
+    args[cmock_num_calls] = arg;
+    return eSTATUS_SUCCESSFUL;
+}
+
+static eStatus osal_thread_create_ex_fail_callback(OsalThread* thread, EntryFP entry_func, void* arg,
+                                                   const OsalThreadAttr* attr, int cmock_num_calls)
+{
+    return (cmock_num_calls < 2) ? eSTATUS_SUCCESSFUL : eSTATUS_SYSTEM_ERROR;
+}
+
+/* The first worker to park reads the stats and stops the executor, ending the worker's loop */
+static void osal_sem_wait_callback(OsalSem* sem, int cmock_num_calls)
+{
+    util_executor_get_stats(&parked_stats);
+    util_executor_delete();
+}
+
+/* The worker runs while the deinit waits */
+static void osal_delay_us_callback(uint64_t us, int cmock_num_calls)
+{
+    TEST_ASSERT_EQUAL(1, us);
+    (void)entries[0](args[0]);
+}
+
+/* Runs once and asks for another run */
+static bool run_twice(void* arg)
+{
+    ran[ran_count++] = *(const char*)arg;
+    return ran_count == 1;
+}
+
+static bool run_once(void* arg)
+{
+    ran[ran_count++] = *(const char*)arg;
+    return false;
+}
+
+/* Schedules itself while running */
+static bool run_rescheduled(void* arg)
+{
+    ran[ran_count++] = *(const char*)arg;
+    if(ran_count == 1)
+    {
+        util_executor_schedule(&tasks[0]);
+    }
+    return false;
+}
+
+/* Schedules a task on this worker and has the second worker take it */
+static bool run_nested_worker(void* arg)
+{
+    ran[ran_count++] = *(const char*)arg;
+    util_executor_schedule(&tasks[1]);
+    (void)entries[1](args[1]);
+    return false;
+}
+
+void setUp(void)
+{
+    memset(ran, 0, sizeof(ran));
+    ran_count = 0;
+    osal_mutex_init_IgnoreAndReturn(0);
+    osal_sem_init_IgnoreAndReturn(0);
+    osal_mutex_lock_Ignore();
+    osal_mutex_unlock_Ignore();
+    osal_sem_post_Ignore();
+    osal_sem_wait_Stub(osal_sem_wait_callback);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    osal_thread_join_Ignore();
+    osal_sem_destroy_Ignore();
+    osal_mutex_destroy_Ignore();
+}
+
+void tearDown(void)
+{
+    osal_thread_join_Ignore();
+    util_executor_delete();
+}
+
+void test_executor_fifo(void)
+{
+    static const char a = 'A';
+    static const char b = 'B';
+
+    eStatus status = util_executor_init(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, util_executor_thread_count());
+    (void)util_executor_task_init(&tasks[0], run_twice, (void*)&a);
+    (void)util_executor_task_init(&tasks[1], run_once, (void*)&b);
+
+    /* A second schedule of a queued task doesn't queue it again */
+    util_executor_schedule(&tasks[0]);
+    util_executor_schedule(&tasks[1]);
+    util_executor_schedule(&tasks[0]);
+    void* ret = entries[0](args[0]);
+    TEST_ASSERT_NULL(ret);
+
+    /* A task with more work runs again behind the one already queued */
+    TEST_ASSERT_EQUAL_STRING("ABA", ran);
+    TEST_ASSERT_EQUAL(3, parked_stats.runs);
+    TEST_ASSERT_EQUAL(1, parked_stats.parks);
+    TEST_ASSERT_EQUAL(0, parked_stats.steals);
+    TEST_ASSERT_EQUAL(0, util_executor_thread_count());
+}
+
+void test_executor_schedule_while_running(void)
+{
+    static const char c = 'C';
+
+    eStatus status = util_executor_init(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    (void)util_executor_task_init(&tasks[0], run_rescheduled, (void*)&c);
+
+    util_executor_schedule(&tasks[0]);
+    (void)entries[0](args[0]);
+    TEST_ASSERT_EQUAL_STRING("CC", ran);
+}
+
+void test_executor_steal(void)
+{
+    static const char s = 'S';
+    static const char t = 'T';
+
+    eStatus status = util_executor_init(2);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    (void)util_executor_task_init(&tasks[0], run_nested_worker, (void*)&s);
+    (void)util_executor_task_init(&tasks[1], run_once, (void*)&t);
+
+    util_executor_schedule(&tasks[0]);
+    (void)entries[0](args[0]);
+    TEST_ASSERT_EQUAL_STRING("ST", ran);
+
+    /* Read as the second worker parked, while S was still running */
+    TEST_ASSERT_EQUAL(1, parked_stats.runs);
+    TEST_ASSERT_EQUAL(1, parked_stats.steals);
+}
+
+void test_executor_init(void)
+{
+    ExecutorTask task;
+
+    eStatus status = util_executor_init(0);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = util_executor_init(eEXECUTOR_THREAD_MAX_COUNT + 1);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = util_executor_task_init(&task, run_once, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* Only the event loop build runs tasks on the caller */
+    static const bool done = false;
+    status = util_executor_run_until(&done);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* The workers already started are stopped */
+    osal_thread_create_ex_Stub(osal_thread_create_ex_fail_callback);
+    osal_thread_join_ExpectAnyArgs();
+    osal_thread_join_ExpectAnyArgs();
+    status = util_executor_init(3);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+    TEST_ASSERT_EQUAL(0, util_executor_thread_count());
+
+    osal_sem_init_IgnoreAndReturn(1);
+    status = util_executor_init(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+}
+
+void test_executor_task_init(void)
+{
+    ExecutorTask task = { 0 };
+
+    eStatus status = util_executor_init(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    status = util_executor_task_init(NULL, run_once, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_executor_task_init(&task, NULL, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    for(uint32_t i = 0; i < eEXECUTOR_TASK_MAX_COUNT; ++i)
+    {
+        status = util_executor_task_init(&task, run_once, NULL);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_executor_task_init(&task, run_once, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+}
+
+void test_executor_task_deinit(void)
+{
+    const char a = 'a';
+
+    eStatus status = util_executor_init(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_executor_task_init(&tasks[0], run_once, (void*)&a);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    util_executor_schedule(&tasks[0]);
+
+    /* A queued task keeps its state, and a failed init takes no slot */
+    status = util_executor_task_init(&tasks[0], run_once, (void*)&a);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    for(uint32_t i = 1; i < eEXECUTOR_TASK_MAX_COUNT; ++i)
+    {
+        status = util_executor_task_init(&tasks[1], run_once, NULL);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_executor_task_init(&tasks[2], run_once, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* An idle task gives its slot back at once */
+    util_executor_task_deinit(&tasks[1]);
+    status = util_executor_task_init(&tasks[2], run_once, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* The queued one is waited for until the worker ran it, then stays off the queues */
+    osal_delay_us_Stub(osal_delay_us_callback);
+    util_executor_task_deinit(&tasks[0]);
+    TEST_ASSERT_EQUAL(1, ran_count);
+    TEST_ASSERT_EQUAL_CHAR('a', ran[0]);
+
+    /* Deinitialized, it can be initialized again */
+    status = util_executor_init(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    util_executor_schedule(&tasks[0]);
+    status = util_executor_task_init(&tasks[0], run_once, (void*)&a);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+}
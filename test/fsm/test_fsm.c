@@ -1,11 +1,21 @@
+/* Standard library includes */
+#include <string.h>
+
 /* Third party includes */
 #include "unity.h"
 
 /* User code includes */
 #include "util/fsm/fsm.h"
+#include "util/fsm/fsm_table.h"
 
 /* Tell Ceedling to inject the following sources */
 TEST_SOURCE_FILE("util/fsm/fsm.c")
+TEST_SOURCE_FILE("util/fsm/fsm_table.c")
+TEST_SOURCE_FILE("util/histogram/histogram.c")
+
+/* Mock library includes */
+#include "mock_trace.h"
+#include "mock_osal.h"
 
 /* Test helpers */
 static void dummy_state(FSM* fsm, Event* event)
@@ -14,12 +24,127 @@ static void dummy_state(FSM* fsm, Event* event)
     (void)event;
 }
 
+static uint64_t clock_ns;
+
+static uint64_t osal_time_now_ns_callback(int cmock_num_calls)
+{
+    (void)cmock_num_calls;
+    return clock_ns;
+}
+
+static void slow_state(FSM* fsm, Event* event);
+
+/* Takes 1 ms to enter */
+static void fast_state(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    if(event->type == eFSM_EVENT_ENTRY)
+    {
+        clock_ns += 1000000;
+    }
+}
+
+/* Blocks past the budget on a user event, then leaves for fast_state */
+static void slow_state(FSM* fsm, Event* event)
+{
+    if(event->type == eFSM_EVENT_USER)
+    {
+        clock_ns += (uint64_t)(eFSM_STATS_BUDGET_MS + 1) * 1000000;
+        (void)util_fsm_transition(fsm, fast_state);
+    }
+}
+
 static FSM my_fsm;
 
+/* A table FSM: OFF and ON toggled by USER, TICKs counted while ON up to a
+ * limit, then OFF. LIMBO and its twin only lead to each other */
+enum
+{
+    eTABLE_EVENT_TOGGLE = eFSM_EVENT_USER,
+    eTABLE_EVENT_TICK,
+    eTABLE_EVENT_OTHER,
+    eTABLE_EVENT_LATE = 40
+};
+
+static char     table_log[16];
+static uint32_t table_log_count;
+static uint32_t ticks;
+
+static void table_record(char c)
+{
+    table_log[table_log_count++] = c;
+}
+
+static void off_state(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    table_record(event->type == eFSM_EVENT_ENTRY ? 'f' : 'F');
+}
+
+static void on_state(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    table_record(event->type == eFSM_EVENT_ENTRY ? 'n' : 'N');
+}
+
+static void table_init_state(FSM* fsm, Event* event);
+
+static bool below_limit(FSM* fsm, const Event* event)
+{
+    (void)fsm;
+    (void)event;
+    return ticks < 2;
+}
+
+static void count_tick(FSM* fsm, Event* event)
+{
+    (void)fsm;
+    (void)event;
+    ticks++;
+    table_record('t');
+}
+
+#define TEST_STATES(X, T)                       \
+    X(T, eTEST_STATE_OFF, off_state)            \
+    X(T, eTEST_STATE_ON,  on_state)
+
+#define TEST_TRANSITIONS(X, S)                                                                              \
+    X(S, eTEST_STATE_OFF, eTABLE_EVENT_TOGGLE, NULL,        NULL,       eTEST_STATE_ON)                     \
+    X(S, eTEST_STATE_ON,  eTABLE_EVENT_TOGGLE, NULL,        NULL,       eTEST_STATE_OFF)                    \
+    X(S, eTEST_STATE_ON,  eTABLE_EVENT_TICK,   below_limit, count_tick, eFSM_TABLE_INTERNAL)                \
+    X(S, eTEST_STATE_ON,  eTABLE_EVENT_TICK,   NULL,        NULL,       eTEST_STATE_OFF)                    \
+    X(S, eTEST_STATE_ON,  eTABLE_EVENT_LATE,   NULL,        count_tick, eFSM_TABLE_INTERNAL)
+
+typedef enum
+{
+    TEST_STATES(FSM_TABLE_STATE_ID, ~)
+    eTEST_STATE_COUNT
+} eTestState;
+
+static const FSMTableRow test_rows[] = { TEST_TRANSITIONS(FSM_TABLE_ROW, ~) };
+static const FSMTableState test_states[] = { TEST_STATES(FSM_TABLE_STATE, TEST_TRANSITIONS) };
+TEST_STATES(FSM_TABLE_CHECK_ENTERED, TEST_TRANSITIONS)
+static const FSMTable test_table = FSM_TABLE(test_states, test_rows);
+
+static void table_init_state(FSM* fsm, Event* event)
+{
+    if(event->type == eFSM_EVENT_INIT)
+    {
+        (void)util_fsm_table_start(fsm, &test_table);
+    }
+}
+
 void setUp(void)
 {
+    util_trace_record_Ignore();
+    osal_time_now_ns_Stub(osal_time_now_ns_callback);
+    clock_ns = 0;
+    memset(&my_fsm, 0, sizeof(my_fsm));
     my_fsm.current_state = dummy_state;
     my_fsm.arg           = NULL;
+    memset(table_log, 0, sizeof(table_log));
+    table_log_count = 0;
+    ticks = 0;
 }
 
 void tearDown(void) 
@@ -72,4 +197,140 @@ void test_fsm_transition(void)
     my_fsm.current_state = NULL;
     status = util_fsm_transition(&my_fsm, dummy_state);
     TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
-}
\ No newline at end of file
+}
+
+void test_fsm_stats(void)
+{
+    Event user_event = { .type = eFSM_EVENT_USER };
+    FSMStats stats;
+
+    clock_ns = 1000;
+    (void)util_fsm_init(&my_fsm, slow_state, NULL);
+    clock_ns += 5000;
+    (void)util_fsm_send_event(&my_fsm, &user_event);
+    clock_ns += 7000;
+
+    eStatus status = util_fsm_get_stats(&my_fsm, &stats);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, stats.transitions);
+    TEST_ASSERT_EQUAL(1, stats.current);
+    TEST_ASSERT_EQUAL(0, stats.untracked);
+    TEST_ASSERT_EQUAL_PTR(slow_state, stats.states[0]);
+    TEST_ASSERT_EQUAL_PTR(fast_state, stats.states[1]);
+    TEST_ASSERT_NULL(stats.states[2]);
+
+    /* init, then the user event, which includes the transition and the exit */
+    uint64_t blocked_ns = (uint64_t)(eFSM_STATS_BUDGET_MS + 1) * 1000000;
+    TEST_ASSERT_EQUAL(1, stats.state_stats[0].entries);
+    TEST_ASSERT_EQUAL(3, stats.state_stats[0].handler.count);
+    TEST_ASSERT_EQUAL_UINT64(blocked_ns + 1000000, stats.state_stats[0].handler.max);
+    TEST_ASSERT_EQUAL(1, stats.state_stats[0].overruns);
+    TEST_ASSERT_EQUAL_UINT64(5000 + blocked_ns, stats.state_stats[0].time_ns);
+
+    /* The current stay counts up to the read */
+    TEST_ASSERT_EQUAL(1, stats.state_stats[1].entries);
+    TEST_ASSERT_EQUAL(1, stats.state_stats[1].handler.count);
+    TEST_ASSERT_EQUAL_UINT64(1000000, stats.state_stats[1].handler.max);
+    TEST_ASSERT_EQUAL(0, stats.state_stats[1].overruns);
+    TEST_ASSERT_EQUAL_UINT64(1000000 + 7000, stats.state_stats[1].time_ns);
+
+    status = util_fsm_get_stats(NULL, &stats);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_fsm_get_stats(&my_fsm, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+}
+
+void test_fsm_table(void)
+{
+    Event toggle = { .type = eTABLE_EVENT_TOGGLE };
+    Event tick = { .type = eTABLE_EVENT_TICK };
+    Event other = { .type = eTABLE_EVENT_OTHER };
+    Event late = { .type = eTABLE_EVENT_LATE };
+    FSMStats stats;
+
+    eStatus status = util_fsm_init(&my_fsm, table_init_state, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&test_table, my_fsm.table);
+    TEST_ASSERT_EQUAL_PTR(off_state, my_fsm.current_state);
+
+    /* Events without a row are dropped without calling the state */
+    (void)util_fsm_send_event(&my_fsm, &tick);
+    (void)util_fsm_send_event(&my_fsm, &late);
+    (void)util_fsm_send_event(&my_fsm, &toggle);
+    (void)util_fsm_send_event(&my_fsm, &other);
+
+    /* Two internal ticks, the late type through the row scan, the next tick
+     * fails the guard and leaves, the last one has no row in OFF */
+    (void)util_fsm_send_event(&my_fsm, &tick);
+    (void)util_fsm_send_event(&my_fsm, &late);
+    (void)util_fsm_send_event(&my_fsm, &tick);
+    (void)util_fsm_send_event(&my_fsm, &tick);
+    TEST_ASSERT_EQUAL_PTR(off_state, my_fsm.current_state);
+    TEST_ASSERT_EQUAL_STRING("fFnttNf", table_log);
+
+    (void)util_fsm_get_stats(&my_fsm, &stats);
+    TEST_ASSERT_EQUAL(3, stats.transitions);
+    TEST_ASSERT_EQUAL(4, stats.filtered);
+    TEST_ASSERT_EQUAL_PTR(table_init_state, stats.states[0]);
+    TEST_ASSERT_EQUAL_PTR(off_state, stats.states[1]);
+    TEST_ASSERT_EQUAL_PTR(on_state, stats.states[2]);
+    TEST_ASSERT_EQUAL(2, stats.state_stats[1].entries);
+    /* ENTRY, the three rows run and EXIT, the filtered event isn't timed */
+    TEST_ASSERT_EQUAL(5, stats.state_stats[2].handler.count);
+
+    /* A state outside the table leaves it */
+    status = util_fsm_transition(&my_fsm, dummy_state);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_NULL(my_fsm.table);
+    (void)util_fsm_send_event(&my_fsm, &toggle);
+    TEST_ASSERT_EQUAL_PTR(dummy_state, my_fsm.current_state);
+
+    status = util_fsm_table_start(NULL, &test_table);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+    status = util_fsm_table_start(&my_fsm, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+    const FSMTable empty = { test_states, test_rows, 0, 0 };
+    status = util_fsm_table_start(&my_fsm, &empty);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+}
+
+void test_fsm_table_validate(void)
+{
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, util_fsm_table_validate(&test_table));
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, util_fsm_table_validate(NULL));
+
+    /* Filter bits that don't match the rows */
+    FSMTableState states[sizeof(test_states) / sizeof(test_states[0])];
+    FSMTableRow rows[sizeof(test_rows) / sizeof(test_rows[0])];
+    memcpy(states, test_states, sizeof(test_states));
+    memcpy(rows, test_rows, sizeof(test_rows));
+    FSMTable table = { states, rows, eTEST_STATE_COUNT, sizeof(test_rows) / sizeof(test_rows[0]) };
+    states[eTEST_STATE_OFF].handled = 0;
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, util_fsm_table_validate(&table));
+
+    /* A row no event can reach past an unguarded one */
+    memcpy(states, test_states, sizeof(test_states));
+    rows[2].guard = NULL;
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, util_fsm_table_validate(&table));
+
+    /* A row out of its state's range */
+    memcpy(rows, test_rows, sizeof(test_rows));
+    rows[1].source = eTEST_STATE_OFF;
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, util_fsm_table_validate(&table));
+
+    /* Two states leading only to each other pass the build check, not this one */
+    const FSMTableRow limbo_rows[] = {
+        { 0, eTABLE_EVENT_TOGGLE, 0, 0, NULL, NULL },
+        { 1, eTABLE_EVENT_TOGGLE, 2, 0, NULL, NULL },
+        { 2, eTABLE_EVENT_TOGGLE, 1, 0, NULL, NULL }
+    };
+    const uint32_t bit = 1u << eTABLE_EVENT_TOGGLE;
+    const FSMTableState limbo_states[] = {
+        { off_state, bit, 0, 1, 0 },
+        { on_state, bit, 1, 1, 0 },
+        { dummy_state, bit, 2, 1, 0 }
+    };
+    const FSMTable limbo = { limbo_states, limbo_rows, 3, 3 };
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, util_fsm_table_validate(&limbo));
+}
@@ -0,0 +1,69 @@
+/* Standard library includes */
+#include <stddef.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "util/histogram/histogram.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("util/histogram/histogram.c")
+
+/* Test helpers */
+static Histogram histogram;
+
+void setUp(void)
+{
+    util_histogram_reset(&histogram);
+}
+
+void tearDown(void)
+{
+}
+
+void test_histogram_record(void)
+{
+    util_histogram_record(&histogram, 0);
+    util_histogram_record(&histogram, 1);
+    util_histogram_record(&histogram, 1000);
+    util_histogram_record(&histogram, UINT64_MAX);
+
+    TEST_ASSERT_EQUAL(1, histogram.buckets[0]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[1]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[10]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[eHISTOGRAM_BUCKET_COUNT - 1]);
+    TEST_ASSERT_EQUAL(4, histogram.count);
+    TEST_ASSERT_EQUAL(UINT64_MAX, histogram.max);
+}
+
+void test_histogram_percentile(void)
+{
+    TEST_ASSERT_EQUAL(0, util_histogram_percentile(&histogram, 50));
+
+    for(uint64_t i = 0; i < 99; ++i)
+    {
+        util_histogram_record(&histogram, 100);
+    }
+    util_histogram_record(&histogram, 5000);
+
+    /* 100 falls in [64, 128), the bucket's upper bound caps at the max */
+    TEST_ASSERT_EQUAL(127, util_histogram_percentile(&histogram, 50));
+    TEST_ASSERT_EQUAL(127, util_histogram_percentile(&histogram, 99));
+    TEST_ASSERT_EQUAL(5000, util_histogram_percentile(&histogram, 100));
+}
+
+void test_histogram_read(void)
+{
+    Histogram copy;
+
+    util_histogram_record(&histogram, 42);
+    eStatus status = util_histogram_read(&histogram, &copy);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, copy.count);
+    TEST_ASSERT_EQUAL(42, copy.sum);
+    TEST_ASSERT_EQUAL(1, copy.buckets[6]);
+
+    status = util_histogram_read(NULL, &copy);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+}
@@ -17,7 +17,7 @@ TEST_SOURCE_FILE("util/queue/queue.c")
 static Queue my_queue;
 static void* buffer[2];
 
-static void osal_cond_wait_callback(void* cond_p, void* mutex_p, int cmock_num_calls)
+static void osal_sem_wait_callback(OsalSem* sem_p, int cmock_num_calls)
 {
     my_queue.size = 1;
 }
@@ -26,14 +26,14 @@ void setUp(void)
 {
     osal_alloc_IgnoreAndReturn(buffer);
     osal_mutex_init_IgnoreAndReturn(0);
-    osal_cond_init_IgnoreAndReturn(0);
+    osal_sem_init_IgnoreAndReturn(0);
     util_queue_init(&my_queue, 2);
 }
 
 void tearDown(void) 
 {
     osal_mutex_destroy_Ignore();
-    osal_cond_destroy_Ignore();
+    osal_sem_destroy_Ignore();
     osal_dealloc_Ignore();
     util_queue_delete(&my_queue);
 }
@@ -46,6 +46,9 @@ void test_queue_init(void)
     status = util_queue_init(&my_queue, 0);
     TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
 
+    status = util_queue_init_ex(&my_queue, 2, eQUEUE_TYPE_MPSC + 1);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
     osal_alloc_IgnoreAndReturn(NULL);
     status = util_queue_init(&my_queue, 2);
     TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
@@ -58,7 +61,8 @@ void test_queue_init(void)
 
     osal_alloc_IgnoreAndReturn(buffer);
     osal_mutex_init_IgnoreAndReturn(0);
-    osal_cond_init_IgnoreAndReturn(1);
+    osal_sem_init_IgnoreAndReturn(1);
+    osal_mutex_destroy_Ignore();
     osal_dealloc_Ignore();
     status = util_queue_init(&my_queue, 2);
     TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
@@ -72,7 +76,7 @@ void test_queue_delete(void)
 void test_queue_push(void)
 {
     osal_mutex_lock_Ignore();
-    osal_cond_signal_Ignore();
+    osal_sem_post_Expect(&my_queue.items);
     osal_mutex_unlock_Ignore();
     eStatus status = util_queue_push(&my_queue, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
@@ -108,11 +112,12 @@ void test_queue_pop(void)
     TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
 
     osal_mutex_lock_Ignore();
-    osal_cond_signal_Ignore();
+    osal_sem_post_Ignore();
     osal_mutex_unlock_Ignore();
     status = util_queue_push(&my_queue, NULL);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
 
+    osal_sem_wait_Ignore();
     osal_mutex_lock_Ignore();
     osal_mutex_unlock_Ignore();
     status = util_queue_pop(&my_queue, &elem);
@@ -120,7 +125,7 @@ void test_queue_pop(void)
 
     osal_mutex_lock_Ignore();
     osal_mutex_unlock_Ignore();
-    osal_cond_wait_Stub(osal_cond_wait_callback);
+    osal_sem_wait_Stub(osal_sem_wait_callback);
     status = util_queue_pop(&my_queue, &elem);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
 }
@@ -131,13 +136,13 @@ void test_queue_cyclic(void)
     int num2 = 2;
 
     osal_mutex_lock_Ignore();
-    osal_cond_signal_Ignore();
+    osal_sem_post_Ignore();
     osal_mutex_unlock_Ignore();
     eStatus status = util_queue_push(&my_queue, &num1);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
 
     osal_mutex_lock_Ignore();
-    osal_cond_signal_Ignore();
+    osal_sem_post_Ignore();
     osal_mutex_unlock_Ignore();
     status = util_queue_push(&my_queue, &num2);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
@@ -145,12 +150,14 @@ void test_queue_cyclic(void)
 
     int* outval = NULL;
 
+    osal_sem_wait_Ignore();
     osal_mutex_lock_Ignore();
     osal_mutex_unlock_Ignore();
     status = util_queue_pop(&my_queue, &outval);
     TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
     TEST_ASSERT_TRUE(*outval == 1);
 
+    osal_sem_wait_Ignore();
     osal_mutex_lock_Ignore();
     osal_mutex_unlock_Ignore();
     status = util_queue_pop(&my_queue, &outval);
@@ -159,4 +166,328 @@ void test_queue_cyclic(void)
 
     TEST_ASSERT_TRUE(my_queue.size == 0);
     TEST_ASSERT_TRUE(my_queue.head == my_queue.tail);
-}
\ No newline at end of file
+}
+void test_queue_pop_timeout(void)
+{
+    int num = 1;
+    int* outval = NULL;
+
+    eStatus status = util_queue_pop_timeout(NULL, (void**)&outval, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_queue_pop_timeout(&my_queue, NULL, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    osal_sem_timedwait_ExpectAndReturn(&my_queue.items, 10, eSTATUS_TIMEOUT);
+    status = util_queue_pop_timeout(&my_queue, (void**)&outval, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_TIMEOUT, status);
+    TEST_ASSERT_NULL(outval);
+
+    osal_mutex_lock_Ignore();
+    osal_sem_post_Ignore();
+    osal_mutex_unlock_Ignore();
+    status = util_queue_push(&my_queue, &num);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_sem_timedwait_ExpectAndReturn(&my_queue.items, 10, eSTATUS_SUCCESSFUL);
+    status = util_queue_pop_timeout(&my_queue, (void**)&outval, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&num, outval);
+    TEST_ASSERT_TRUE(my_queue.size == 0);
+}
+
+void test_queue_pop_batch(void)
+{
+    int nums[2] = { 1, 2 };
+    void* outvals[4] = { NULL };
+    uint32_t count = 0;
+
+    eStatus status = util_queue_pop_batch(NULL, outvals, NULL, 4, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_queue_pop_batch(&my_queue, outvals, NULL, 4, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_queue_pop_batch(&my_queue, outvals, NULL, 0, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    osal_sem_timedwait_ExpectAndReturn(&my_queue.items, 10, eSTATUS_TIMEOUT);
+    status = util_queue_pop_batch_timeout(&my_queue, outvals, NULL, 4, &count, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_TIMEOUT, status);
+    TEST_ASSERT_EQUAL(0, count);
+
+    osal_mutex_lock_Ignore();
+    osal_sem_post_Ignore();
+    osal_mutex_unlock_Ignore();
+    for(int i = 0; i < 2; ++i)
+    {
+        status = util_queue_push(&my_queue, &nums[i]);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+
+    /* One blocking wait, then the rest of the items count is claimed without blocking */
+    osal_sem_wait_Expect(&my_queue.items);
+    osal_sem_trywait_ExpectAndReturn(&my_queue.items, eSTATUS_SUCCESSFUL);
+    osal_sem_trywait_ExpectAndReturn(&my_queue.items, eSTATUS_ACTION_FAILED);
+    osal_mutex_lock_Expect(&my_queue.mutex);
+    osal_mutex_unlock_Expect(&my_queue.mutex);
+    status = util_queue_pop_batch(&my_queue, outvals, NULL, 4, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL_PTR(&nums[0], outvals[0]);
+    TEST_ASSERT_EQUAL_PTR(&nums[1], outvals[1]);
+    TEST_ASSERT_TRUE(my_queue.size == 0);
+
+    /* Polling an empty queue doesn't wait */
+    osal_sem_trywait_ExpectAndReturn(&my_queue.items, eSTATUS_ACTION_FAILED);
+    status = util_queue_try_pop_batch(&my_queue, outvals, NULL, 4, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    TEST_ASSERT_EQUAL(0, count);
+
+    osal_mutex_lock_Ignore();
+    osal_mutex_unlock_Ignore();
+    status = util_queue_push(&my_queue, &nums[1]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    osal_mutex_lock_StopIgnore();
+    osal_mutex_unlock_StopIgnore();
+    osal_sem_trywait_ExpectAndReturn(&my_queue.items, eSTATUS_SUCCESSFUL);
+    osal_sem_trywait_ExpectAndReturn(&my_queue.items, eSTATUS_ACTION_FAILED);
+    osal_mutex_lock_Expect(&my_queue.mutex);
+    osal_mutex_unlock_Expect(&my_queue.mutex);
+    status = util_queue_try_pop_batch(&my_queue, outvals, NULL, 4, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL_PTR(&nums[1], outvals[0]);
+}
+
+void test_queue_stamps(void)
+{
+    static uint64_t stamps[2];
+    int nums[2] = { 1, 2 };
+    void* outvals[2] = { NULL };
+    uint64_t outstamps[2] = { 0 };
+    uint32_t count = 0;
+
+    eStatus status = util_queue_enable_stamps(NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    osal_alloc_IgnoreAndReturn(NULL);
+    status = util_queue_enable_stamps(&my_queue);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+
+    osal_alloc_IgnoreAndReturn(stamps);
+    status = util_queue_enable_stamps(&my_queue);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_mutex_lock_Ignore();
+    osal_sem_post_Ignore();
+    osal_mutex_unlock_Ignore();
+    osal_time_now_ns_ExpectAndReturn(100);
+    osal_time_now_ns_ExpectAndReturn(200);
+    for(int i = 0; i < 2; ++i)
+    {
+        status = util_queue_push(&my_queue, &nums[i]);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    TEST_ASSERT_EQUAL(2, util_queue_depth(&my_queue));
+    TEST_ASSERT_EQUAL(2, my_queue.peak);
+
+    /* Each element comes out with the time it was pushed, the peak stays */
+    osal_sem_wait_Ignore();
+    osal_sem_trywait_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    status = util_queue_pop_batch(&my_queue, outvals, outstamps, 2, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL(100, outstamps[0]);
+    TEST_ASSERT_EQUAL(200, outstamps[1]);
+    TEST_ASSERT_EQUAL(0, util_queue_depth(&my_queue));
+    TEST_ASSERT_EQUAL(2, my_queue.peak);
+}
+
+void test_queue_push_coalesced(void)
+{
+    int nums[3] = { 0, 1, 2 };
+
+    eStatus status = util_queue_push_coalesced(NULL, &nums[0]);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    osal_mutex_lock_Ignore();
+    osal_sem_post_Ignore();
+    osal_mutex_unlock_Ignore();
+    status = util_queue_push(&my_queue, &nums[0]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* Merged into the pending copy */
+    status = util_queue_push_coalesced(&my_queue, &nums[0]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, my_queue.size);
+    TEST_ASSERT_EQUAL(1, my_queue.merged);
+
+    status = util_queue_push_coalesced(&my_queue, &nums[1]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, my_queue.size);
+
+    /* A full queue still merges pending elements */
+    status = util_queue_push_coalesced(&my_queue, &nums[2]);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    status = util_queue_push_coalesced(&my_queue, &nums[1]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, my_queue.merged);
+}
+
+void test_queue_urgent(void)
+{
+    static void* urgent_buffer[2 + 1];
+    int nums[3] = { 0, 1, 2 };
+    int* outval = NULL;
+
+    eStatus status = util_queue_init_urgent(&my_queue, 2, 0);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    /* Without a lane, urgent elements just join the FIFO */
+    osal_mutex_lock_Ignore();
+    osal_sem_post_Ignore();
+    osal_mutex_unlock_Ignore();
+    status = util_queue_push_urgent(&my_queue, &nums[0]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, my_queue.size);
+    status = util_queue_pop_urgent(&my_queue, (void**)&outval, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    osal_mutex_destroy_Ignore();
+    osal_sem_destroy_Ignore();
+    osal_dealloc_Ignore();
+    util_queue_delete(&my_queue);
+
+    osal_alloc_IgnoreAndReturn(urgent_buffer);
+    status = util_queue_init_urgent(&my_queue, 2, 1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&urgent_buffer[2], my_queue.urgent.buffer);
+
+    status = util_queue_push(&my_queue, &nums[0]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_queue_push(&my_queue, &nums[1]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_queue_push_urgent(&my_queue, &nums[2]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = util_queue_push_urgent(&my_queue, &nums[2]);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* The urgent element overtakes the ones already queued */
+    osal_sem_wait_Ignore();
+    status = util_queue_pop(&my_queue, (void**)&outval);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&nums[2], outval);
+
+    status = util_queue_pop_urgent(&my_queue, (void**)&outval, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    status = util_queue_push_urgent(&my_queue, &nums[2]);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    osal_sem_trywait_ExpectAndReturn(&my_queue.items, eSTATUS_SUCCESSFUL);
+    status = util_queue_pop_urgent(&my_queue, (void**)&outval, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&nums[2], outval);
+
+    status = util_queue_pop(&my_queue, (void**)&outval);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL_PTR(&nums[0], outval);
+    TEST_ASSERT_EQUAL(1, my_queue.size);
+    TEST_ASSERT_EQUAL(0, my_queue.urgent.size);
+}
+
+void test_queue_spsc(void)
+{
+    static void* spsc_buffer[4];
+    int nums[4] = { 0, 1, 2, 3 };
+    int* outval = NULL;
+
+    osal_alloc_IgnoreAndReturn(spsc_buffer);
+    osal_event_init_IgnoreAndReturn(0);
+    eStatus status = util_queue_init_ex(&my_queue, 3, eQUEUE_TYPE_SPSC);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(4, my_queue.capacity);
+
+    for(int i = 0; i < 4; ++i)
+    {
+        status = util_queue_push(&my_queue, &nums[i]);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_queue_push(&my_queue, &nums[0]);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    for(int i = 0; i < 4; ++i)
+    {
+        status = util_queue_pop(&my_queue, (void**)&outval);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+        TEST_ASSERT_EQUAL_PTR(&nums[i], outval);
+    }
+
+    osal_time_now_ns_IgnoreAndReturn(0);
+    osal_event_timedwait_IgnoreAndReturn(eSTATUS_TIMEOUT);
+    osal_time_now_ns_IgnoreAndReturn(10000000);
+    status = util_queue_pop_timeout(&my_queue, (void**)&outval, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_TIMEOUT, status);
+    TEST_ASSERT_EQUAL(0, my_queue.ring.sleeping);
+
+    /* Polling neither reads the clock nor announces a sleeping consumer */
+    void* outvals[4] = { NULL };
+    uint32_t count = 0;
+    osal_time_now_ns_StopIgnore();
+    osal_event_timedwait_StopIgnore();
+    status = util_queue_try_pop_batch(&my_queue, outvals, NULL, 4, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+    for(int i = 0; i < 3; ++i)
+    {
+        status = util_queue_push(&my_queue, &nums[i]);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_queue_try_pop_batch(&my_queue, outvals, NULL, 2, &count);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL_PTR(&nums[1], outvals[1]);
+    TEST_ASSERT_EQUAL(0, my_queue.ring.sleeping);
+
+    osal_event_destroy_Ignore();
+}
+
+void test_queue_mpsc(void)
+{
+    /* Four slots followed by their four sequence counters */
+    static void* mpsc_buffer[4 + (4 * sizeof(uint32_t) + sizeof(void*) - 1) / sizeof(void*)];
+    int nums[4] = { 0, 1, 2, 3 };
+    int* outval = NULL;
+
+    osal_alloc_IgnoreAndReturn(mpsc_buffer);
+    osal_event_init_IgnoreAndReturn(0);
+    eStatus status = util_queue_init_ex(&my_queue, 3, eQUEUE_TYPE_MPSC);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(4, my_queue.capacity);
+
+    /* Two laps, so the slots are handed back to the producers */
+    for(int lap = 0; lap < 2; ++lap)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            status = util_queue_push(&my_queue, &nums[i]);
+            TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+        }
+        status = util_queue_push(&my_queue, &nums[0]);
+        TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+        for(int i = 0; i < 4; ++i)
+        {
+            status = util_queue_pop(&my_queue, (void**)&outval);
+            TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+            TEST_ASSERT_EQUAL_PTR(&nums[i], outval);
+        }
+    }
+
+    osal_time_now_ns_IgnoreAndReturn(0);
+    osal_event_timedwait_IgnoreAndReturn(eSTATUS_TIMEOUT);
+    osal_time_now_ns_IgnoreAndReturn(10000000);
+    status = util_queue_pop_timeout(&my_queue, (void**)&outval, 10);
+    TEST_ASSERT_EQUAL(eSTATUS_TIMEOUT, status);
+
+    osal_event_destroy_Ignore();
+}
@@ -0,0 +1,89 @@
+/* Standard library includes */
+#include <stddef.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "app/scheduler/scheduler_config.h"
+#include "app/scheduler/scheduler.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("app/scheduler/scheduler.c")
+
+/* Mock library includes */
+#include "mock_active_object.h"
+#include "mock_scheduler_fsm.h"
+#include "mock_osal.h"
+
+/* Test helpers */
+static Event tick_event = { .type = eFSM_EVENT_USER };
+
+void setUp(void)
+{
+    osal_mutex_init_IgnoreAndReturn(0);
+    osal_mutex_lock_Ignore();
+    osal_mutex_unlock_Ignore();
+    util_active_object_init_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    (void)app_scheduler_init();
+}
+
+void tearDown(void)
+{
+    util_active_object_delete_Ignore();
+    osal_mutex_destroy_Ignore();
+    app_scheduler_delete();
+}
+
+void test_scheduler_init(void)
+{
+    osal_mutex_init_IgnoreAndReturn(1);
+    eStatus status = app_scheduler_init();
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+
+    /* The mutex doesn't outlive a failed AO */
+    osal_mutex_init_IgnoreAndReturn(0);
+    util_active_object_init_IgnoreAndReturn(eSTATUS_SYSTEM_ERROR);
+    osal_mutex_destroy_ExpectAnyArgs();
+    status = app_scheduler_init();
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+
+    util_active_object_init_IgnoreAndReturn(eSTATUS_SUCCESSFUL);
+    status = app_scheduler_init();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+}
+
+void test_scheduler_subscribe(void)
+{
+    eStatus status = app_scheduler_subscribe(eSCHEDULER_SUBSCRIBERS_MAX, eAO_DISTANCE, &tick_event);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = app_scheduler_subscribe(0, eAO_DISTANCE, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = app_scheduler_subscribe(0, eAO_DISTANCE, &tick_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    status = app_scheduler_subscribe(0, eAO_GPS, &tick_event);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+}
+
+void test_scheduler_unsubscribe(void)
+{
+    eStatus status = app_scheduler_unsubscribe(eSCHEDULER_SUBSCRIBERS_MAX);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    status = app_scheduler_unsubscribe(1);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    status = app_scheduler_subscribe(1, eAO_DISTANCE, &tick_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = app_scheduler_unsubscribe(1);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    status = app_scheduler_unsubscribe(1);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+
+    /* The slot is free for another module */
+    status = app_scheduler_subscribe(1, eAO_GPS, &tick_event);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+}
@@ -0,0 +1,193 @@
+/* Standard library includes */
+#include <stddef.h>
+#include <string.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "util/supervisor/supervisor.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("util/supervisor/supervisor.c")
+
+/* Mock library includes */
+#include "mock_osal.h"
+
+/* Test helpers */
+#define DEADLINE_MS 100
+#define MS          1000000ull
+
+static uint64_t clock_ns;
+static ActiveObjectStats probed;
+static eStatus probe_status;
+static uint32_t stalls;
+static uint32_t recoveries;
+static uint32_t last_id;
+static EntryFP entry;
+
+static uint64_t osal_time_now_ns_callback(int cmock_num_calls)
+{
+    return clock_ns;
+}
+
+static eStatus probe(uint32_t id, ActiveObjectStats* stats)
+{
+    *stats = probed;
+    return probe_status;
+}
+
+static void notify(uint32_t id, bool stalled)
+{
+    last_id = id;
+    if(stalled)
+    {
+        stalls++;
+    }
+    else
+    {
+        recoveries++;
+    }
+}
+
+static eStatus osal_thread_create_ex_callback(OsalThread* thread, EntryFP entry_func, void* arg,
+                                              const OsalThreadAttr* attr, int cmock_num_calls)
+{
+    entry = entry_func;
+    return eSTATUS_SUCCESSFUL;
+}
+
+/* Times out twice, then is set to stop */
+static eStatus osal_event_timedwait_callback(OsalEvent* event, uint64_t timeout_ms, int cmock_num_calls)
+{
+    return (cmock_num_calls < 2) ? eSTATUS_TIMEOUT : eSTATUS_SUCCESSFUL;
+}
+
+void setUp(void)
+{
+    clock_ns = 0;
+    memset(&probed, 0, sizeof(probed));
+    probe_status = eSTATUS_SUCCESSFUL;
+    stalls = 0;
+    recoveries = 0;
+    last_id = 0;
+    osal_time_now_ns_Stub(osal_time_now_ns_callback);
+}
+
+void tearDown(void)
+{
+    util_supervisor_stop();
+}
+
+void test_supervisor_watch(void)
+{
+    eStatus status = util_supervisor_watch(0, DEADLINE_MS, NULL, notify);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_supervisor_watch(0, DEADLINE_MS, probe, NULL);
+    TEST_ASSERT_EQUAL(eSTATUS_NULL_PARAM, status);
+
+    status = util_supervisor_watch(0, 0, probe, notify);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    for(uint32_t i = 0; i < eSUPERVISOR_WATCH_MAX_COUNT; ++i)
+    {
+        status = util_supervisor_watch(i, DEADLINE_MS, probe, notify);
+        TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    }
+    status = util_supervisor_watch(0, DEADLINE_MS, probe, notify);
+    TEST_ASSERT_EQUAL(eSTATUS_ACTION_FAILED, status);
+}
+
+void test_supervisor_stuck_handler(void)
+{
+    (void)util_supervisor_watch(3, DEADLINE_MS, probe, notify);
+
+    /* Within the deadline */
+    probed.events = 1;
+    probed.busy_ns = DEADLINE_MS * MS;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(0, stalls);
+
+    /* Told once while the handler stays stuck */
+    probed.busy_ns = DEADLINE_MS * MS + 1;
+    util_supervisor_check();
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(1, stalls);
+    TEST_ASSERT_EQUAL(3, last_id);
+    TEST_ASSERT_EQUAL(0, recoveries);
+
+    probed.busy_ns = 0;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(1, recoveries);
+
+    SupervisorStats stats;
+    util_supervisor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(4, stats.checks);
+    TEST_ASSERT_EQUAL(1, stats.stalls);
+    TEST_ASSERT_EQUAL(1, stats.recoveries);
+}
+
+void test_supervisor_queue_age(void)
+{
+    (void)util_supervisor_watch(1, DEADLINE_MS, probe, notify);
+
+    /* An empty queue is never late, however long ago the last event was */
+    clock_ns = 10 * DEADLINE_MS * MS;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(0, stalls);
+
+    /* Events wait from the first check that saw them */
+    probed.depth = 2;
+    clock_ns += DEADLINE_MS * MS;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(0, stalls);
+    clock_ns += 1;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(1, stalls);
+
+    /* A failed probe changes nothing */
+    probe_status = eSTATUS_NULL_PARAM;
+    probed.events = 2;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(0, recoveries);
+
+    /* The AO takes events again */
+    probe_status = eSTATUS_SUCCESSFUL;
+    util_supervisor_check();
+    TEST_ASSERT_EQUAL(1, recoveries);
+    TEST_ASSERT_EQUAL(1, last_id);
+}
+
+void test_supervisor_start(void)
+{
+    eStatus status = util_supervisor_start(0);
+    TEST_ASSERT_EQUAL(eSTATUS_INVALID_VALUE, status);
+
+    osal_event_init_ExpectAnyArgsAndReturn(eSTATUS_SYSTEM_ERROR);
+    status = util_supervisor_start(eSUPERVISOR_PERIOD_MS);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+
+    osal_event_init_ExpectAnyArgsAndReturn(eSTATUS_SUCCESSFUL);
+    osal_thread_create_ex_ExpectAnyArgsAndReturn(eSTATUS_SYSTEM_ERROR);
+    osal_event_destroy_ExpectAnyArgs();
+    status = util_supervisor_start(eSUPERVISOR_PERIOD_MS);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+
+    /* The thread checks on every timeout until the event is set */
+    osal_event_init_ExpectAnyArgsAndReturn(eSTATUS_SUCCESSFUL);
+    osal_thread_create_ex_Stub(osal_thread_create_ex_callback);
+    status = util_supervisor_start(eSUPERVISOR_PERIOD_MS);
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    osal_event_timedwait_Stub(osal_event_timedwait_callback);
+    TEST_ASSERT_NULL(entry(NULL));
+    SupervisorStats stats;
+    util_supervisor_get_stats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.checks);
+
+    osal_event_set_ExpectAnyArgs();
+    osal_thread_join_ExpectAnyArgs();
+    osal_event_destroy_ExpectAnyArgs();
+    util_supervisor_stop();
+}
@@ -0,0 +1,157 @@
+/* Standard library includes */
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+/* Third party includes */
+#include "unity.h"
+
+/* User code includes */
+#include "util/trace/trace.h"
+
+/* Tell Ceedling to inject the following sources */
+TEST_SOURCE_FILE("util/trace/trace.c")
+
+/* Mock library includes */
+#include "mock_osal.h"
+
+/* Test helpers */
+static char exported[256 * 1024];
+static int  ao;
+static int  fsm;
+
+/* Exports the trace into exported, returns the status of the export */
+static eStatus export_trace(void)
+{
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+
+    eStatus status = util_trace_export(fileno(file));
+    rewind(file);
+    size_t length = fread(exported, 1, sizeof(exported) - 1, file);
+    exported[length] = '\0';
+    fclose(file);
+
+    return status;
+}
+
+static uint32_t count_of(const char* text)
+{
+    uint32_t count = 0;
+    for(const char* found = strstr(exported, text); found != NULL; found = strstr(found + 1, text))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/* Records a post stamped with its argument in ms, then exits */
+static void* record_and_exit(void* arg)
+{
+    util_trace_record_at(eTRACE_KIND_POST, &ao, 1, 0, (uint64_t)(uintptr_t)arg * 1000000u);
+    return NULL;
+}
+
+static void run_recording_thread(uint32_t ms)
+{
+    pthread_t thread;
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, record_and_exit, (void*)(uintptr_t)ms));
+    TEST_ASSERT_EQUAL(0, pthread_join(thread, NULL));
+}
+
+void setUp(void)
+{
+    util_trace_init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_trace_export(void)
+{
+    util_trace_record_at(eTRACE_KIND_PUBLISH, NULL, 5, 2, 1000);
+    util_trace_record_at(eTRACE_KIND_POST, &ao, 5, eSTATUS_SUCCESSFUL, 1500);
+    util_trace_record_at(eTRACE_KIND_DISPATCH_BEGIN, &ao, 5, 700, 2200);
+    util_trace_record_at(eTRACE_KIND_TRANSITION, &fsm, 0, 0xbeef, 2300);
+    util_trace_record_at(eTRACE_KIND_DISPATCH_END, &ao, 5, 0, 3000042);
+
+    eStatus status = export_trace();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    TEST_ASSERT_EQUAL_PTR(exported, strstr(exported, "{\"traceEvents\":["));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"name\":\"thread_name\",\"ph\":\"M\""));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"name\":\"publish\",\"ph\":\"i\",\"s\":\"t\",\"ts\":1.000"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"args\":{\"type\":5,\"ao\":2}"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"name\":\"dispatch\",\"ph\":\"B\",\"ts\":2.200"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"type\":5,\"wait_ns\":700}"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"to\":\"0xbeef\""));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"name\":\"dispatch\",\"ph\":\"E\",\"ts\":3000.042"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\n],\"displayTimeUnit\":\"ns\"}\n"));
+
+    /* Records are exported in the order they were taken */
+    TEST_ASSERT_TRUE(strstr(exported, "\"ph\":\"B\"") < strstr(exported, "\"ph\":\"E\""));
+}
+
+void test_trace_ring_wraps(void)
+{
+    for(uint64_t i = 0; i < eTRACE_RING_SIZE + 10; ++i)
+    {
+        util_trace_record_at(eTRACE_KIND_POST, &ao, 1, 0, i * 1000);
+    }
+
+    eStatus status = export_trace();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+
+    /* Only the latest records are kept */
+    TEST_ASSERT_EQUAL(eTRACE_RING_SIZE - 1, count_of("\"name\":\"post\""));
+    TEST_ASSERT_NULL(strstr(exported, "\"ts\":10.000,"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"ts\":11.000,"));
+
+    /* A new init empties the rings */
+    util_trace_init();
+    status = export_trace();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(0, count_of("\"name\":\"post\""));
+}
+
+void test_trace_enable(void)
+{
+    osal_time_now_ns_ExpectAndReturn(4000);
+    util_trace_record(eTRACE_KIND_IO_COMPLETE, &ao, 8, 0);
+
+    /* Disabled recording doesn't read the clock */
+    util_trace_enable(false);
+    util_trace_record(eTRACE_KIND_IO_COMPLETE, &ao, 9, 0);
+    util_trace_record_at(eTRACE_KIND_IO_COMPLETE, &ao, 9, 0, 5000);
+    util_trace_enable(true);
+
+    eStatus status = export_trace();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(1, count_of("\"name\":\"io_complete\""));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"ts\":4.000,"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"result\":8}"));
+
+    status = util_trace_export(-1);
+    TEST_ASSERT_EQUAL(eSTATUS_SYSTEM_ERROR, status);
+}
+
+void test_trace_exited_threads(void)
+{
+    /* Each thread exits before the next starts, every ring is taken once */
+    for(uint32_t i = 1; i <= eTRACE_THREAD_MAX_COUNT; ++i)
+    {
+        run_recording_thread(i);
+    }
+
+    /* One more thread records over the ring of the first, whose records are gone */
+    run_recording_thread(100);
+    eStatus status = export_trace();
+    TEST_ASSERT_EQUAL(eSTATUS_SUCCESSFUL, status);
+    TEST_ASSERT_EQUAL(eTRACE_THREAD_MAX_COUNT, count_of("\"name\":\"post\""));
+    TEST_ASSERT_NULL(strstr(exported, "\"ts\":1000.000,"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"ts\":2000.000,"));
+    TEST_ASSERT_NOT_NULL(strstr(exported, "\"ts\":100000.000,"));
+}